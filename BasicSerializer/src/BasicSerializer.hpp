@@ -12,6 +12,32 @@
 //       When the underlying buffer is gone, use of these types will cause undefined behaviour!
 // **** **** **** ****
 
+// **** **** **** ****
+// NOTE: Allocations: Serializer, SizingSerializer and Deserializer never allocate, with the single
+//       exception of the unique_ptr based Deserializer::read for strings (one allocation per call,
+//       including the failure path). Deserializer::view and readArray are the allocation free alternatives.
+//       extras/test/test_allocations.cpp enforces this on the host.
+// **** **** **** ****
+
+// **** **** **** ****
+// NOTE: CursorType (default size_t) is the type of the read/write position. A narrower type, e.g. uint16_t
+//       for buffers up to 65535 bytes, makes Serializer and Deserializer smaller on 64 bit hosts.
+//       It must be able to hold tc_bufferSize itself (uint8_t allows up to 255 bytes). Bounds checks compare
+//       the cursor against tc_bufferSize minus the needed size, so they cannot overflow for any CursorType.
+// **** **** **** ****
+
+// **** **** **** ****
+// NOTE: Define HALVOE_SERIALIZER_TYPE_TAGS (for all translation units, on sender and receiver) to
+//       prefix every value, enum, array and string with a 1 byte type tag. Deserializer verifies the
+//       tags, fails the read on a mismatch and records it (see getTypeTagMismatch()). Define
+//       HALVOE_ON_TYPE_TAG_MISMATCH(offset, expected, actual) to be notified right away, e.g. to log it.
+//       Without HALVOE_SERIALIZER_TYPE_TAGS the format and the generated code are unchanged.
+// **** **** **** ****
+
+#if defined(HALVOE_SERIALIZER_TYPE_TAGS) && !defined(HALVOE_ON_TYPE_TAG_MISMATCH)
+#define HALVOE_ON_TYPE_TAG_MISMATCH(offset, expected, actual) ((void)0)
+#endif
+
 namespace halvoe
 {
   template<typename SizeType>
@@ -24,6 +50,37 @@ namespace halvoe
             std::is_same<SizeType, uint32_t>::value ||
             std::is_same<SizeType, uint64_t>::value);
   }
+
+#if defined(HALVOE_SERIALIZER_TYPE_TAGS)
+  static constexpr size_t c_typeTagSize = 1;
+#else
+  static constexpr size_t c_typeTagSize = 0;
+#endif
+
+  // Type tags: 0x01 bool, 0x02/0x03 (u)int8, 0x04/0x05 (u)int16, 0x06/0x07 (u)int32, 0x08/0x09 (u)int64,
+  // 0x0a float, 0x0b double, 0x0c long double; 0x20 marks arrays, 0x40 enums and 0x80 strings (tagged with their size type).
+  namespace type_tag
+  {
+    static constexpr uint8_t c_array = 0x20;
+    static constexpr uint8_t c_enum = 0x40;
+    static constexpr uint8_t c_string = 0x80;
+  }
+
+  template<typename Type>
+  constexpr uint8_t getTypeTag()
+  {
+    static_assert(std::is_arithmetic<Type>::value, "Type must be arithmetic!");
+    return std::is_same<Type, bool>::value ? 0x01 :
+           std::is_floating_point<Type>::value ? (sizeof(Type) == 4 ? 0x0a : sizeof(Type) == 8 ? 0x0b : 0x0c) :
+           static_cast<uint8_t>((sizeof(Type) == 1 ? 0x02 : sizeof(Type) == 2 ? 0x04 : sizeof(Type) == 4 ? 0x06 : 0x08) | (std::is_signed<Type>::value ? 0 : 1));
+  }
+
+  struct TypeTagMismatch
+  {
+    size_t offset = 0;
+    uint8_t expected = 0;
+    uint8_t actual = 0;
+  };
   
   template<typename Type>
   class SerializerReference
@@ -31,13 +88,13 @@ namespace halvoe
     static_assert(std::is_arithmetic<Type>::value, "Type must be arithmetic!");
     
     private:
-      Type* m_element;
+      uint8_t* m_element;
     
     public:
       SerializerReference() : m_element(nullptr)
       {}
       
-      SerializerReference(Type* in_element) : m_element(in_element)
+      SerializerReference(uint8_t* in_element) : m_element(in_element)
       {}
       
       bool isNull() const
@@ -49,24 +106,40 @@ namespace halvoe
       {
         if (m_element == nullptr) { return std::numeric_limits<Type>::max(); }
         
-        return *m_element;
+        Type value;
+        std::memcpy(&value, m_element, sizeof(Type));
+        return value;
       }
       
       bool write(Type in_value)
       {
         if (m_element == nullptr) { return false; }
         
-        *m_element = in_value;
+        std::memcpy(m_element, &in_value, sizeof(Type));
         return true;
       }
   };
 
-  template<size_t tc_bufferSize>
+  template<size_t tc_bufferSize, typename CursorType = size_t>
   class Serializer
   {
+    static_assert(std::is_unsigned<CursorType>::value && tc_bufferSize <= std::numeric_limits<CursorType>::max(), "CursorType must be an unsigned int that can hold tc_bufferSize!");
+
     private:
       uint8_t* m_begin;
-      size_t m_cursor = 0;
+      CursorType m_cursor = 0;
+
+    private:
+      // The caller has checked that c_typeTagSize more bytes fit into the buffer.
+      void putTypeTag(uint8_t in_typeTag)
+      {
+#if defined(HALVOE_SERIALIZER_TYPE_TAGS)
+        m_begin[m_cursor] = in_typeTag;
+        m_cursor = m_cursor + c_typeTagSize;
+#else
+        (void)in_typeTag;
+#endif
+      }
 
     public:
       Serializer() = delete;
@@ -112,23 +185,24 @@ namespace halvoe
 
       bool fitsInBuffer(size_t in_size) const
       {
-        return m_cursor + in_size <= tc_bufferSize;
+        return in_size <= tc_bufferSize && m_cursor <= tc_bufferSize - in_size;
       }
       
       template<typename Type>
       bool fitsInBuffer() const
       {
         static_assert(std::is_arithmetic<Type>::value, "Type must be arithmetic!");
-        return m_cursor + sizeof(Type) <= tc_bufferSize;
+        return fitsInBuffer(c_typeTagSize + sizeof(Type));
       }
 
       template<typename Type>
       SerializerReference<Type> skip()
       {
         static_assert(std::is_arithmetic<Type>::value, "Type must be arithmetic!");
-        if (m_cursor + sizeof(Type) > tc_bufferSize) { return SerializerReference<Type>(); }
+        if (!fitsInBuffer(c_typeTagSize + sizeof(Type))) { return SerializerReference<Type>(); }
         
-        SerializerReference<Type> element(reinterpret_cast<Type*>(m_begin + m_cursor));
+        putTypeTag(getTypeTag<Type>());
+        SerializerReference<Type> element(m_begin + m_cursor);
         m_cursor = m_cursor + sizeof(Type);
         return element;
       }
@@ -137,9 +211,10 @@ namespace halvoe
       bool write(Type in_value)
       {
         static_assert(std::is_arithmetic<Type>::value, "Type must be arithmetic!");
-        if (m_cursor + sizeof(Type) > tc_bufferSize) { return false; }
+        if (!fitsInBuffer(c_typeTagSize + sizeof(Type))) { return false; }
 
-        *reinterpret_cast<Type*>(m_begin + m_cursor) = in_value;
+        putTypeTag(getTypeTag<Type>());
+        std::memcpy(m_begin + m_cursor, &in_value, sizeof(Type));
         m_cursor = m_cursor + sizeof(Type);
         return true;
       }
@@ -149,9 +224,11 @@ namespace halvoe
       {
         using UnderlyingType = typename std::underlying_type<Type>::type;
         static_assert(std::is_enum<Type>::value && std::is_arithmetic<UnderlyingType>::value, "Type must be an enum and underlying type must be arithmetic!");
-        if (m_cursor + sizeof(UnderlyingType) > tc_bufferSize) { return false; }
+        if (!fitsInBuffer(c_typeTagSize + sizeof(UnderlyingType))) { return false; }
 
-        *reinterpret_cast<UnderlyingType*>(m_begin + m_cursor) = static_cast<UnderlyingType>(in_value);
+        putTypeTag(type_tag::c_enum | getTypeTag<UnderlyingType>());
+        const UnderlyingType value = static_cast<UnderlyingType>(in_value);
+        std::memcpy(m_begin + m_cursor, &value, sizeof(UnderlyingType));
         m_cursor = m_cursor + sizeof(UnderlyingType);
         return true;
       }
@@ -160,28 +237,113 @@ namespace halvoe
       bool write(const char* in_string, SizeType in_size)
       {
         static_assert(isSizeType<SizeType>(), "SizeType must be an unsigned int!");
-        if (m_cursor + sizeof(SizeType) + in_size > tc_bufferSize) { return false; }
+        if (!fitsInBuffer(c_typeTagSize + sizeof(SizeType)) || in_size > getBytesLeft() - c_typeTagSize - sizeof(SizeType)) { return false; }
         
-        write<SizeType>(in_size);
+        putTypeTag(type_tag::c_string | getTypeTag<SizeType>());
+        std::memcpy(m_begin + m_cursor, &in_size, sizeof(SizeType));
+        m_cursor = m_cursor + sizeof(SizeType);
         std::memcpy(m_begin + m_cursor, in_string, in_size);
         m_cursor = m_cursor + in_size;
         return true;
       }
+
+      // Writes in_count elements with a single copy, without a size prefix.
+      template<typename Type>
+      bool writeArray(const Type* in_values, size_t in_count)
+      {
+        static_assert(std::is_arithmetic<Type>::value, "Type must be arithmetic!");
+        if (!fitsInBuffer(c_typeTagSize) || in_count > (getBytesLeft() - c_typeTagSize) / sizeof(Type)) { return false; }
+
+        putTypeTag(type_tag::c_array | getTypeTag<Type>());
+        std::memcpy(m_begin + m_cursor, in_values, in_count * sizeof(Type));
+        m_cursor = m_cursor + in_count * sizeof(Type);
+        return true;
+      }
   };
-  
+
+  // Has the same write interface as Serializer, but only counts the bytes a serialization routine would write.
+  // Run the routine once with a SizingSerializer, then again with a Serializer over an exactly sized buffer.
+  class SizingSerializer
+  {
+    private:
+      size_t m_cursor = 0;
+      uint8_t m_discardElement[sizeof(long double)];
+
+    public:
+      size_t getBytesWritten() const
+      {
+        return m_cursor;
+      }
+
+      bool fitsInBuffer(size_t) const
+      {
+        return true;
+      }
+
+      template<typename Type>
+      bool fitsInBuffer() const
+      {
+        static_assert(std::is_arithmetic<Type>::value, "Type must be arithmetic!");
+        return true;
+      }
+
+      // The returned reference accepts writes into a scratch element of this instance. Every skip() reuses
+      // that element, so the value only lasts until the next skip() and is never part of the message.
+      template<typename Type>
+      SerializerReference<Type> skip()
+      {
+        static_assert(std::is_arithmetic<Type>::value && sizeof(Type) <= sizeof(m_discardElement), "Type must be arithmetic!");
+        m_cursor = m_cursor + c_typeTagSize + sizeof(Type);
+        return SerializerReference<Type>(m_discardElement);
+      }
+
+      template<typename Type>
+      bool write(Type)
+      {
+        static_assert(std::is_arithmetic<Type>::value, "Type must be arithmetic!");
+        m_cursor = m_cursor + c_typeTagSize + sizeof(Type);
+        return true;
+      }
+
+      template<typename Type>
+      bool writeEnum(Type)
+      {
+        using UnderlyingType = typename std::underlying_type<Type>::type;
+        static_assert(std::is_enum<Type>::value && std::is_arithmetic<UnderlyingType>::value, "Type must be an enum and underlying type must be arithmetic!");
+        m_cursor = m_cursor + c_typeTagSize + sizeof(UnderlyingType);
+        return true;
+      }
+
+      template<typename SizeType>
+      bool write(const char*, SizeType in_size)
+      {
+        static_assert(isSizeType<SizeType>(), "SizeType must be an unsigned int!");
+        m_cursor = m_cursor + c_typeTagSize + sizeof(SizeType) + in_size;
+        return true;
+      }
+
+      template<typename Type>
+      bool writeArray(const Type*, size_t in_count)
+      {
+        static_assert(std::is_arithmetic<Type>::value, "Type must be arithmetic!");
+        m_cursor = m_cursor + c_typeTagSize + in_count * sizeof(Type);
+        return true;
+      }
+  };
+
   template<typename Type>
   class DeserializerReference
   {
     static_assert(std::is_arithmetic<Type>::value, "Type must be arithmetic!");
     
     private:
-      const Type* m_element;
+      const uint8_t* m_element;
     
     public:
       DeserializerReference() : m_element(nullptr)
       {}
       
-      DeserializerReference(const Type* in_element) : m_element(in_element)
+      DeserializerReference(const uint8_t* in_element) : m_element(in_element)
       {}
       
       bool isNull() const
@@ -193,16 +355,24 @@ namespace halvoe
       {
         if (m_element == nullptr) { return std::numeric_limits<Type>::max(); }
         
-        return *m_element;
+        Type value;
+        std::memcpy(&value, m_element, sizeof(Type));
+        return value;
       }
   };
   
-  template<size_t tc_bufferSize>
+  template<size_t tc_bufferSize, typename CursorType = size_t>
   class Deserializer
   {
+    static_assert(std::is_unsigned<CursorType>::value && tc_bufferSize <= std::numeric_limits<CursorType>::max(), "CursorType must be an unsigned int that can hold tc_bufferSize!");
+
     private:
       const uint8_t* m_begin;
-      size_t m_cursor = 0;
+      CursorType m_cursor = 0;
+#if defined(HALVOE_SERIALIZER_TYPE_TAGS)
+      TypeTagMismatch m_typeTagMismatch;
+      bool m_hasTypeTagMismatch = false;
+#endif
       
     private:
       std::unique_ptr<const char[]> getNullString()
@@ -212,6 +382,27 @@ namespace halvoe
         return nullString;
       }
 
+      // The caller has checked that c_typeTagSize more bytes are in the buffer.
+      bool checkTypeTag(uint8_t in_typeTag)
+      {
+#if defined(HALVOE_SERIALIZER_TYPE_TAGS)
+        if (m_begin[m_cursor] != in_typeTag)
+        {
+          m_typeTagMismatch.offset = m_cursor;
+          m_typeTagMismatch.expected = in_typeTag;
+          m_typeTagMismatch.actual = m_begin[m_cursor];
+          m_hasTypeTagMismatch = true;
+          HALVOE_ON_TYPE_TAG_MISMATCH(m_cursor, in_typeTag, m_begin[m_cursor]);
+          return false;
+        }
+
+        m_cursor = m_cursor + c_typeTagSize;
+#else
+        (void)in_typeTag;
+#endif
+        return true;
+      }
+
     public:
       Deserializer() = delete;
       Deserializer(const uint8_t* in_begin) : m_begin(in_begin)
@@ -244,35 +435,60 @@ namespace halvoe
         return m_begin + m_cursor;
       }
 
+#if defined(HALVOE_SERIALIZER_TYPE_TAGS)
+      bool hasTypeTagMismatch() const
+      {
+        return m_hasTypeTagMismatch;
+      }
+
+      // The most recent mismatch; offset is the position of the unexpected tag in the buffer.
+      const TypeTagMismatch& getTypeTagMismatch() const
+      {
+        return m_typeTagMismatch;
+      }
+#endif
+
       bool fitsInBuffer(size_t in_size) const
       {
-        return m_cursor + in_size <= tc_bufferSize;
+        return in_size <= tc_bufferSize && m_cursor <= tc_bufferSize - in_size;
       }
 
       template<typename Type>
       bool fitsInBuffer() const
       {
         static_assert(std::is_arithmetic<Type>::value, "Type must be arithmetic!");
-        return m_cursor + sizeof(Type) <= tc_bufferSize;
+        return fitsInBuffer(c_typeTagSize + sizeof(Type));
       }
 
       template<typename Type>
       bool skip()
       {
         static_assert(std::is_arithmetic<Type>::value, "Type must be arithmetic!");
-        if (m_cursor + sizeof(Type) > tc_bufferSize) { return false; }
+        if (!fitsInBuffer(c_typeTagSize + sizeof(Type))) { return false; }
+        if (!checkTypeTag(getTypeTag<Type>())) { return false; }
 
         m_cursor = m_cursor + sizeof(Type);
         return true;
       }
 
+      // Skips in_size bytes without looking at them, e.g. fields whose types the reader does not know.
+      bool skipBytes(size_t in_size)
+      {
+        if (!fitsInBuffer(in_size)) { return false; }
+
+        m_cursor = m_cursor + in_size;
+        return true;
+      }
+
       template<typename Type>
       Type read()
       {
         static_assert(std::is_arithmetic<Type>::value, "Type must be arithmetic!");
-        if (m_cursor + sizeof(Type) > tc_bufferSize) { return std::numeric_limits<Type>::max(); }
+        if (!fitsInBuffer(c_typeTagSize + sizeof(Type))) { return std::numeric_limits<Type>::max(); }
+        if (!checkTypeTag(getTypeTag<Type>())) { return std::numeric_limits<Type>::max(); }
         
-        Type value = *reinterpret_cast<const Type*>(m_begin + m_cursor);
+        Type value;
+        std::memcpy(&value, m_begin + m_cursor, sizeof(Type));
         m_cursor = m_cursor + sizeof(Type);
         return value;
       }
@@ -282,9 +498,11 @@ namespace halvoe
       {
         using UnderlyingType = typename std::underlying_type<Type>::type;
         static_assert(std::is_enum<Type>::value && std::is_arithmetic<UnderlyingType>::value, "Type must be an enum and underlying type must be arithmetic!");
-        if (m_cursor + sizeof(UnderlyingType) > tc_bufferSize) { return Type{ std::numeric_limits<UnderlyingType>::max() }; }
+        if (!fitsInBuffer(c_typeTagSize + sizeof(UnderlyingType))) { return Type{ std::numeric_limits<UnderlyingType>::max() }; }
+        if (!checkTypeTag(type_tag::c_enum | getTypeTag<UnderlyingType>())) { return Type{ std::numeric_limits<UnderlyingType>::max() }; }
         
-        UnderlyingType value = *reinterpret_cast<const UnderlyingType*>(m_begin + m_cursor);
+        UnderlyingType value;
+        std::memcpy(&value, m_begin + m_cursor, sizeof(UnderlyingType));
         m_cursor = m_cursor + sizeof(UnderlyingType);
         return Type{ value };
       }
@@ -293,21 +511,57 @@ namespace halvoe
       const DeserializerReference<Type> view()
       {
         static_assert(std::is_arithmetic<Type>::value, "Type must be arithmetic!");
-        if (m_cursor + sizeof(Type) > tc_bufferSize) { return DeserializerReference<Type>(); }
+        if (!fitsInBuffer(c_typeTagSize + sizeof(Type))) { return DeserializerReference<Type>(); }
+        if (!checkTypeTag(getTypeTag<Type>())) { return DeserializerReference<Type>(); }
         
-        DeserializerReference<Type> element(reinterpret_cast<const Type*>(m_begin + m_cursor));
+        DeserializerReference<Type> element(m_begin + m_cursor);
         m_cursor = m_cursor + sizeof(Type);
         return element;
       }
       
+      // Returns a view of a string written by Serializer::write(const char*, SizeType) without copying it.
+      // The view is NOT null terminated. Returns nullptr (and does not advance), if the string exceeds the buffer.
+      template<typename SizeType>
+      const char* view(SizeType& out_stringSize)
+      {
+        static_assert(isSizeType<SizeType>(), "SizeType must be an unsigned int!");
+        if (!fitsInBuffer(c_typeTagSize + sizeof(SizeType))) { return nullptr; }
+        
+        SizeType size;
+        std::memcpy(&size, m_begin + m_cursor + c_typeTagSize, sizeof(SizeType));
+        if (size > getBytesLeft() - c_typeTagSize - sizeof(SizeType)) { return nullptr; }
+        if (!checkTypeTag(type_tag::c_string | getTypeTag<SizeType>())) { return nullptr; }
+        
+        const char* string = reinterpret_cast<const char*>(m_begin + m_cursor + sizeof(SizeType));
+        out_stringSize = size;
+        m_cursor = m_cursor + sizeof(SizeType) + size;
+        return string;
+      }
+      
+      // Reads in_count elements, written by Serializer::writeArray, with a single copy.
+      template<typename Type>
+      bool readArray(Type* out_values, size_t in_count)
+      {
+        static_assert(std::is_arithmetic<Type>::value, "Type must be arithmetic!");
+        if (!fitsInBuffer(c_typeTagSize) || in_count > (getBytesLeft() - c_typeTagSize) / sizeof(Type)) { return false; }
+        if (!checkTypeTag(type_tag::c_array | getTypeTag<Type>())) { return false; }
+
+        std::memcpy(out_values, m_begin + m_cursor, in_count * sizeof(Type));
+        m_cursor = m_cursor + in_count * sizeof(Type);
+        return true;
+      }
+      
+      // Both read overloads allocate exactly once per call: size + 1 bytes for the copy, or 1 byte for
+      // the empty string returned on failure. Use view(SizeType&) where the heap must not be touched.
       template<typename SizeType>
       std::unique_ptr<const char[]> read(SizeType in_maxStringSize, SizeType& out_stringSize)
       {
         static_assert(isSizeType<SizeType>(), "Type must be an unsigned int!");
-        if (m_cursor + sizeof(SizeType) + in_maxStringSize > tc_bufferSize) { return getNullString(); }
+        if (!fitsInBuffer(c_typeTagSize + sizeof(SizeType)) || in_maxStringSize > getBytesLeft() - c_typeTagSize - sizeof(SizeType)) { return getNullString(); }
+        if (!checkTypeTag(type_tag::c_string | getTypeTag<SizeType>())) { return getNullString(); }
         
-        auto sizeElement = view<SizeType>();
-        if (sizeElement.isNull()) { return getNullString(); }
+        DeserializerReference<SizeType> sizeElement(m_begin + m_cursor);
+        m_cursor = m_cursor + sizeof(SizeType);
         const SizeType size = sizeElement.read() < in_maxStringSize ? sizeElement.read() : in_maxStringSize - 1; 
         
         auto string = std::make_unique<char[]>(size + 1);
@@ -322,10 +576,11 @@ namespace halvoe
       std::unique_ptr<const char[]> read(SizeType in_maxStringSize)
       {
         static_assert(isSizeType<SizeType>(), "Type must be an unsigned int!");
-        if (m_cursor + sizeof(SizeType) + in_maxStringSize > tc_bufferSize) { return getNullString(); }
+        if (!fitsInBuffer(c_typeTagSize + sizeof(SizeType)) || in_maxStringSize > getBytesLeft() - c_typeTagSize - sizeof(SizeType)) { return getNullString(); }
+        if (!checkTypeTag(type_tag::c_string | getTypeTag<SizeType>())) { return getNullString(); }
         
-        auto sizeElement = view<SizeType>();
-        if (sizeElement.isNull()) { return getNullString(); }
+        DeserializerReference<SizeType> sizeElement(m_begin + m_cursor);
+        m_cursor = m_cursor + sizeof(SizeType);
         const SizeType size = sizeElement.read() < in_maxStringSize ? sizeElement.read() : in_maxStringSize - 1; 
         
         auto string = std::make_unique<char[]>(size + 1);
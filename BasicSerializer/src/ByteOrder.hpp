@@ -0,0 +1,54 @@
+#pragma once
+
+#include <type_traits>
+#include <cstdint>
+#include <cstddef>
+
+namespace halvoe
+{
+  // The loops below are recognised by GCC and Clang and compile to a single (byte swapped) load or store.
+
+  template<typename Type>
+  void storeBigEndian(uint8_t* out_begin, Type in_value)
+  {
+    static_assert(std::is_unsigned<Type>::value, "Type must be unsigned!");
+    for (size_t index = 0; index < sizeof(Type); ++index)
+    {
+      out_begin[index] = static_cast<uint8_t>(in_value >> (8 * (sizeof(Type) - 1 - index)));
+    }
+  }
+
+  template<typename Type>
+  Type loadBigEndian(const uint8_t* in_begin)
+  {
+    static_assert(std::is_unsigned<Type>::value, "Type must be unsigned!");
+    Type value = 0;
+    for (size_t index = 0; index < sizeof(Type); ++index)
+    {
+      value = static_cast<Type>((value << 8) | in_begin[index]);
+    }
+    return value;
+  }
+
+  template<typename Type>
+  void storeLittleEndian(uint8_t* out_begin, Type in_value)
+  {
+    static_assert(std::is_unsigned<Type>::value, "Type must be unsigned!");
+    for (size_t index = 0; index < sizeof(Type); ++index)
+    {
+      out_begin[index] = static_cast<uint8_t>(in_value >> (8 * index));
+    }
+  }
+
+  template<typename Type>
+  Type loadLittleEndian(const uint8_t* in_begin)
+  {
+    static_assert(std::is_unsigned<Type>::value, "Type must be unsigned!");
+    Type value = 0;
+    for (size_t index = 0; index < sizeof(Type); ++index)
+    {
+      value = static_cast<Type>(value | (static_cast<Type>(in_begin[index]) << (8 * index)));
+    }
+    return value;
+  }
+}
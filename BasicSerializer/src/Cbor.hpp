@@ -0,0 +1,579 @@
+#pragma once
+
+#include <type_traits>
+#include <limits>
+#include <array>
+#include <cstring>
+
+#include "BasicSerializer.hpp"
+#include "ByteOrder.hpp"
+
+// **** **** **** ****
+// NOTE: CborSerializer writes CBOR (RFC 8949) with the same write interface as Serializer.
+//       CborDeserializer is a pull decoder: next() decodes one item head at a time, so arrays
+//       and maps are never materialised. Text and byte strings are returned as views into the buffer.
+//       CborEncoding::deterministic does not sort map keys; write them in bytewise order yourself.
+// **** **** **** ****
+
+namespace halvoe
+{
+  enum class CborEncoding : uint8_t
+  {
+    fast,         // floats keep their C++ width, indefinite lengths are allowed
+    preferred,    // floats are shortened to half or single precision when lossless (RFC 8949, 4.1)
+    deterministic // preferred, and indefinite lengths are rejected (RFC 8949, 4.2.1)
+  };
+
+  enum class CborType : uint8_t
+  {
+    unsignedInteger,
+    negativeInteger,
+    byteString,
+    textString,
+    array,
+    map,
+    tag,
+    simple,
+    boolean,
+    null,
+    undefined,
+    floatingPoint,
+    breakStop
+  };
+
+  struct CborItem
+  {
+    CborType type = CborType::null;
+    bool isIndefinite = false;
+    uint64_t argument = 0;         // integer magnitude (-1 - argument for negative integers), string size, element count, tag or simple value
+    const uint8_t* data = nullptr; // string contents of definite length strings
+    double floatingPoint = 0;
+  };
+
+  namespace cbor
+  {
+    enum MajorType : uint8_t
+    {
+      unsignedInteger = 0,
+      negativeInteger = 1 << 5,
+      byteString = 2 << 5,
+      textString = 3 << 5,
+      array = 4 << 5,
+      map = 5 << 5,
+      tag = 6 << 5,
+      simple = 7 << 5
+    };
+
+    enum AdditionalInformation : uint8_t
+    {
+      oneByte = 24,
+      twoBytes = 25,
+      fourBytes = 26,
+      eightBytes = 27,
+      indefinite = 31
+    };
+
+    enum SimpleValue : uint8_t
+    {
+      falseValue = 20,
+      trueValue = 21,
+      null = 22,
+      undefined = 23
+    };
+
+    // Returns true and the half precision bits, if in_value is exactly representable as half precision float.
+    inline bool toHalf(float in_value, uint16_t& out_half)
+    {
+      uint32_t bits;
+      std::memcpy(&bits, &in_value, sizeof(bits));
+      const uint16_t sign = static_cast<uint16_t>((bits >> 16) & 0x8000);
+      const int32_t exponent = static_cast<int32_t>((bits >> 23) & 0xff);
+      const uint32_t mantissa = bits & 0x7fffff;
+
+      if (exponent == 0xff) { out_half = static_cast<uint16_t>(sign | (mantissa == 0 ? 0x7c00 : 0x7e00)); return true; }
+      if (exponent == 0 && mantissa == 0) { out_half = sign; return true; }
+      if (exponent == 0) { return false; }
+
+      const int32_t unbiasedExponent = exponent - 127;
+      if (unbiasedExponent >= -14 && unbiasedExponent <= 15)
+      {
+        if ((mantissa & 0x1fff) != 0) { return false; }
+        out_half = static_cast<uint16_t>(sign | ((unbiasedExponent + 15) << 10) | (mantissa >> 13));
+        return true;
+      }
+
+      if (unbiasedExponent >= -24 && unbiasedExponent < -14)
+      {
+        const uint32_t shift = static_cast<uint32_t>(-1 - unbiasedExponent);
+        const uint32_t significand = mantissa | 0x800000;
+        if ((significand & ((uint32_t{ 1 } << shift) - 1)) != 0) { return false; }
+        out_half = static_cast<uint16_t>(sign | (significand >> shift));
+        return true;
+      }
+
+      return false;
+    }
+
+    inline double fromHalf(uint16_t in_half)
+    {
+      const int32_t exponent = (in_half >> 10) & 0x1f;
+      const int32_t mantissa = in_half & 0x3ff;
+      double value;
+
+      if (exponent == 0) { value = static_cast<double>(mantissa) / (1 << 24); }
+      else if (exponent != 31) { value = static_cast<double>(mantissa + 1024) * static_cast<double>(uint32_t{ 1 } << exponent) / (uint32_t{ 1 } << 25); }
+      else { value = mantissa == 0 ? std::numeric_limits<double>::infinity() : std::numeric_limits<double>::quiet_NaN(); }
+
+      return (in_half & 0x8000) != 0 ? -value : value;
+    }
+  }
+
+  template<size_t tc_bufferSize, CborEncoding tc_encoding = CborEncoding::preferred>
+  class CborSerializer
+  {
+    private:
+      uint8_t* m_begin;
+      size_t m_cursor = 0;
+
+    private:
+      static constexpr size_t getHeadSize(uint64_t in_argument)
+      {
+        return in_argument < cbor::oneByte ? 1 :
+               in_argument <= std::numeric_limits<uint8_t>::max() ? 2 :
+               in_argument <= std::numeric_limits<uint16_t>::max() ? 3 :
+               in_argument <= std::numeric_limits<uint32_t>::max() ? 5 : 9;
+      }
+
+      template<typename Type>
+      bool writeHeadAndValue(uint8_t in_initialByte, Type in_value)
+      {
+        if (m_cursor + 1 + sizeof(Type) > tc_bufferSize) { return false; }
+
+        m_begin[m_cursor] = in_initialByte;
+        storeBigEndian<Type>(m_begin + m_cursor + 1, in_value);
+        m_cursor = m_cursor + 1 + sizeof(Type);
+        return true;
+      }
+
+      bool writeInitialByte(uint8_t in_initialByte)
+      {
+        if (m_cursor + 1 > tc_bufferSize) { return false; }
+
+        m_begin[m_cursor] = in_initialByte;
+        m_cursor = m_cursor + 1;
+        return true;
+      }
+
+      bool writeHead(uint8_t in_majorType, uint64_t in_argument)
+      {
+        if (in_argument < cbor::oneByte) { return writeInitialByte(static_cast<uint8_t>(in_majorType | in_argument)); }
+        if (in_argument <= std::numeric_limits<uint8_t>::max()) { return writeHeadAndValue<uint8_t>(in_majorType | cbor::oneByte, static_cast<uint8_t>(in_argument)); }
+        if (in_argument <= std::numeric_limits<uint16_t>::max()) { return writeHeadAndValue<uint16_t>(in_majorType | cbor::twoBytes, static_cast<uint16_t>(in_argument)); }
+        if (in_argument <= std::numeric_limits<uint32_t>::max()) { return writeHeadAndValue<uint32_t>(in_majorType | cbor::fourBytes, static_cast<uint32_t>(in_argument)); }
+        return writeHeadAndValue<uint64_t>(in_majorType | cbor::eightBytes, in_argument);
+      }
+
+      bool writeString(uint8_t in_majorType, const void* in_data, size_t in_size)
+      {
+        if (!fitsInBuffer(getHeadSize(in_size)) || in_size > getBytesLeft() - getHeadSize(in_size)) { return false; }
+
+        writeHead(in_majorType, in_size);
+        if (in_size > 0) { std::memcpy(m_begin + m_cursor, in_data, in_size); }
+        m_cursor = m_cursor + in_size;
+        return true;
+      }
+
+      bool writeFloat(float in_value)
+      {
+        uint16_t half;
+        if (tc_encoding != CborEncoding::fast && cbor::toHalf(in_value, half)) { return writeHeadAndValue<uint16_t>(cbor::simple | cbor::twoBytes, half); }
+
+        uint32_t bits;
+        std::memcpy(&bits, &in_value, sizeof(bits));
+        return writeHeadAndValue<uint32_t>(cbor::simple | cbor::fourBytes, bits);
+      }
+
+      bool writeDouble(double in_value)
+      {
+        const float single = static_cast<float>(in_value);
+        if (tc_encoding != CborEncoding::fast && (static_cast<double>(single) == in_value || in_value != in_value)) { return writeFloat(single); }
+
+        uint64_t bits;
+        std::memcpy(&bits, &in_value, sizeof(bits));
+        return writeHeadAndValue<uint64_t>(cbor::simple | cbor::eightBytes, bits);
+      }
+
+      template<typename Type>
+      static bool isNegative(Type in_value, std::true_type /* isSigned */)
+      {
+        return in_value < 0;
+      }
+
+      template<typename Type>
+      static bool isNegative(Type, std::false_type /* isSigned */)
+      {
+        return false;
+      }
+
+      bool writeIndefinite(uint8_t in_majorType)
+      {
+        if (tc_encoding == CborEncoding::deterministic) { return false; }
+
+        return writeInitialByte(in_majorType | cbor::indefinite);
+      }
+
+    public:
+      CborSerializer() = delete;
+      CborSerializer(uint8_t* out_begin) : m_begin(out_begin)
+      {}
+      CborSerializer(std::array<uint8_t, tc_bufferSize>& out_array) : m_begin(out_array.data())
+      {}
+
+      constexpr size_t getBufferSize() const
+      {
+        return tc_bufferSize;
+      }
+
+      size_t getBytesWritten() const
+      {
+        return m_cursor;
+      }
+
+      size_t getBytesLeft() const
+      {
+        return tc_bufferSize - m_cursor;
+      }
+
+      uint8_t* getBuffer()
+      {
+        return m_begin;
+      }
+
+      const uint8_t* getBuffer() const
+      {
+        return m_begin;
+      }
+
+      bool fitsInBuffer(size_t in_size) const
+      {
+        return in_size <= tc_bufferSize - m_cursor;
+      }
+
+      template<typename Type>
+      bool write(Type in_value)
+      {
+        static_assert(std::is_arithmetic<Type>::value, "Type must be arithmetic!");
+
+        if (std::is_same<Type, bool>::value) { return writeInitialByte(cbor::simple | (in_value ? cbor::trueValue : cbor::falseValue)); }
+        if (std::is_same<Type, float>::value) { return writeFloat(static_cast<float>(in_value)); }
+        if (std::is_floating_point<Type>::value) { return writeDouble(static_cast<double>(in_value)); }
+        if (isNegative(in_value, std::is_signed<Type>())) { return writeHead(cbor::negativeInteger, static_cast<uint64_t>(-1 - static_cast<int64_t>(in_value))); }
+        return writeHead(cbor::unsignedInteger, static_cast<uint64_t>(in_value));
+      }
+
+      template<typename Type>
+      bool writeEnum(Type in_value)
+      {
+        using UnderlyingType = typename std::underlying_type<Type>::type;
+        static_assert(std::is_enum<Type>::value && std::is_arithmetic<UnderlyingType>::value, "Type must be an enum and underlying type must be arithmetic!");
+        return write<UnderlyingType>(static_cast<UnderlyingType>(in_value));
+      }
+
+      // Writes a text string; in_string must be valid UTF-8.
+      template<typename SizeType>
+      bool write(const char* in_string, SizeType in_size)
+      {
+        static_assert(isSizeType<SizeType>(), "SizeType must be an unsigned int!");
+        return writeString(cbor::textString, in_string, in_size);
+      }
+
+      bool writeBytes(const uint8_t* in_data, size_t in_size)
+      {
+        return writeString(cbor::byteString, in_data, in_size);
+      }
+
+      bool writeNull()
+      {
+        return writeInitialByte(cbor::simple | cbor::null);
+      }
+
+      bool writeUndefined()
+      {
+        return writeInitialByte(cbor::simple | cbor::undefined);
+      }
+
+      bool writeTag(uint64_t in_tag)
+      {
+        return writeHead(cbor::tag, in_tag);
+      }
+
+      bool writeArrayHeader(uint64_t in_elementCount)
+      {
+        return writeHead(cbor::array, in_elementCount);
+      }
+
+      bool writeMapHeader(uint64_t in_pairCount)
+      {
+        return writeHead(cbor::map, in_pairCount);
+      }
+
+      // Indefinite length items are terminated with writeBreak(). Strings take definite length chunks of their own type.
+      bool beginIndefiniteArray()
+      {
+        return writeIndefinite(cbor::array);
+      }
+
+      bool beginIndefiniteMap()
+      {
+        return writeIndefinite(cbor::map);
+      }
+
+      bool beginIndefiniteText()
+      {
+        return writeIndefinite(cbor::textString);
+      }
+
+      bool beginIndefiniteBytes()
+      {
+        return writeIndefinite(cbor::byteString);
+      }
+
+      bool writeBreak()
+      {
+        return writeIndefinite(cbor::simple);
+      }
+  };
+
+  template<size_t tc_bufferSize>
+  class CborDeserializer
+  {
+    static constexpr size_t c_maxSkipDepth = 16;
+
+    private:
+      const uint8_t* m_begin;
+      size_t m_cursor = 0;
+
+    private:
+      // Decodes the item at the cursor into out_item and returns its size in bytes (head plus definite string), 0 if incomplete or malformed.
+      size_t peek(CborItem& out_item) const
+      {
+        if (m_cursor + 1 > tc_bufferSize) { return 0; }
+
+        const uint8_t initialByte = m_begin[m_cursor];
+        const uint8_t majorType = initialByte & 0xe0;
+        const uint8_t additionalInformation = initialByte & 0x1f;
+        size_t size = 1;
+        uint64_t argument = additionalInformation;
+
+        out_item = CborItem();
+
+        if (additionalInformation == cbor::oneByte) { if (m_cursor + 2 > tc_bufferSize) { return 0; } argument = m_begin[m_cursor + 1]; size = 2; }
+        else if (additionalInformation == cbor::twoBytes) { if (m_cursor + 3 > tc_bufferSize) { return 0; } argument = loadBigEndian<uint16_t>(m_begin + m_cursor + 1); size = 3; }
+        else if (additionalInformation == cbor::fourBytes) { if (m_cursor + 5 > tc_bufferSize) { return 0; } argument = loadBigEndian<uint32_t>(m_begin + m_cursor + 1); size = 5; }
+        else if (additionalInformation == cbor::eightBytes) { if (m_cursor + 9 > tc_bufferSize) { return 0; } argument = loadBigEndian<uint64_t>(m_begin + m_cursor + 1); size = 9; }
+        else if (additionalInformation == cbor::indefinite)
+        {
+          if (majorType == cbor::unsignedInteger || majorType == cbor::negativeInteger || majorType == cbor::tag) { return 0; }
+          out_item.isIndefinite = true;
+          argument = 0;
+        }
+        else if (additionalInformation > cbor::eightBytes) { return 0; }
+
+        out_item.argument = argument;
+
+        switch (majorType)
+        {
+          case cbor::unsignedInteger: out_item.type = CborType::unsignedInteger; return size;
+          case cbor::negativeInteger: out_item.type = CborType::negativeInteger; return size;
+          case cbor::array: out_item.type = CborType::array; return size;
+          case cbor::map: out_item.type = CborType::map; return size;
+          case cbor::tag: out_item.type = CborType::tag; return size;
+          case cbor::byteString:
+          case cbor::textString:
+          {
+            out_item.type = majorType == cbor::textString ? CborType::textString : CborType::byteString;
+            if (out_item.isIndefinite) { return size; }
+            if (argument > tc_bufferSize || m_cursor + size + argument > tc_bufferSize) { return 0; }
+            out_item.data = m_begin + m_cursor + size;
+            return size + static_cast<size_t>(argument);
+          }
+          default: break;
+        }
+
+        if (out_item.isIndefinite) { out_item.type = CborType::breakStop; return size; }
+
+        switch (additionalInformation)
+        {
+          case cbor::falseValue: out_item.type = CborType::boolean; out_item.argument = 0; return size;
+          case cbor::trueValue: out_item.type = CborType::boolean; out_item.argument = 1; return size;
+          case cbor::null: out_item.type = CborType::null; return size;
+          case cbor::undefined: out_item.type = CborType::undefined; return size;
+          case cbor::twoBytes: out_item.type = CborType::floatingPoint; out_item.floatingPoint = cbor::fromHalf(static_cast<uint16_t>(argument)); return size;
+          case cbor::fourBytes:
+          {
+            const uint32_t bits = static_cast<uint32_t>(argument);
+            float value;
+            std::memcpy(&value, &bits, sizeof(value));
+            out_item.type = CborType::floatingPoint;
+            out_item.floatingPoint = value;
+            return size;
+          }
+          case cbor::eightBytes: out_item.type = CborType::floatingPoint; std::memcpy(&out_item.floatingPoint, &argument, sizeof(argument)); return size;
+          default: out_item.type = CborType::simple; return size;
+        }
+      }
+
+      template<typename Type>
+      bool toArithmetic(const CborItem& in_item, Type& out_value, std::true_type /* isFloatingPoint */) const
+      {
+        if (in_item.type == CborType::floatingPoint) { out_value = static_cast<Type>(in_item.floatingPoint); return true; }
+        if (in_item.type == CborType::unsignedInteger) { out_value = static_cast<Type>(in_item.argument); return true; }
+        if (in_item.type == CborType::negativeInteger) { out_value = static_cast<Type>(-1) - static_cast<Type>(in_item.argument); return true; }
+        return false;
+      }
+
+      template<typename Type>
+      bool toArithmetic(const CborItem& in_item, Type& out_value, std::false_type /* isFloatingPoint */) const
+      {
+        if (std::is_same<Type, bool>::value)
+        {
+          if (in_item.type != CborType::boolean) { return false; }
+          out_value = in_item.argument != 0;
+          return true;
+        }
+
+        if (in_item.type == CborType::unsignedInteger)
+        {
+          if (in_item.argument > static_cast<uint64_t>(std::numeric_limits<Type>::max())) { return false; }
+          out_value = static_cast<Type>(in_item.argument);
+          return true;
+        }
+
+        if (in_item.type == CborType::negativeInteger)
+        {
+          if (!std::is_signed<Type>::value) { return false; }
+          if (in_item.argument > static_cast<uint64_t>(-1 - static_cast<int64_t>(std::numeric_limits<Type>::min()))) { return false; }
+          out_value = static_cast<Type>(-1 - static_cast<int64_t>(in_item.argument));
+          return true;
+        }
+
+        return false;
+      }
+
+      bool skipItem(size_t in_depth)
+      {
+        if (in_depth > c_maxSkipDepth) { return false; }
+
+        CborItem item;
+        if (!next(item) || item.type == CborType::breakStop) { return false; }
+
+        if (item.type == CborType::tag) { return skipItem(in_depth + 1); }
+        if (item.type != CborType::array && item.type != CborType::map && !item.isIndefinite) { return true; }
+
+        if (item.isIndefinite)
+        {
+          while (!isBreak())
+          {
+            if (!skipItem(in_depth + 1)) { return false; }
+          }
+          return next(item);
+        }
+
+        const uint64_t count = item.type == CborType::map ? item.argument * 2 : item.argument;
+        for (uint64_t index = 0; index < count; ++index)
+        {
+          if (!skipItem(in_depth + 1)) { return false; }
+        }
+        return true;
+      }
+
+    public:
+      CborDeserializer() = delete;
+      CborDeserializer(const uint8_t* in_begin) : m_begin(in_begin)
+      {}
+      CborDeserializer(const std::array<uint8_t, tc_bufferSize>& in_array) : m_begin(in_array.data())
+      {}
+
+      constexpr size_t getBufferSize() const
+      {
+        return tc_bufferSize;
+      }
+
+      size_t getBytesRead() const
+      {
+        return m_cursor;
+      }
+
+      size_t getBytesLeft() const
+      {
+        return tc_bufferSize - m_cursor;
+      }
+
+      const uint8_t* getBuffer() const
+      {
+        return m_begin;
+      }
+
+      // Decodes the next item head. Does not advance and returns false, if the item is incomplete or malformed.
+      bool next(CborItem& out_item)
+      {
+        const size_t size = peek(out_item);
+        if (size == 0) { return false; }
+
+        m_cursor = m_cursor + size;
+        return true;
+      }
+
+      bool isBreak() const
+      {
+        return m_cursor + 1 <= tc_bufferSize && m_begin[m_cursor] == (cbor::simple | cbor::indefinite);
+      }
+
+      // Skips the next item including all nested items.
+      bool skip()
+      {
+        const size_t cursor = m_cursor;
+        if (skipItem(0)) { return true; }
+
+        m_cursor = cursor;
+        return false;
+      }
+
+      template<typename Type>
+      Type read()
+      {
+        static_assert(std::is_arithmetic<Type>::value, "Type must be arithmetic!");
+        CborItem item;
+        Type value;
+        const size_t size = peek(item);
+        if (size == 0 || !toArithmetic<Type>(item, value, std::is_floating_point<Type>())) { return std::numeric_limits<Type>::max(); }
+
+        m_cursor = m_cursor + size;
+        return value;
+      }
+
+      template<typename Type>
+      Type readEnum()
+      {
+        using UnderlyingType = typename std::underlying_type<Type>::type;
+        static_assert(std::is_enum<Type>::value && std::is_arithmetic<UnderlyingType>::value, "Type must be an enum and underlying type must be arithmetic!");
+        return Type{ read<UnderlyingType>() };
+      }
+
+      // Returns a view of a definite length text string, which is NOT null terminated.
+      // Indefinite length strings have to be read chunk by chunk with next().
+      template<typename SizeType>
+      const char* view(SizeType& out_stringSize)
+      {
+        static_assert(isSizeType<SizeType>(), "SizeType must be an unsigned int!");
+        CborItem item;
+        const size_t size = peek(item);
+        if (size == 0 || item.type != CborType::textString || item.isIndefinite) { return nullptr; }
+        if (item.argument > std::numeric_limits<SizeType>::max()) { return nullptr; }
+
+        m_cursor = m_cursor + size;
+        out_stringSize = static_cast<SizeType>(item.argument);
+        return reinterpret_cast<const char*>(item.data);
+      }
+  };
+}
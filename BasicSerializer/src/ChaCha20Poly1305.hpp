@@ -0,0 +1,347 @@
+#pragma once
+
+#include <array>
+#include <cstring>
+
+#include "BasicSerializer.hpp"
+#include "ByteOrder.hpp"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+// **** **** **** ****
+// NOTE: ChaCha20-Poly1305 authenticated encryption (RFC 8439), in place on serialized buffers.
+//       sealChaCha20Poly1305 encrypts the bytes a Serializer has written and appends the 16 byte tag behind
+//       them, so the Serializer needs c_chaChaTagSize bytes left. openChaCha20Poly1305 verifies the tag in
+//       constant time and only then decrypts in place; on failure the buffer is left untouched.
+//       Never use a nonce twice with the same key (e.g. use a message counter)! in_associatedData is
+//       authenticated, but not encrypted (e.g. a plain header).
+//       ChaCha20 uses 32 bit operations only (one block at a time on the MCU, four at a time with SSE2 on
+//       the host), Poly1305 uses 26 bit limbs with 32x32 -> 64 bit multiplications, which suits the M7.
+// **** **** **** ****
+
+namespace halvoe
+{
+  static constexpr size_t c_chaChaKeySize = 32;
+  static constexpr size_t c_chaChaNonceSize = 12;
+  static constexpr size_t c_chaChaTagSize = 16;
+
+  using ChaChaKey = std::array<uint8_t, c_chaChaKeySize>;
+  using ChaChaNonce = std::array<uint8_t, c_chaChaNonceSize>;
+
+  namespace chacha20
+  {
+    static constexpr size_t c_blockSize = 64;
+
+    inline uint32_t rotate(uint32_t in_value, int in_shift)
+    {
+      return (in_value << in_shift) | (in_value >> (32 - in_shift));
+    }
+
+    inline void quarterRound(uint32_t* io_state, size_t in_a, size_t in_b, size_t in_c, size_t in_d)
+    {
+      io_state[in_a] = io_state[in_a] + io_state[in_b]; io_state[in_d] = rotate(io_state[in_d] ^ io_state[in_a], 16);
+      io_state[in_c] = io_state[in_c] + io_state[in_d]; io_state[in_b] = rotate(io_state[in_b] ^ io_state[in_c], 12);
+      io_state[in_a] = io_state[in_a] + io_state[in_b]; io_state[in_d] = rotate(io_state[in_d] ^ io_state[in_a], 8);
+      io_state[in_c] = io_state[in_c] + io_state[in_d]; io_state[in_b] = rotate(io_state[in_b] ^ io_state[in_c], 7);
+    }
+
+    inline void initialise(uint32_t* out_state, const ChaChaKey& in_key, uint32_t in_counter, const ChaChaNonce& in_nonce)
+    {
+      out_state[0] = 0x61707865;
+      out_state[1] = 0x3320646e;
+      out_state[2] = 0x79622d32;
+      out_state[3] = 0x6b206574;
+      for (size_t index = 0; index < 8; ++index) { out_state[4 + index] = loadLittleEndian<uint32_t>(in_key.data() + 4 * index); }
+      out_state[12] = in_counter;
+      for (size_t index = 0; index < 3; ++index) { out_state[13 + index] = loadLittleEndian<uint32_t>(in_nonce.data() + 4 * index); }
+    }
+
+    // The key stream block for in_state, as 16 words.
+    inline void getBlock(const uint32_t* in_state, uint32_t* out_words)
+    {
+      std::memcpy(out_words, in_state, 16 * sizeof(uint32_t));
+      for (size_t round = 0; round < 10; ++round)
+      {
+        quarterRound(out_words, 0, 4, 8, 12);
+        quarterRound(out_words, 1, 5, 9, 13);
+        quarterRound(out_words, 2, 6, 10, 14);
+        quarterRound(out_words, 3, 7, 11, 15);
+        quarterRound(out_words, 0, 5, 10, 15);
+        quarterRound(out_words, 1, 6, 11, 12);
+        quarterRound(out_words, 2, 7, 8, 13);
+        quarterRound(out_words, 3, 4, 9, 14);
+      }
+      for (size_t index = 0; index < 16; ++index) { out_words[index] = out_words[index] + in_state[index]; }
+    }
+
+    // XORs the key stream into in_size bytes, one block at a time; advances the block counter in io_state.
+    inline void applyScalar(uint32_t* io_state, uint8_t* io_data, size_t in_size)
+    {
+      uint32_t words[16];
+      while (in_size >= c_blockSize)
+      {
+        getBlock(io_state, words);
+        for (size_t index = 0; index < 16; ++index)
+        {
+          storeLittleEndian<uint32_t>(io_data + 4 * index, loadLittleEndian<uint32_t>(io_data + 4 * index) ^ words[index]);
+        }
+        io_state[12] = io_state[12] + 1;
+        io_data = io_data + c_blockSize;
+        in_size = in_size - c_blockSize;
+      }
+
+      if (in_size > 0)
+      {
+        uint8_t keyStream[c_blockSize];
+        getBlock(io_state, words);
+        for (size_t index = 0; index < 16; ++index) { storeLittleEndian<uint32_t>(keyStream + 4 * index, words[index]); }
+        for (size_t index = 0; index < in_size; ++index) { io_data[index] = io_data[index] ^ keyStream[index]; }
+        io_state[12] = io_state[12] + 1;
+      }
+    }
+
+#if defined(__SSE2__)
+    template<int tc_shift>
+    inline __m128i rotate(__m128i in_value)
+    {
+      return _mm_or_si128(_mm_slli_epi32(in_value, tc_shift), _mm_srli_epi32(in_value, 32 - tc_shift));
+    }
+
+    inline void quarterRound(__m128i* io_state, size_t in_a, size_t in_b, size_t in_c, size_t in_d)
+    {
+      io_state[in_a] = _mm_add_epi32(io_state[in_a], io_state[in_b]); io_state[in_d] = rotate<16>(_mm_xor_si128(io_state[in_d], io_state[in_a]));
+      io_state[in_c] = _mm_add_epi32(io_state[in_c], io_state[in_d]); io_state[in_b] = rotate<12>(_mm_xor_si128(io_state[in_b], io_state[in_c]));
+      io_state[in_a] = _mm_add_epi32(io_state[in_a], io_state[in_b]); io_state[in_d] = rotate<8>(_mm_xor_si128(io_state[in_d], io_state[in_a]));
+      io_state[in_c] = _mm_add_epi32(io_state[in_c], io_state[in_d]); io_state[in_b] = rotate<7>(_mm_xor_si128(io_state[in_b], io_state[in_c]));
+    }
+
+    // XORs four blocks (256 bytes) of key stream into io_data; word n of the four blocks is kept in one vector.
+    inline void applyFourBlocks(uint32_t* io_state, uint8_t* io_data)
+    {
+      __m128i initial[16];
+      __m128i words[16];
+      for (size_t index = 0; index < 16; ++index) { initial[index] = _mm_set1_epi32(static_cast<int>(io_state[index])); }
+      initial[12] = _mm_add_epi32(initial[12], _mm_set_epi32(3, 2, 1, 0));
+      std::memcpy(words, initial, sizeof(words));
+
+      for (size_t round = 0; round < 10; ++round)
+      {
+        quarterRound(words, 0, 4, 8, 12);
+        quarterRound(words, 1, 5, 9, 13);
+        quarterRound(words, 2, 6, 10, 14);
+        quarterRound(words, 3, 7, 11, 15);
+        quarterRound(words, 0, 5, 10, 15);
+        quarterRound(words, 1, 6, 11, 12);
+        quarterRound(words, 2, 7, 8, 13);
+        quarterRound(words, 3, 4, 9, 14);
+      }
+
+      for (size_t group = 0; group < 4; ++group)
+      {
+        const __m128i word0 = _mm_add_epi32(words[4 * group + 0], initial[4 * group + 0]);
+        const __m128i word1 = _mm_add_epi32(words[4 * group + 1], initial[4 * group + 1]);
+        const __m128i word2 = _mm_add_epi32(words[4 * group + 2], initial[4 * group + 2]);
+        const __m128i word3 = _mm_add_epi32(words[4 * group + 3], initial[4 * group + 3]);
+
+        // Transpose, so each vector holds words 4 * group .. 4 * group + 3 of one block.
+        const __m128i low01 = _mm_unpacklo_epi32(word0, word1);
+        const __m128i low23 = _mm_unpacklo_epi32(word2, word3);
+        const __m128i high01 = _mm_unpackhi_epi32(word0, word1);
+        const __m128i high23 = _mm_unpackhi_epi32(word2, word3);
+        const __m128i blocks[4] = { _mm_unpacklo_epi64(low01, low23), _mm_unpackhi_epi64(low01, low23),
+                                    _mm_unpacklo_epi64(high01, high23), _mm_unpackhi_epi64(high01, high23) };
+
+        for (size_t block = 0; block < 4; ++block)
+        {
+          __m128i* data = reinterpret_cast<__m128i*>(io_data + block * c_blockSize + group * 16);
+          _mm_storeu_si128(data, _mm_xor_si128(_mm_loadu_si128(data), blocks[block]));
+        }
+      }
+
+      io_state[12] = io_state[12] + 4;
+    }
+#endif
+
+    // XORs the key stream starting at block in_counter into in_size bytes.
+    inline void apply(const ChaChaKey& in_key, uint32_t in_counter, const ChaChaNonce& in_nonce, uint8_t* io_data, size_t in_size)
+    {
+      uint32_t state[16];
+      initialise(state, in_key, in_counter, in_nonce);
+
+#if defined(__SSE2__)
+      while (in_size >= 4 * c_blockSize)
+      {
+        applyFourBlocks(state, io_data);
+        io_data = io_data + 4 * c_blockSize;
+        in_size = in_size - 4 * c_blockSize;
+      }
+#endif
+
+      applyScalar(state, io_data, in_size);
+    }
+  }
+
+  namespace poly1305
+  {
+    static constexpr uint32_t c_limbMask = 0x3ffffff;
+
+    // Poly1305 over messages that are padded to 16 bytes with zeros, as the AEAD construction needs.
+    class PaddedPoly1305
+    {
+      private:
+        uint32_t m_r[5];
+        uint32_t m_h[5] = { 0, 0, 0, 0, 0 };
+        uint32_t m_pad[4];
+
+      private:
+        void processBlock(const uint8_t* in_block)
+        {
+          const uint32_t s1 = m_r[1] * 5;
+          const uint32_t s2 = m_r[2] * 5;
+          const uint32_t s3 = m_r[3] * 5;
+          const uint32_t s4 = m_r[4] * 5;
+
+          const uint32_t h0 = m_h[0] + (loadLittleEndian<uint32_t>(in_block + 0) & c_limbMask);
+          const uint32_t h1 = m_h[1] + ((loadLittleEndian<uint32_t>(in_block + 3) >> 2) & c_limbMask);
+          const uint32_t h2 = m_h[2] + ((loadLittleEndian<uint32_t>(in_block + 6) >> 4) & c_limbMask);
+          const uint32_t h3 = m_h[3] + ((loadLittleEndian<uint32_t>(in_block + 9) >> 6) & c_limbMask);
+          const uint32_t h4 = m_h[4] + ((loadLittleEndian<uint32_t>(in_block + 12) >> 8) | (uint32_t{ 1 } << 24));
+
+          uint64_t d0 = uint64_t{ h0 } * m_r[0] + uint64_t{ h1 } * s4 + uint64_t{ h2 } * s3 + uint64_t{ h3 } * s2 + uint64_t{ h4 } * s1;
+          uint64_t d1 = uint64_t{ h0 } * m_r[1] + uint64_t{ h1 } * m_r[0] + uint64_t{ h2 } * s4 + uint64_t{ h3 } * s3 + uint64_t{ h4 } * s2;
+          uint64_t d2 = uint64_t{ h0 } * m_r[2] + uint64_t{ h1 } * m_r[1] + uint64_t{ h2 } * m_r[0] + uint64_t{ h3 } * s4 + uint64_t{ h4 } * s3;
+          uint64_t d3 = uint64_t{ h0 } * m_r[3] + uint64_t{ h1 } * m_r[2] + uint64_t{ h2 } * m_r[1] + uint64_t{ h3 } * m_r[0] + uint64_t{ h4 } * s4;
+          uint64_t d4 = uint64_t{ h0 } * m_r[4] + uint64_t{ h1 } * m_r[3] + uint64_t{ h2 } * m_r[2] + uint64_t{ h3 } * m_r[1] + uint64_t{ h4 } * m_r[0];
+
+          d1 = d1 + (d0 >> 26); m_h[0] = static_cast<uint32_t>(d0) & c_limbMask;
+          d2 = d2 + (d1 >> 26); m_h[1] = static_cast<uint32_t>(d1) & c_limbMask;
+          d3 = d3 + (d2 >> 26); m_h[2] = static_cast<uint32_t>(d2) & c_limbMask;
+          d4 = d4 + (d3 >> 26); m_h[3] = static_cast<uint32_t>(d3) & c_limbMask;
+          const uint32_t carry = static_cast<uint32_t>(d4 >> 26); m_h[4] = static_cast<uint32_t>(d4) & c_limbMask;
+          m_h[0] = m_h[0] + carry * 5;
+          m_h[1] = m_h[1] + (m_h[0] >> 26); m_h[0] = m_h[0] & c_limbMask;
+        }
+
+      public:
+        PaddedPoly1305() = delete;
+        PaddedPoly1305(const uint8_t* in_key)
+        {
+          m_r[0] = loadLittleEndian<uint32_t>(in_key + 0) & 0x3ffffff;
+          m_r[1] = (loadLittleEndian<uint32_t>(in_key + 3) >> 2) & 0x3ffff03;
+          m_r[2] = (loadLittleEndian<uint32_t>(in_key + 6) >> 4) & 0x3ffc0ff;
+          m_r[3] = (loadLittleEndian<uint32_t>(in_key + 9) >> 6) & 0x3f03fff;
+          m_r[4] = (loadLittleEndian<uint32_t>(in_key + 12) >> 8) & 0x00fffff;
+          for (size_t index = 0; index < 4; ++index) { m_pad[index] = loadLittleEndian<uint32_t>(in_key + 16 + 4 * index); }
+        }
+
+        // Adds in_data, followed by zeros up to the next multiple of 16 bytes.
+        void update(const uint8_t* in_data, size_t in_size)
+        {
+          while (in_size >= 16)
+          {
+            processBlock(in_data);
+            in_data = in_data + 16;
+            in_size = in_size - 16;
+          }
+
+          if (in_size > 0)
+          {
+            uint8_t block[16] = {};
+            std::memcpy(block, in_data, in_size);
+            processBlock(block);
+          }
+        }
+
+        void finish(uint8_t* out_tag)
+        {
+          uint32_t h0 = m_h[0], h1 = m_h[1], h2 = m_h[2], h3 = m_h[3], h4 = m_h[4];
+          h2 = h2 + (h1 >> 26); h1 = h1 & c_limbMask;
+          h3 = h3 + (h2 >> 26); h2 = h2 & c_limbMask;
+          h4 = h4 + (h3 >> 26); h3 = h3 & c_limbMask;
+          h0 = h0 + (h4 >> 26) * 5; h4 = h4 & c_limbMask;
+          h1 = h1 + (h0 >> 26); h0 = h0 & c_limbMask;
+
+          // g = h + 5 - 2^130; use it instead of h, if it is not negative (constant time)
+          uint32_t g0 = h0 + 5;
+          uint32_t g1 = h1 + (g0 >> 26); g0 = g0 & c_limbMask;
+          uint32_t g2 = h2 + (g1 >> 26); g1 = g1 & c_limbMask;
+          uint32_t g3 = h3 + (g2 >> 26); g2 = g2 & c_limbMask;
+          uint32_t g4 = h4 + (g3 >> 26) - (uint32_t{ 1 } << 26); g3 = g3 & c_limbMask;
+
+          const uint32_t useG = (g4 >> 31) - 1;
+          h0 = (h0 & ~useG) | (g0 & useG);
+          h1 = (h1 & ~useG) | (g1 & useG);
+          h2 = (h2 & ~useG) | (g2 & useG);
+          h3 = (h3 & ~useG) | (g3 & useG);
+          h4 = (h4 & ~useG) | (g4 & useG);
+
+          const uint32_t words[4] = { h0 | (h1 << 26), (h1 >> 6) | (h2 << 20), (h2 >> 12) | (h3 << 14), (h3 >> 18) | (h4 << 8) };
+          uint64_t sum = 0;
+          for (size_t index = 0; index < 4; ++index)
+          {
+            sum = (sum >> 32) + words[index] + m_pad[index];
+            storeLittleEndian<uint32_t>(out_tag + 4 * index, static_cast<uint32_t>(sum));
+          }
+        }
+    };
+
+    inline void getTag(const ChaChaKey& in_key, const ChaChaNonce& in_nonce, const uint8_t* in_associatedData, size_t in_associatedDataSize,
+                       const uint8_t* in_cipherText, size_t in_cipherTextSize, uint8_t* out_tag)
+    {
+      uint8_t oneTimeKey[chacha20::c_blockSize] = {};
+      chacha20::apply(in_key, 0, in_nonce, oneTimeKey, sizeof(oneTimeKey));
+
+      PaddedPoly1305 poly1305(oneTimeKey);
+      poly1305.update(in_associatedData, in_associatedDataSize);
+      poly1305.update(in_cipherText, in_cipherTextSize);
+
+      uint8_t sizes[16];
+      storeLittleEndian<uint64_t>(sizes, in_associatedDataSize);
+      storeLittleEndian<uint64_t>(sizes + 8, in_cipherTextSize);
+      poly1305.update(sizes, sizeof(sizes));
+      poly1305.finish(out_tag);
+    }
+  }
+
+  // Encrypts in_size bytes of io_buffer in place and appends the tag. Returns the sealed size
+  // (in_size + c_chaChaTagSize), or 0 if in_capacity is too small.
+  inline size_t sealChaCha20Poly1305(uint8_t* io_buffer, size_t in_size, size_t in_capacity, const ChaChaKey& in_key, const ChaChaNonce& in_nonce,
+                                     const uint8_t* in_associatedData = nullptr, size_t in_associatedDataSize = 0)
+  {
+    if (in_size > in_capacity || c_chaChaTagSize > in_capacity - in_size) { return 0; }
+
+    chacha20::apply(in_key, 1, in_nonce, io_buffer, in_size);
+    poly1305::getTag(in_key, in_nonce, in_associatedData, in_associatedDataSize, io_buffer, in_size, io_buffer + in_size);
+    return in_size + c_chaChaTagSize;
+  }
+
+  // Encrypts the bytes written so far and appends the tag behind them. Send getBuffer()[0..returned size).
+  template<size_t tc_bufferSize, typename CursorType>
+  size_t sealChaCha20Poly1305(Serializer<tc_bufferSize, CursorType>& io_serializer, const ChaChaKey& in_key, const ChaChaNonce& in_nonce,
+                              const uint8_t* in_associatedData = nullptr, size_t in_associatedDataSize = 0)
+  {
+    return sealChaCha20Poly1305(io_serializer.getBuffer(), io_serializer.getBytesWritten(), tc_bufferSize, in_key, in_nonce, in_associatedData, in_associatedDataSize);
+  }
+
+  // Verifies the tag at the end of the in_sealedSize bytes of io_buffer and decrypts them in place.
+  // On success out_size is the size of the plain text at the start of io_buffer; on failure io_buffer is unchanged.
+  inline bool openChaCha20Poly1305(uint8_t* io_buffer, size_t in_sealedSize, const ChaChaKey& in_key, const ChaChaNonce& in_nonce, size_t& out_size,
+                                   const uint8_t* in_associatedData = nullptr, size_t in_associatedDataSize = 0)
+  {
+    if (in_sealedSize < c_chaChaTagSize) { return false; }
+
+    const size_t size = in_sealedSize - c_chaChaTagSize;
+    uint8_t tag[c_chaChaTagSize];
+    poly1305::getTag(in_key, in_nonce, in_associatedData, in_associatedDataSize, io_buffer, size, tag);
+
+    uint8_t difference = 0;
+    for (size_t index = 0; index < c_chaChaTagSize; ++index) { difference = difference | (tag[index] ^ io_buffer[size + index]); }
+    if (difference != 0) { return false; }
+
+    chacha20::apply(in_key, 1, in_nonce, io_buffer, size);
+    out_size = size;
+    return true;
+  }
+}
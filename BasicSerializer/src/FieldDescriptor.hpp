@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+// **** **** **** ****
+// NOTE: A FieldDescriptor describes one field of a message in the native Serializer format.
+//       An array of them (in write order) is the runtime schema used by the JSON tools.
+//       Enums are described by their underlying type, strings by the type of their size prefix.
+// **** **** **** ****
+
+namespace halvoe
+{
+  enum class FieldType : uint8_t
+  {
+    boolean,
+    int8,
+    uint8,
+    int16,
+    uint16,
+    int32,
+    uint32,
+    int64,
+    uint64,
+    float32,
+    float64,
+    string8,
+    string16,
+    string32
+  };
+
+  struct FieldDescriptor
+  {
+    const char* name;
+    FieldType type;
+  };
+}
@@ -0,0 +1,342 @@
+#pragma once
+
+#include <type_traits>
+#include <limits>
+#include <charconv>
+#include <cstring>
+
+#include "BasicSerializer.hpp"
+#include "FieldDescriptor.hpp"
+
+// **** **** **** ****
+// NOTE: JsonConverter turns JSON objects into messages in the native Serializer format, as described
+//       by a FieldDescriptor array. The text is parsed in a single pass and every value is written into
+//       the Serializer as soon as it is parsed, so no document tree is built.
+//       Because values are written directly, the keys have to appear in schema order and every field
+//       has to be present. Numbers are checked against the JSON grammar and parsed with std::from_chars.
+//       Strings without escape sequences are copied straight from the input; escaped strings are decoded
+//       in a scratch buffer of c_maxEscapedStringSize.
+// **** **** **** ****
+
+namespace halvoe
+{
+  class JsonConverter
+  {
+    static constexpr size_t c_maxEscapedStringSize = 256;
+
+    private:
+      const FieldDescriptor* m_fields;
+      size_t m_fieldCount;
+      const char* m_begin = nullptr;
+      size_t m_size = 0;
+      size_t m_cursor = 0;
+      size_t m_errorOffset = 0;
+
+    private:
+      bool fail()
+      {
+        m_errorOffset = m_cursor;
+        return false;
+      }
+
+      void skipWhitespace()
+      {
+        while (m_cursor < m_size)
+        {
+          const char character = m_begin[m_cursor];
+          if (character != ' ' && character != '\n' && character != '\r' && character != '\t') { return; }
+          m_cursor = m_cursor + 1;
+        }
+      }
+
+      bool consume(char in_character)
+      {
+        skipWhitespace();
+        if (m_cursor >= m_size || m_begin[m_cursor] != in_character) { return fail(); }
+
+        m_cursor = m_cursor + 1;
+        return true;
+      }
+
+      bool consumeLiteral(const char* in_literal, size_t in_size)
+      {
+        if (in_size > m_size - m_cursor || std::memcmp(m_begin + m_cursor, in_literal, in_size) != 0) { return fail(); }
+
+        m_cursor = m_cursor + in_size;
+        return true;
+      }
+
+      static int getHexValue(char in_character)
+      {
+        if (in_character >= '0' && in_character <= '9') { return in_character - '0'; }
+        if (in_character >= 'a' && in_character <= 'f') { return in_character - 'a' + 10; }
+        if (in_character >= 'A' && in_character <= 'F') { return in_character - 'A' + 10; }
+        return -1;
+      }
+
+      static size_t encodeUtf8(uint32_t in_codePoint, char* out_begin)
+      {
+        if (in_codePoint < 0x80) { out_begin[0] = static_cast<char>(in_codePoint); return 1; }
+        if (in_codePoint < 0x800)
+        {
+          out_begin[0] = static_cast<char>(0xc0 | (in_codePoint >> 6));
+          out_begin[1] = static_cast<char>(0x80 | (in_codePoint & 0x3f));
+          return 2;
+        }
+        if (in_codePoint < 0x10000)
+        {
+          out_begin[0] = static_cast<char>(0xe0 | (in_codePoint >> 12));
+          out_begin[1] = static_cast<char>(0x80 | ((in_codePoint >> 6) & 0x3f));
+          out_begin[2] = static_cast<char>(0x80 | (in_codePoint & 0x3f));
+          return 3;
+        }
+        out_begin[0] = static_cast<char>(0xf0 | (in_codePoint >> 18));
+        out_begin[1] = static_cast<char>(0x80 | ((in_codePoint >> 12) & 0x3f));
+        out_begin[2] = static_cast<char>(0x80 | ((in_codePoint >> 6) & 0x3f));
+        out_begin[3] = static_cast<char>(0x80 | (in_codePoint & 0x3f));
+        return 4;
+      }
+
+      static bool isDigit(char in_character)
+      {
+        return in_character >= '0' && in_character <= '9';
+      }
+
+      // from_chars also accepts inf, nan, leading zeros, "1." and ".5", which are no JSON numbers.
+      // Integers stop at '.' and 'e', so only floating point numbers need the fraction check.
+      template<typename Type>
+      static bool isJsonNumber(const char* in_begin, const char* in_end)
+      {
+        if (*in_begin == '-') { ++in_begin; }
+        if (in_begin == in_end || !isDigit(*in_begin)) { return false; }
+        if (*in_begin == '0' && in_begin + 1 != in_end && isDigit(in_begin[1])) { return false; }
+        if (!std::is_floating_point<Type>::value) { return true; }
+
+        for (const char* position = in_begin + 1; position != in_end; ++position)
+        {
+          if (*position == '.' && (position + 1 == in_end || !isDigit(position[1]))) { return false; }
+        }
+
+        return true;
+      }
+
+      // The key may hold any char, '\0' included, so never read fieldName behind its terminator.
+      static bool isFieldName(const char* in_key, size_t in_keySize, const char* in_fieldName)
+      {
+        size_t index = 0;
+        while (index < in_keySize && in_fieldName[index] != '\0' && in_fieldName[index] == in_key[index]) { index = index + 1; }
+        return index == in_keySize && in_fieldName[index] == '\0';
+      }
+
+      bool parseHex4(uint32_t& out_value)
+      {
+        if (4 > m_size - m_cursor) { return fail(); }
+
+        out_value = 0;
+        for (size_t index = 0; index < 4; ++index)
+        {
+          const int digit = getHexValue(m_begin[m_cursor + index]);
+          if (digit < 0) { return fail(); }
+          out_value = (out_value << 4) | static_cast<uint32_t>(digit);
+        }
+
+        m_cursor = m_cursor + 4;
+        return true;
+      }
+
+      // Decodes the escaped remainder of a string, starting at the first backslash.
+      bool parseEscapedString(char* out_string, size_t in_prefixSize, size_t& out_size)
+      {
+        size_t size = in_prefixSize;
+
+        while (m_cursor < m_size)
+        {
+          const char character = m_begin[m_cursor];
+          m_cursor = m_cursor + 1;
+
+          if (character == '"') { out_size = size; return true; }
+          if (size + 4 > c_maxEscapedStringSize) { return fail(); }
+          if (static_cast<uint8_t>(character) < 0x20) { return fail(); }
+          if (character != '\\') { out_string[size] = character; size = size + 1; continue; }
+          if (m_cursor >= m_size) { return fail(); }
+
+          const char escape = m_begin[m_cursor];
+          m_cursor = m_cursor + 1;
+
+          switch (escape)
+          {
+            case '"': out_string[size] = '"'; size = size + 1; break;
+            case '\\': out_string[size] = '\\'; size = size + 1; break;
+            case '/': out_string[size] = '/'; size = size + 1; break;
+            case 'b': out_string[size] = '\b'; size = size + 1; break;
+            case 'f': out_string[size] = '\f'; size = size + 1; break;
+            case 'n': out_string[size] = '\n'; size = size + 1; break;
+            case 'r': out_string[size] = '\r'; size = size + 1; break;
+            case 't': out_string[size] = '\t'; size = size + 1; break;
+            case 'u':
+            {
+              uint32_t codePoint;
+              if (!parseHex4(codePoint)) { return false; }
+              if (codePoint >= 0xdc00 && codePoint < 0xe000) { return fail(); } // a low surrogate without a high one
+              if (codePoint >= 0xd800 && codePoint < 0xdc00)
+              {
+                uint32_t lowSurrogate;
+                if (!consumeLiteral("\\u", 2) || !parseHex4(lowSurrogate)) { return false; }
+                if (lowSurrogate < 0xdc00 || lowSurrogate >= 0xe000) { return fail(); }
+                codePoint = 0x10000 + ((codePoint - 0xd800) << 10) + (lowSurrogate - 0xdc00);
+              }
+              size = size + encodeUtf8(codePoint, out_string + size);
+              break;
+            }
+            default: m_cursor = m_cursor - 1; return fail();
+          }
+        }
+
+        return fail();
+      }
+
+      // Returns a view of the string contents; escaped strings are decoded into io_scratch.
+      bool parseString(const char*& out_string, size_t& out_size, char* io_scratch)
+      {
+        if (!consume('"')) { return false; }
+
+        const size_t begin = m_cursor;
+        while (m_cursor < m_size)
+        {
+          const char character = m_begin[m_cursor];
+          if (character == '"')
+          {
+            out_string = m_begin + begin;
+            out_size = m_cursor - begin;
+            m_cursor = m_cursor + 1;
+            return true;
+          }
+          if (character == '\\') { break; }
+          if (static_cast<uint8_t>(character) < 0x20) { return fail(); }
+          m_cursor = m_cursor + 1;
+        }
+
+        if (m_cursor >= m_size) { return fail(); }
+
+        const size_t prefixSize = m_cursor - begin;
+        if (prefixSize > c_maxEscapedStringSize - 4) { return fail(); }
+        std::memcpy(io_scratch, m_begin + begin, prefixSize);
+        out_string = io_scratch;
+        return parseEscapedString(io_scratch, prefixSize, out_size);
+      }
+
+      template<typename Type>
+      bool parseNumber(Type& out_value)
+      {
+        skipWhitespace();
+        const char* begin = m_begin + m_cursor;
+        const std::from_chars_result result = std::from_chars(begin, m_begin + m_size, out_value);
+        if (result.ec != std::errc() || !isJsonNumber<Type>(begin, result.ptr)) { return fail(); }
+
+        m_cursor = static_cast<size_t>(result.ptr - m_begin);
+        return true;
+      }
+
+      bool parseBool(bool& out_value)
+      {
+        skipWhitespace();
+        if (m_cursor < m_size && m_begin[m_cursor] == 't') { out_value = true; return consumeLiteral("true", 4); }
+        out_value = false;
+        return consumeLiteral("false", 5);
+      }
+
+      template<typename Type, size_t tc_bufferSize, typename CursorType>
+      bool convertNumber(Serializer<tc_bufferSize, CursorType>& out_serializer)
+      {
+        Type value;
+        if (!parseNumber(value)) { return false; }
+        if (!out_serializer.template write<Type>(value)) { return fail(); }
+        return true;
+      }
+
+      template<typename SizeType, size_t tc_bufferSize, typename CursorType>
+      bool convertString(Serializer<tc_bufferSize, CursorType>& out_serializer)
+      {
+        char scratch[c_maxEscapedStringSize];
+        const char* string;
+        size_t size;
+        if (!parseString(string, size, scratch)) { return false; }
+        if (size > std::numeric_limits<SizeType>::max()) { return fail(); }
+        if (!out_serializer.write(string, static_cast<SizeType>(size))) { return fail(); }
+        return true;
+      }
+
+      template<size_t tc_bufferSize, typename CursorType>
+      bool convertValue(FieldType in_type, Serializer<tc_bufferSize, CursorType>& out_serializer)
+      {
+        switch (in_type)
+        {
+          case FieldType::boolean:
+          {
+            bool value;
+            if (!parseBool(value)) { return false; }
+            if (!out_serializer.template write<bool>(value)) { return fail(); }
+            return true;
+          }
+          case FieldType::int8: return convertNumber<int8_t>(out_serializer);
+          case FieldType::uint8: return convertNumber<uint8_t>(out_serializer);
+          case FieldType::int16: return convertNumber<int16_t>(out_serializer);
+          case FieldType::uint16: return convertNumber<uint16_t>(out_serializer);
+          case FieldType::int32: return convertNumber<int32_t>(out_serializer);
+          case FieldType::uint32: return convertNumber<uint32_t>(out_serializer);
+          case FieldType::int64: return convertNumber<int64_t>(out_serializer);
+          case FieldType::uint64: return convertNumber<uint64_t>(out_serializer);
+          case FieldType::float32: return convertNumber<float>(out_serializer);
+          case FieldType::float64: return convertNumber<double>(out_serializer);
+          case FieldType::string8: return convertString<uint8_t>(out_serializer);
+          case FieldType::string16: return convertString<uint16_t>(out_serializer);
+          case FieldType::string32: return convertString<uint32_t>(out_serializer);
+        }
+
+        return fail();
+      }
+
+    public:
+      JsonConverter() = delete;
+      JsonConverter(const FieldDescriptor* in_fields, size_t in_fieldCount) : m_fields(in_fields), m_fieldCount(in_fieldCount)
+      {}
+
+      // Offset into the last input at which conversion failed.
+      size_t getErrorOffset() const
+      {
+        return m_errorOffset;
+      }
+
+      // Converts the JSON object at the beginning of in_json and returns the number of chars consumed
+      // (including trailing whitespace), so a stream of objects can be converted in a loop.
+      // Returns 0 on error; the serializer may then hold a partially written message.
+      template<size_t tc_bufferSize, typename CursorType>
+      size_t convert(const char* in_json, size_t in_size, Serializer<tc_bufferSize, CursorType>& out_serializer)
+      {
+        m_begin = in_json;
+        m_size = in_size;
+        m_cursor = 0;
+        m_errorOffset = 0;
+
+        if (!consume('{')) { return 0; }
+
+        for (size_t index = 0; index < m_fieldCount; ++index)
+        {
+          char scratch[c_maxEscapedStringSize];
+          const char* key;
+          size_t keySize;
+          if (index > 0 && !consume(',')) { return 0; }
+          if (!parseString(key, keySize, scratch)) { return 0; }
+
+          if (!isFieldName(key, keySize, m_fields[index].name)) { m_cursor = m_cursor - 1; fail(); return 0; }
+          if (!consume(':')) { return 0; }
+          if (!convertValue(m_fields[index].type, out_serializer)) { return 0; }
+        }
+
+        if (!consume('}')) { return 0; }
+
+        skipWhitespace();
+        return m_cursor;
+      }
+  };
+}
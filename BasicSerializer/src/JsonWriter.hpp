@@ -0,0 +1,420 @@
+#pragma once
+
+#include <type_traits>
+#include <array>
+#include <charconv>
+#include <cmath>
+#include <cstring>
+
+#include "BasicSerializer.hpp"
+#include "FieldDescriptor.hpp"
+
+// **** **** **** ****
+// NOTE: JsonWriter formats JSON into your buffer of tc_bufferSize chars and never allocates.
+//       Numbers go through std::to_chars (shortest round trip form for floating point values; floats with
+//       up to three decimal places are printed as their exact decimal with integer formatting instead),
+//       strings are escaped with a lookup table and copied in runs.
+//       With a sink, a full buffer is handed to the sink and reused; without one, a full buffer
+//       puts the writer into a failed state. Commas between values are inserted automatically.
+// **** **** **** ****
+
+namespace halvoe
+{
+  namespace json
+  {
+    // 0: copy as is, 'u': \u00XX, otherwise the character following the backslash.
+    static constexpr std::array<char, 256> makeEscapeTable()
+    {
+      std::array<char, 256> table{};
+      for (size_t character = 0; character < 0x20; ++character) { table[character] = 'u'; }
+      table['"'] = '"';
+      table['\\'] = '\\';
+      table['\b'] = 'b';
+      table['\f'] = 'f';
+      table['\n'] = 'n';
+      table['\r'] = 'r';
+      table['\t'] = 't';
+      return table;
+    }
+
+    static constexpr std::array<char, 256> c_escapeTable = makeEscapeTable();
+    static constexpr char c_hexDigits[] = "0123456789abcdef";
+  }
+
+  using JsonSink = bool (*)(void* io_context, const char* in_data, size_t in_size);
+
+  template<size_t tc_bufferSize>
+  class JsonWriter
+  {
+    static constexpr size_t c_maxDepth = 32;
+    static constexpr size_t c_maxNumberSize = 32;
+
+    private:
+      char* m_begin;
+      size_t m_cursor = 0;
+      JsonSink m_sink = nullptr;
+      void* m_sinkContext = nullptr;
+      uint32_t m_hasElementsMask = 0; // bit n is set, if the container at depth n already holds an element
+      uint8_t m_depth = 0;
+      bool m_isAfterKey = false;
+      bool m_hasFailed = false;
+
+    private:
+      bool reserve(size_t in_size)
+      {
+        if (m_hasFailed) { return false; }
+        if (m_cursor + in_size <= tc_bufferSize) { return true; }
+        if (m_sink == nullptr || !flush() || in_size > tc_bufferSize) { m_hasFailed = true; return false; }
+        return true;
+      }
+
+      bool put(char in_character)
+      {
+        if (!reserve(1)) { return false; }
+
+        m_begin[m_cursor] = in_character;
+        m_cursor = m_cursor + 1;
+        return true;
+      }
+
+      bool put(const char* in_data, size_t in_size)
+      {
+        if (!m_hasFailed && in_size <= tc_bufferSize - m_cursor)
+        {
+          std::memcpy(m_begin + m_cursor, in_data, in_size);
+          m_cursor = m_cursor + in_size;
+          return true;
+        }
+
+        while (in_size > 0)
+        {
+          if (!reserve(1)) { return false; }
+
+          const size_t chunkSize = in_size < tc_bufferSize - m_cursor ? in_size : tc_bufferSize - m_cursor;
+          std::memcpy(m_begin + m_cursor, in_data, chunkSize);
+          m_cursor = m_cursor + chunkSize;
+          in_data = in_data + chunkSize;
+          in_size = in_size - chunkSize;
+        }
+
+        return !m_hasFailed;
+      }
+
+      bool beginValue()
+      {
+        if (m_isAfterKey) { m_isAfterKey = false; return !m_hasFailed; }
+
+        const uint32_t depthBit = uint32_t{ 1 } << m_depth;
+        if ((m_hasElementsMask & depthBit) != 0) { return put(','); }
+
+        m_hasElementsMask = m_hasElementsMask | depthBit;
+        return !m_hasFailed;
+      }
+
+      // in_suffix (the colon after a key) is appended after the closing quote, unless it is 0.
+      bool putEscaped(const char* in_string, size_t in_size, char in_suffix = 0)
+      {
+        size_t index = 0;
+        while (index < in_size && json::c_escapeTable[static_cast<uint8_t>(in_string[index])] == 0) { index = index + 1; }
+
+        // Without escapes (keys and most values), the string, its quotes and the suffix fit in with one copy.
+        if (index == in_size && !m_hasFailed && in_size + 3 <= tc_bufferSize - m_cursor)
+        {
+          char* const out = m_begin + m_cursor;
+          out[0] = '"';
+          std::memcpy(out + 1, in_string, in_size);
+          out[in_size + 1] = '"';
+          out[in_size + 2] = in_suffix;
+          m_cursor = m_cursor + in_size + (in_suffix == 0 ? 2 : 3);
+          return true;
+        }
+
+        if (!put('"')) { return false; }
+
+        size_t runBegin = 0;
+        for (; index < in_size; ++index)
+        {
+          const char escape = json::c_escapeTable[static_cast<uint8_t>(in_string[index])];
+          if (escape == 0) { continue; }
+
+          if (!put(in_string + runBegin, index - runBegin)) { return false; }
+          runBegin = index + 1;
+
+          if (escape != 'u')
+          {
+            const char sequence[2] = { '\\', escape };
+            if (!put(sequence, sizeof(sequence))) { return false; }
+          }
+          else
+          {
+            const uint8_t character = static_cast<uint8_t>(in_string[index]);
+            const char sequence[6] = { '\\', 'u', '0', '0', json::c_hexDigits[character >> 4], json::c_hexDigits[character & 0x0f] };
+            if (!put(sequence, sizeof(sequence))) { return false; }
+          }
+        }
+
+        return put(in_string + runBegin, in_size - runBegin) && put('"') && (in_suffix == 0 || put(in_suffix));
+      }
+
+      bool putNumber(bool in_value, std::true_type /* isBool */)
+      {
+        return in_value ? put("true", 4) : put("false", 5);
+      }
+
+      template<typename Type>
+      bool putNumber(Type in_value, std::false_type /* isBool */)
+      {
+        if (std::is_floating_point<Type>::value && !(in_value - in_value == 0)) { return put("null", 4); } // JSON has no NaN or infinity
+        if (m_hasFailed) { return false; }
+
+        // With room for any number, format in place; a copy out of a local buffer costs as much as the formatting.
+        if (tc_bufferSize - m_cursor >= c_maxNumberSize)
+        {
+          char* const end = formatNumber(m_begin + m_cursor, in_value);
+          if (end == nullptr) { m_hasFailed = true; return false; }
+
+          m_cursor = static_cast<size_t>(end - m_begin);
+          return true;
+        }
+
+        char number[c_maxNumberSize];
+        char* const end = formatNumber(number, in_value);
+        if (end == nullptr) { m_hasFailed = true; return false; }
+
+        return put(number, static_cast<size_t>(end - number));
+      }
+
+      template<typename Type>
+      static char* formatNumber(char* out_number, Type in_value)
+      {
+        const std::to_chars_result result = std::to_chars(out_number, out_number + c_maxNumberSize, in_value);
+        return result.ec == std::errc() ? result.ptr : nullptr;
+      }
+
+      // Floats with up to three decimal places (typical for sensor values and set points) are exact decimals:
+      // in_value * 1000 is computed exactly in double, so an integral product is printed with integer formatting,
+      // which costs a fraction of the shortest round trip search. Every other float goes through to_chars.
+      static char* formatNumber(char* out_number, float in_value)
+      {
+        const double scaled = static_cast<double>(in_value) * 1000.0;
+        if (!(scaled > -9007199254740992.0 && scaled < 9007199254740992.0) || scaled != static_cast<double>(static_cast<int64_t>(scaled)))
+        {
+          const std::to_chars_result result = std::to_chars(out_number, out_number + c_maxNumberSize, in_value);
+          return result.ec == std::errc() ? result.ptr : nullptr;
+        }
+
+        const int64_t thousandths = static_cast<int64_t>(scaled);
+        const uint64_t magnitude = thousandths < 0 ? static_cast<uint64_t>(-thousandths) : static_cast<uint64_t>(thousandths);
+        char* cursor = out_number;
+        if (std::signbit(in_value)) { *cursor = '-'; cursor = cursor + 1; }
+
+        cursor = std::to_chars(cursor, out_number + c_maxNumberSize, magnitude / 1000).ptr;
+        uint32_t fraction = static_cast<uint32_t>(magnitude % 1000);
+        if (fraction == 0) { return cursor; }
+
+        *cursor = '.';
+        cursor = cursor + 1;
+        for (uint32_t divisor = 100; fraction != 0; divisor = divisor / 10)
+        {
+          *cursor = static_cast<char>('0' + fraction / divisor);
+          cursor = cursor + 1;
+          fraction = fraction % divisor;
+        }
+        return cursor;
+      }
+
+      bool open(char in_bracket)
+      {
+        if (m_depth + size_t{ 1 } >= c_maxDepth) { m_hasFailed = true; return false; }
+        if (!beginValue() || !put(in_bracket)) { return false; }
+
+        m_depth = m_depth + 1;
+        m_hasElementsMask = m_hasElementsMask & ~(uint32_t{ 1 } << m_depth);
+        return true;
+      }
+
+      bool close(char in_bracket)
+      {
+        if (m_depth == 0 || m_isAfterKey) { m_hasFailed = true; return false; }
+
+        m_depth = m_depth - 1;
+        return put(in_bracket);
+      }
+
+    public:
+      JsonWriter() = delete;
+      JsonWriter(char* out_begin) : m_begin(out_begin)
+      {}
+      JsonWriter(std::array<char, tc_bufferSize>& out_array) : m_begin(out_array.data())
+      {}
+      JsonWriter(char* out_begin, JsonSink in_sink, void* io_sinkContext) : m_begin(out_begin), m_sink(in_sink), m_sinkContext(io_sinkContext)
+      {}
+      JsonWriter(std::array<char, tc_bufferSize>& out_array, JsonSink in_sink, void* io_sinkContext) : m_begin(out_array.data()), m_sink(in_sink), m_sinkContext(io_sinkContext)
+      {}
+
+      constexpr size_t getBufferSize() const
+      {
+        return tc_bufferSize;
+      }
+
+      // The pending (not yet flushed) output; it is NOT null terminated.
+      const char* getBuffer() const
+      {
+        return m_begin;
+      }
+
+      size_t getSize() const
+      {
+        return m_cursor;
+      }
+
+      bool hasFailed() const
+      {
+        return m_hasFailed;
+      }
+
+      bool isComplete() const
+      {
+        return m_depth == 0 && !m_isAfterKey && !m_hasFailed;
+      }
+
+      // Hands the pending output to the sink. Without a sink the output stays in the buffer.
+      bool flush()
+      {
+        if (m_sink == nullptr || m_cursor == 0) { return true; }
+        if (!m_sink(m_sinkContext, m_begin, m_cursor)) { m_hasFailed = true; return false; }
+
+        m_cursor = 0;
+        return true;
+      }
+
+      // Starts a new top level value; pending output is kept.
+      void reset()
+      {
+        m_hasElementsMask = 0;
+        m_depth = 0;
+        m_isAfterKey = false;
+        m_hasFailed = false;
+      }
+
+      bool beginObject()
+      {
+        return open('{');
+      }
+
+      bool endObject()
+      {
+        return close('}');
+      }
+
+      bool beginArray()
+      {
+        return open('[');
+      }
+
+      bool endArray()
+      {
+        return close(']');
+      }
+
+      bool key(const char* in_key, size_t in_size)
+      {
+        if (m_isAfterKey || !beginValue() || !putEscaped(in_key, in_size, ':')) { return false; }
+
+        m_isAfterKey = true;
+        return true;
+      }
+
+      bool key(const char* in_key)
+      {
+        return key(in_key, std::strlen(in_key));
+      }
+
+      template<typename Type>
+      bool value(Type in_value)
+      {
+        static_assert(std::is_arithmetic<Type>::value, "Type must be arithmetic!");
+        if (!beginValue()) { return false; }
+
+        return putNumber(in_value, std::is_same<Type, bool>());
+      }
+
+      template<typename Type>
+      bool valueEnum(Type in_value)
+      {
+        using UnderlyingType = typename std::underlying_type<Type>::type;
+        static_assert(std::is_enum<Type>::value && std::is_arithmetic<UnderlyingType>::value, "Type must be an enum and underlying type must be arithmetic!");
+        return value<UnderlyingType>(static_cast<UnderlyingType>(in_value));
+      }
+
+      bool value(const char* in_string, size_t in_size)
+      {
+        return beginValue() && putEscaped(in_string, in_size);
+      }
+
+      bool nullValue()
+      {
+        return beginValue() && put("null", 4);
+      }
+  };
+
+  namespace json
+  {
+    template<typename Type, size_t tc_bufferSize, typename CursorType, size_t tc_jsonBufferSize>
+    bool copyValue(Deserializer<tc_bufferSize, CursorType>& io_deserializer, JsonWriter<tc_jsonBufferSize>& out_writer)
+    {
+      if (!io_deserializer.template fitsInBuffer<Type>()) { return false; }
+
+      const Type value = io_deserializer.template read<Type>();
+#if defined(HALVOE_SERIALIZER_TYPE_TAGS)
+      if (io_deserializer.hasTypeTagMismatch()) { return false; }
+#endif
+      return out_writer.value(value);
+    }
+
+    template<typename SizeType, size_t tc_bufferSize, typename CursorType, size_t tc_jsonBufferSize>
+    bool copyString(Deserializer<tc_bufferSize, CursorType>& io_deserializer, JsonWriter<tc_jsonBufferSize>& out_writer)
+    {
+      SizeType size;
+      const char* string = io_deserializer.view(size);
+      if (string == nullptr) { return false; }
+
+      return out_writer.value(string, size);
+    }
+  }
+
+  // Reads one message described by in_fields from io_deserializer and writes it as JSON object.
+  template<size_t tc_bufferSize, typename CursorType, size_t tc_jsonBufferSize>
+  bool writeJson(Deserializer<tc_bufferSize, CursorType>& io_deserializer, const FieldDescriptor* in_fields, size_t in_fieldCount, JsonWriter<tc_jsonBufferSize>& out_writer)
+  {
+    if (!out_writer.beginObject()) { return false; }
+
+    for (size_t index = 0; index < in_fieldCount; ++index)
+    {
+      if (!out_writer.key(in_fields[index].name)) { return false; }
+
+      bool isCopied = false;
+      switch (in_fields[index].type)
+      {
+        case FieldType::boolean: isCopied = json::copyValue<bool>(io_deserializer, out_writer); break;
+        case FieldType::int8: isCopied = json::copyValue<int8_t>(io_deserializer, out_writer); break;
+        case FieldType::uint8: isCopied = json::copyValue<uint8_t>(io_deserializer, out_writer); break;
+        case FieldType::int16: isCopied = json::copyValue<int16_t>(io_deserializer, out_writer); break;
+        case FieldType::uint16: isCopied = json::copyValue<uint16_t>(io_deserializer, out_writer); break;
+        case FieldType::int32: isCopied = json::copyValue<int32_t>(io_deserializer, out_writer); break;
+        case FieldType::uint32: isCopied = json::copyValue<uint32_t>(io_deserializer, out_writer); break;
+        case FieldType::int64: isCopied = json::copyValue<int64_t>(io_deserializer, out_writer); break;
+        case FieldType::uint64: isCopied = json::copyValue<uint64_t>(io_deserializer, out_writer); break;
+        case FieldType::float32: isCopied = json::copyValue<float>(io_deserializer, out_writer); break;
+        case FieldType::float64: isCopied = json::copyValue<double>(io_deserializer, out_writer); break;
+        case FieldType::string8: isCopied = json::copyString<uint8_t>(io_deserializer, out_writer); break;
+        case FieldType::string16: isCopied = json::copyString<uint16_t>(io_deserializer, out_writer); break;
+        case FieldType::string32: isCopied = json::copyString<uint32_t>(io_deserializer, out_writer); break;
+      }
+
+      if (!isCopied) { return false; }
+    }
+
+    return out_writer.endObject();
+  }
+}
@@ -0,0 +1,195 @@
+#pragma once
+
+#include <type_traits>
+#include <limits>
+#include <atomic>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+// **** **** **** ****
+// NOTE: LatencyHistogram counts uint32_t durations (in ticks of your clock, e.g. ns on the host or
+//       ARM_DWT_CYCCNT cycles on the MCU) in log-linear buckets, like an HDR histogram:
+//       values below 2^tc_precisionBits are exact, larger values are kept with a relative error of
+//       at most 2^-(tc_precisionBits - 1). Memory is fixed (getBucketCount() * 4 bytes) and record()
+//       is lock-free and safe to call from an interrupt: two relaxed fetch_adds (bucket and count) and
+//       a compare-exchange loop for the maximum. The three updates are not one atomic snapshot, so
+//       reading percentiles while another context records gives an approximate result, in which the
+//       count, the buckets and the maximum may disagree by the records in flight.
+// **** **** **** ****
+
+namespace halvoe
+{
+  template<size_t tc_precisionBits = 5>
+  class LatencyHistogram
+  {
+    static_assert(tc_precisionBits >= 2 && tc_precisionBits <= 16, "tc_precisionBits must be between 2 and 16!");
+    static constexpr size_t c_subBucketCount = size_t{ 1 } << tc_precisionBits;
+    static constexpr size_t c_halfSubBucketCount = c_subBucketCount / 2;
+    static constexpr size_t c_bucketCount = ((32 - tc_precisionBits) + 2) * c_halfSubBucketCount;
+
+    private:
+      std::array<std::atomic<uint32_t>, c_bucketCount> m_buckets{};
+      std::atomic<uint32_t> m_count{ 0 };
+      std::atomic<uint32_t> m_max{ 0 };
+
+    private:
+      static size_t getIndex(uint32_t in_value)
+      {
+        if (in_value < c_subBucketCount) { return in_value; }
+
+        const size_t shift = static_cast<size_t>(31 - __builtin_clz(in_value)) - (tc_precisionBits - 1);
+        return (shift << (tc_precisionBits - 1)) + (in_value >> shift);
+      }
+
+      // The highest value that falls into the bucket at in_index.
+      static uint32_t getHighestValue(size_t in_index)
+      {
+        if (in_index < c_subBucketCount) { return static_cast<uint32_t>(in_index); }
+
+        const size_t shift = (in_index >> (tc_precisionBits - 1)) - 1;
+        const uint64_t lowest = static_cast<uint64_t>(in_index - (shift << (tc_precisionBits - 1))) << shift;
+        const uint64_t highest = lowest + (uint64_t{ 1 } << shift) - 1;
+        return highest > std::numeric_limits<uint32_t>::max() ? std::numeric_limits<uint32_t>::max() : static_cast<uint32_t>(highest);
+      }
+
+    public:
+      static constexpr size_t getBucketCount()
+      {
+        return c_bucketCount;
+      }
+
+      void record(uint32_t in_value)
+      {
+        m_buckets[getIndex(in_value)].fetch_add(1, std::memory_order_relaxed);
+        m_count.fetch_add(1, std::memory_order_relaxed);
+
+        uint32_t max = m_max.load(std::memory_order_relaxed);
+        while (in_value > max && !m_max.compare_exchange_weak(max, in_value, std::memory_order_relaxed)) {}
+      }
+
+      uint32_t getCount() const
+      {
+        return m_count.load(std::memory_order_relaxed);
+      }
+
+      uint32_t getMax() const
+      {
+        return m_max.load(std::memory_order_relaxed);
+      }
+
+      // Returns the smallest recorded value (within the bucket precision), that in_percentile percent
+      // of all values are less than or equal to. Returns 0, if nothing was recorded.
+      uint32_t getValueAtPercentile(double in_percentile) const
+      {
+        const uint32_t count = getCount();
+        if (count == 0) { return 0; }
+
+        const double rank = in_percentile >= 100.0 ? count : in_percentile / 100.0 * count;
+        uint32_t target = static_cast<uint32_t>(rank);
+        if (target < rank || target == 0) { target = target + 1; }
+
+        uint32_t cumulative = 0;
+        for (size_t index = 0; index < c_bucketCount; ++index)
+        {
+          cumulative = cumulative + m_buckets[index].load(std::memory_order_relaxed);
+          if (cumulative >= target)
+          {
+            const uint32_t value = getHighestValue(index);
+            return value < getMax() ? value : getMax();
+          }
+        }
+
+        return getMax();
+      }
+
+      void reset()
+      {
+        for (std::atomic<uint32_t>& bucket : m_buckets) { bucket.store(0, std::memory_order_relaxed); }
+        m_count.store(0, std::memory_order_relaxed);
+        m_max.store(0, std::memory_order_relaxed);
+      }
+  };
+
+  enum class LatencyStage : uint8_t
+  {
+    serialize = 0,
+    frame,
+    checksum,
+    enqueue,
+    total
+  };
+
+  struct LatencyReport
+  {
+    uint32_t count = 0;
+    uint32_t p50 = 0;
+    uint32_t p99 = 0;
+    uint32_t p999 = 0;
+    uint32_t max = 0;
+  };
+
+  // Returns the current time in ticks; differences are taken modulo 2^32, so the clock may wrap.
+  using LatencyClock = uint32_t (*)();
+
+  // Times the stages of one message at a time:
+  //   begin(); serialize; mark(LatencyStage::serialize); frame; mark(LatencyStage::frame); ...; end();
+  // mark() records the time since the previous begin() or mark(), end() the time since begin() as total.
+  // Stages you do not have are simply not marked.
+  template<size_t tc_precisionBits = 5>
+  class StageLatencyRecorder
+  {
+    static constexpr size_t c_stageCount = static_cast<size_t>(LatencyStage::total) + 1;
+
+    private:
+      LatencyClock m_clock;
+      std::array<LatencyHistogram<tc_precisionBits>, c_stageCount> m_histograms;
+      uint32_t m_beginTime = 0;
+      uint32_t m_markTime = 0;
+
+    public:
+      StageLatencyRecorder() = delete;
+      StageLatencyRecorder(LatencyClock in_clock) : m_clock(in_clock)
+      {}
+
+      void begin()
+      {
+        m_beginTime = m_clock();
+        m_markTime = m_beginTime;
+      }
+
+      void mark(LatencyStage in_stage)
+      {
+        const uint32_t now = m_clock();
+        m_histograms[static_cast<size_t>(in_stage)].record(now - m_markTime);
+        m_markTime = now;
+      }
+
+      void end()
+      {
+        m_histograms[static_cast<size_t>(LatencyStage::total)].record(m_clock() - m_beginTime);
+      }
+
+      const LatencyHistogram<tc_precisionBits>& getHistogram(LatencyStage in_stage) const
+      {
+        return m_histograms[static_cast<size_t>(in_stage)];
+      }
+
+      LatencyReport getReport(LatencyStage in_stage) const
+      {
+        const LatencyHistogram<tc_precisionBits>& histogram = getHistogram(in_stage);
+        LatencyReport report;
+        report.count = histogram.getCount();
+        report.p50 = histogram.getValueAtPercentile(50.0);
+        report.p99 = histogram.getValueAtPercentile(99.0);
+        report.p999 = histogram.getValueAtPercentile(99.9);
+        report.max = histogram.getMax();
+        return report;
+      }
+
+      void reset()
+      {
+        for (LatencyHistogram<tc_precisionBits>& histogram : m_histograms) { histogram.reset(); }
+      }
+  };
+}
@@ -0,0 +1,518 @@
+#pragma once
+
+#include <type_traits>
+#include <limits>
+#include <array>
+#include <cstring>
+
+#include "BasicSerializer.hpp"
+#include "ByteOrder.hpp"
+
+// **** **** **** ****
+// NOTE: MessagePackSerializer and MessagePackDeserializer have the same write/read interface as
+//       Serializer and Deserializer, but produce and consume MessagePack (https://msgpack.org).
+//       Integers and strings always use the most compact format that holds the value.
+//       Both types never allocate; strings and binaries are read as views into the buffer.
+// **** **** **** ****
+
+namespace halvoe
+{
+  namespace msgpack
+  {
+    enum Marker : uint8_t
+    {
+      positiveFixIntMax = 0x7f,
+      fixMap = 0x80,
+      fixArray = 0x90,
+      fixString = 0xa0,
+      nil = 0xc0,
+      falseValue = 0xc2,
+      trueValue = 0xc3,
+      binary8 = 0xc4,
+      binary16 = 0xc5,
+      binary32 = 0xc6,
+      float32 = 0xca,
+      float64 = 0xcb,
+      uint8 = 0xcc,
+      uint16 = 0xcd,
+      uint32 = 0xce,
+      uint64 = 0xcf,
+      int8 = 0xd0,
+      int16 = 0xd1,
+      int32 = 0xd2,
+      int64 = 0xd3,
+      string8 = 0xd9,
+      string16 = 0xda,
+      string32 = 0xdb,
+      array16 = 0xdc,
+      array32 = 0xdd,
+      map16 = 0xde,
+      map32 = 0xdf,
+      negativeFixIntMin = 0xe0
+    };
+  }
+
+  template<size_t tc_bufferSize>
+  class MessagePackSerializer
+  {
+    private:
+      uint8_t* m_begin;
+      size_t m_cursor = 0;
+
+    private:
+      template<typename Type>
+      bool writeMarkerAndValue(uint8_t in_marker, Type in_value)
+      {
+        if (m_cursor + 1 + sizeof(Type) > tc_bufferSize) { return false; }
+
+        m_begin[m_cursor] = in_marker;
+        storeBigEndian<Type>(m_begin + m_cursor + 1, in_value);
+        m_cursor = m_cursor + 1 + sizeof(Type);
+        return true;
+      }
+
+      bool writeMarker(uint8_t in_marker)
+      {
+        if (m_cursor + 1 > tc_bufferSize) { return false; }
+
+        m_begin[m_cursor] = in_marker;
+        m_cursor = m_cursor + 1;
+        return true;
+      }
+
+      bool writeUnsigned(uint64_t in_value)
+      {
+        if (in_value <= msgpack::positiveFixIntMax) { return writeMarker(static_cast<uint8_t>(in_value)); }
+        if (in_value <= std::numeric_limits<uint8_t>::max()) { return writeMarkerAndValue<uint8_t>(msgpack::uint8, static_cast<uint8_t>(in_value)); }
+        if (in_value <= std::numeric_limits<uint16_t>::max()) { return writeMarkerAndValue<uint16_t>(msgpack::uint16, static_cast<uint16_t>(in_value)); }
+        if (in_value <= std::numeric_limits<uint32_t>::max()) { return writeMarkerAndValue<uint32_t>(msgpack::uint32, static_cast<uint32_t>(in_value)); }
+        return writeMarkerAndValue<uint64_t>(msgpack::uint64, in_value);
+      }
+
+      bool writeSigned(int64_t in_value)
+      {
+        if (in_value >= 0) { return writeUnsigned(static_cast<uint64_t>(in_value)); }
+        if (in_value >= -32) { return writeMarker(static_cast<uint8_t>(in_value)); }
+        if (in_value >= std::numeric_limits<int8_t>::min()) { return writeMarkerAndValue<uint8_t>(msgpack::int8, static_cast<uint8_t>(in_value)); }
+        if (in_value >= std::numeric_limits<int16_t>::min()) { return writeMarkerAndValue<uint16_t>(msgpack::int16, static_cast<uint16_t>(in_value)); }
+        if (in_value >= std::numeric_limits<int32_t>::min()) { return writeMarkerAndValue<uint32_t>(msgpack::int32, static_cast<uint32_t>(in_value)); }
+        return writeMarkerAndValue<uint64_t>(msgpack::int64, static_cast<uint64_t>(in_value));
+      }
+
+      bool writeHeader(uint32_t in_size, uint8_t in_fixMarker, uint32_t in_fixMax, uint8_t in_marker8, uint8_t in_marker16, uint8_t in_marker32)
+      {
+        if (in_size <= in_fixMax) { return writeMarker(static_cast<uint8_t>(in_fixMarker | in_size)); }
+        if (in_marker8 != msgpack::nil && in_size <= std::numeric_limits<uint8_t>::max()) { return writeMarkerAndValue<uint8_t>(in_marker8, static_cast<uint8_t>(in_size)); }
+        if (in_size <= std::numeric_limits<uint16_t>::max()) { return writeMarkerAndValue<uint16_t>(in_marker16, static_cast<uint16_t>(in_size)); }
+        return writeMarkerAndValue<uint32_t>(in_marker32, in_size);
+      }
+
+      bool writeBytes(const void* in_data, size_t in_size)
+      {
+        if (in_size > tc_bufferSize - m_cursor) { return false; }
+
+        std::memcpy(m_begin + m_cursor, in_data, in_size);
+        m_cursor = m_cursor + in_size;
+        return true;
+      }
+
+      bool writeFloatingPoint(float in_value)
+      {
+        uint32_t bits;
+        std::memcpy(&bits, &in_value, sizeof(bits));
+        return writeMarkerAndValue<uint32_t>(msgpack::float32, bits);
+      }
+
+      bool writeFloatingPoint(double in_value)
+      {
+        uint64_t bits;
+        std::memcpy(&bits, &in_value, sizeof(bits));
+        return writeMarkerAndValue<uint64_t>(msgpack::float64, bits);
+      }
+
+      bool writeFloatingPoint(long double in_value)
+      {
+        return writeFloatingPoint(static_cast<double>(in_value));
+      }
+
+      template<typename Type>
+      bool writeArithmetic(Type in_value, std::true_type /* isFloatingPoint */)
+      {
+        return writeFloatingPoint(in_value);
+      }
+
+      template<typename Type>
+      bool writeArithmetic(Type in_value, std::false_type /* isFloatingPoint */)
+      {
+        return writeInteger(in_value, std::is_signed<Type>());
+      }
+
+      bool writeArithmetic(bool in_value, std::false_type /* isFloatingPoint */)
+      {
+        return writeMarker(in_value ? msgpack::trueValue : msgpack::falseValue);
+      }
+
+      template<typename Type>
+      bool writeInteger(Type in_value, std::true_type /* isSigned */)
+      {
+        return writeSigned(static_cast<int64_t>(in_value));
+      }
+
+      template<typename Type>
+      bool writeInteger(Type in_value, std::false_type /* isSigned */)
+      {
+        return writeUnsigned(static_cast<uint64_t>(in_value));
+      }
+
+      static constexpr size_t getStringHeaderSize(size_t in_size)
+      {
+        return in_size <= 31 ? 1 :
+               in_size <= std::numeric_limits<uint8_t>::max() ? 2 :
+               in_size <= std::numeric_limits<uint16_t>::max() ? 3 : 5;
+      }
+
+    public:
+      MessagePackSerializer() = delete;
+      MessagePackSerializer(uint8_t* out_begin) : m_begin(out_begin)
+      {}
+      MessagePackSerializer(std::array<uint8_t, tc_bufferSize>& out_array) : m_begin(out_array.data())
+      {}
+
+      constexpr size_t getBufferSize() const
+      {
+        return tc_bufferSize;
+      }
+
+      size_t getBytesWritten() const
+      {
+        return m_cursor;
+      }
+
+      size_t getBytesLeft() const
+      {
+        return tc_bufferSize - m_cursor;
+      }
+
+      uint8_t* getBuffer()
+      {
+        return m_begin;
+      }
+
+      const uint8_t* getBuffer() const
+      {
+        return m_begin;
+      }
+
+      bool fitsInBuffer(size_t in_size) const
+      {
+        return in_size <= tc_bufferSize - m_cursor;
+      }
+
+      template<typename Type>
+      bool write(Type in_value)
+      {
+        static_assert(std::is_arithmetic<Type>::value, "Type must be arithmetic!");
+        return writeArithmetic(in_value, std::is_floating_point<Type>());
+      }
+
+      template<typename Type>
+      bool writeEnum(Type in_value)
+      {
+        using UnderlyingType = typename std::underlying_type<Type>::type;
+        static_assert(std::is_enum<Type>::value && std::is_arithmetic<UnderlyingType>::value, "Type must be an enum and underlying type must be arithmetic!");
+        return write<UnderlyingType>(static_cast<UnderlyingType>(in_value));
+      }
+
+      template<typename SizeType>
+      bool write(const char* in_string, SizeType in_size)
+      {
+        static_assert(isSizeType<SizeType>(), "SizeType must be an unsigned int!");
+        if (in_size > std::numeric_limits<uint32_t>::max()) { return false; }
+        if (!fitsInBuffer(getStringHeaderSize(in_size)) || in_size > getBytesLeft() - getStringHeaderSize(in_size)) { return false; }
+
+        writeHeader(static_cast<uint32_t>(in_size), msgpack::fixString, 31, msgpack::string8, msgpack::string16, msgpack::string32);
+        return writeBytes(in_string, in_size);
+      }
+
+      bool writeBinary(const uint8_t* in_data, size_t in_size)
+      {
+        if (in_size > std::numeric_limits<uint32_t>::max()) { return false; }
+        const size_t headerSize = in_size <= std::numeric_limits<uint8_t>::max() ? 2 : in_size <= std::numeric_limits<uint16_t>::max() ? 3 : 5;
+        if (!fitsInBuffer(headerSize) || in_size > getBytesLeft() - headerSize) { return false; }
+
+        if (in_size <= std::numeric_limits<uint8_t>::max()) { writeMarkerAndValue<uint8_t>(msgpack::binary8, static_cast<uint8_t>(in_size)); }
+        else if (in_size <= std::numeric_limits<uint16_t>::max()) { writeMarkerAndValue<uint16_t>(msgpack::binary16, static_cast<uint16_t>(in_size)); }
+        else { writeMarkerAndValue<uint32_t>(msgpack::binary32, static_cast<uint32_t>(in_size)); }
+        return writeBytes(in_data, in_size);
+      }
+
+      bool writeNil()
+      {
+        return writeMarker(msgpack::nil);
+      }
+
+      // The elements (or key/value pairs) have to be written right after the header.
+      bool writeArrayHeader(uint32_t in_elementCount)
+      {
+        return writeHeader(in_elementCount, msgpack::fixArray, 15, msgpack::nil, msgpack::array16, msgpack::array32);
+      }
+
+      bool writeMapHeader(uint32_t in_pairCount)
+      {
+        return writeHeader(in_pairCount, msgpack::fixMap, 15, msgpack::nil, msgpack::map16, msgpack::map32);
+      }
+  };
+
+  template<size_t tc_bufferSize>
+  class MessagePackDeserializer
+  {
+    private:
+      const uint8_t* m_begin;
+      size_t m_cursor = 0;
+
+    private:
+      template<typename Type>
+      bool peekValue(size_t in_offset, Type& out_value) const
+      {
+        if (m_cursor + in_offset + sizeof(Type) > tc_bufferSize) { return false; }
+
+        out_value = loadBigEndian<Type>(m_begin + m_cursor + in_offset);
+        return true;
+      }
+
+      // Decodes any integer format into magnitude and sign without advancing the cursor.
+      bool peekInteger(uint64_t& out_magnitude, bool& out_isNegative, size_t& out_size) const
+      {
+        if (m_cursor + 1 > tc_bufferSize) { return false; }
+
+        const uint8_t marker = m_begin[m_cursor];
+        out_isNegative = false;
+
+        if (marker <= msgpack::positiveFixIntMax) { out_magnitude = marker; out_size = 1; return true; }
+        if (marker >= msgpack::negativeFixIntMin) { out_magnitude = static_cast<uint64_t>(static_cast<int64_t>(static_cast<int8_t>(marker))); out_isNegative = true; out_size = 1; return true; }
+
+        switch (marker)
+        {
+          case msgpack::uint8: { uint8_t value; if (!peekValue(1, value)) { return false; } out_magnitude = value; out_size = 2; return true; }
+          case msgpack::uint16: { uint16_t value; if (!peekValue(1, value)) { return false; } out_magnitude = value; out_size = 3; return true; }
+          case msgpack::uint32: { uint32_t value; if (!peekValue(1, value)) { return false; } out_magnitude = value; out_size = 5; return true; }
+          case msgpack::uint64: { uint64_t value; if (!peekValue(1, value)) { return false; } out_magnitude = value; out_size = 9; return true; }
+          case msgpack::int8: { uint8_t value; if (!peekValue(1, value)) { return false; } out_magnitude = static_cast<uint64_t>(static_cast<int64_t>(static_cast<int8_t>(value))); out_size = 2; break; }
+          case msgpack::int16: { uint16_t value; if (!peekValue(1, value)) { return false; } out_magnitude = static_cast<uint64_t>(static_cast<int64_t>(static_cast<int16_t>(value))); out_size = 3; break; }
+          case msgpack::int32: { uint32_t value; if (!peekValue(1, value)) { return false; } out_magnitude = static_cast<uint64_t>(static_cast<int64_t>(static_cast<int32_t>(value))); out_size = 5; break; }
+          case msgpack::int64: { uint64_t value; if (!peekValue(1, value)) { return false; } out_magnitude = value; out_size = 9; break; }
+          default: return false;
+        }
+
+        // Signed formats may carry non-negative values, which are then treated like unsigned ones.
+        out_isNegative = static_cast<int64_t>(out_magnitude) < 0;
+        return true;
+      }
+
+      bool peekFloatingPoint(double& out_value, size_t& out_size) const
+      {
+        if (m_cursor + 1 > tc_bufferSize) { return false; }
+
+        if (m_begin[m_cursor] == msgpack::float32)
+        {
+          uint32_t bits;
+          if (!peekValue(1, bits)) { return false; }
+          float value;
+          std::memcpy(&value, &bits, sizeof(value));
+          out_value = value;
+          out_size = 5;
+          return true;
+        }
+
+        if (m_begin[m_cursor] == msgpack::float64)
+        {
+          uint64_t bits;
+          if (!peekValue(1, bits)) { return false; }
+          std::memcpy(&out_value, &bits, sizeof(out_value));
+          out_size = 9;
+          return true;
+        }
+
+        // Many encoders write integral numbers as integers, even if the field is a floating point value.
+        uint64_t magnitude;
+        bool isNegative;
+        if (!peekInteger(magnitude, isNegative, out_size)) { return false; }
+        out_value = isNegative ? static_cast<double>(static_cast<int64_t>(magnitude)) : static_cast<double>(magnitude);
+        return true;
+      }
+
+      template<typename Type>
+      bool peekArithmetic(Type& out_value, size_t& out_size, std::true_type /* isFloatingPoint */) const
+      {
+        double value;
+        if (!peekFloatingPoint(value, out_size)) { return false; }
+        out_value = static_cast<Type>(value);
+        return true;
+      }
+
+      template<typename Type>
+      bool peekArithmetic(Type& out_value, size_t& out_size, std::false_type /* isFloatingPoint */) const
+      {
+        uint64_t magnitude;
+        bool isNegative;
+        if (!peekInteger(magnitude, isNegative, out_size)) { return false; }
+
+        if (isNegative)
+        {
+          const int64_t value = static_cast<int64_t>(magnitude);
+          if (!std::is_signed<Type>::value || value < static_cast<int64_t>(std::numeric_limits<Type>::min())) { return false; }
+          out_value = static_cast<Type>(value);
+          return true;
+        }
+
+        if (magnitude > static_cast<uint64_t>(std::numeric_limits<Type>::max())) { return false; }
+        out_value = static_cast<Type>(magnitude);
+        return true;
+      }
+
+      bool peekArithmetic(bool& out_value, size_t& out_size, std::false_type /* isFloatingPoint */) const
+      {
+        if (m_cursor + 1 > tc_bufferSize) { return false; }
+        if (m_begin[m_cursor] != msgpack::trueValue && m_begin[m_cursor] != msgpack::falseValue) { return false; }
+
+        out_value = m_begin[m_cursor] == msgpack::trueValue;
+        out_size = 1;
+        return true;
+      }
+
+      bool readHeader(uint32_t& out_size, uint8_t in_fixMarker, uint8_t in_fixMask, uint8_t in_marker8, uint8_t in_marker16, uint8_t in_marker32)
+      {
+        if (m_cursor + 1 > tc_bufferSize) { return false; }
+
+        const uint8_t marker = m_begin[m_cursor];
+        if ((marker & static_cast<uint8_t>(~in_fixMask)) == in_fixMarker && in_fixMask != 0) { out_size = marker & in_fixMask; m_cursor = m_cursor + 1; return true; }
+        if (marker == in_marker8 && in_marker8 != msgpack::nil) { uint8_t value; if (!peekValue(1, value)) { return false; } out_size = value; m_cursor = m_cursor + 2; return true; }
+        if (marker == in_marker16) { uint16_t value; if (!peekValue(1, value)) { return false; } out_size = value; m_cursor = m_cursor + 3; return true; }
+        if (marker == in_marker32) { uint32_t value; if (!peekValue(1, value)) { return false; } out_size = value; m_cursor = m_cursor + 5; return true; }
+        return false;
+      }
+
+      const uint8_t* viewBytes(uint32_t in_size)
+      {
+        if (in_size > tc_bufferSize - m_cursor) { return nullptr; }
+
+        const uint8_t* bytes = m_begin + m_cursor;
+        m_cursor = m_cursor + in_size;
+        return bytes;
+      }
+
+    public:
+      MessagePackDeserializer() = delete;
+      MessagePackDeserializer(const uint8_t* in_begin) : m_begin(in_begin)
+      {}
+      MessagePackDeserializer(const std::array<uint8_t, tc_bufferSize>& in_array) : m_begin(in_array.data())
+      {}
+
+      constexpr size_t getBufferSize() const
+      {
+        return tc_bufferSize;
+      }
+
+      size_t getBytesRead() const
+      {
+        return m_cursor;
+      }
+
+      size_t getBytesLeft() const
+      {
+        return tc_bufferSize - m_cursor;
+      }
+
+      const uint8_t* getBuffer() const
+      {
+        return m_begin;
+      }
+
+      bool isNil() const
+      {
+        return m_cursor + 1 <= tc_bufferSize && m_begin[m_cursor] == msgpack::nil;
+      }
+
+      // Returns std::numeric_limits<Type>::max() and does not advance, if the next value is missing,
+      // has an incompatible type or does not fit into Type.
+      template<typename Type>
+      Type read()
+      {
+        static_assert(std::is_arithmetic<Type>::value, "Type must be arithmetic!");
+        Type value;
+        size_t size;
+        if (!peekArithmetic(value, size, std::is_floating_point<Type>())) { return std::numeric_limits<Type>::max(); }
+
+        m_cursor = m_cursor + size;
+        return value;
+      }
+
+      template<typename Type>
+      bool skip()
+      {
+        static_assert(std::is_arithmetic<Type>::value, "Type must be arithmetic!");
+        Type value;
+        size_t size;
+        if (!peekArithmetic(value, size, std::is_floating_point<Type>())) { return false; }
+
+        m_cursor = m_cursor + size;
+        return true;
+      }
+
+      template<typename Type>
+      Type readEnum()
+      {
+        using UnderlyingType = typename std::underlying_type<Type>::type;
+        static_assert(std::is_enum<Type>::value && std::is_arithmetic<UnderlyingType>::value, "Type must be an enum and underlying type must be arithmetic!");
+        return Type{ read<UnderlyingType>() };
+      }
+
+      // Returns a view into the buffer, which is NOT null terminated, or nullptr if the next value is no string.
+      template<typename SizeType>
+      const char* view(SizeType& out_stringSize)
+      {
+        static_assert(isSizeType<SizeType>(), "SizeType must be an unsigned int!");
+        const size_t cursor = m_cursor;
+        uint32_t size;
+        if (!readHeader(size, msgpack::fixString, 0x1f, msgpack::string8, msgpack::string16, msgpack::string32)) { return nullptr; }
+        if (size > std::numeric_limits<SizeType>::max()) { m_cursor = cursor; return nullptr; }
+
+        const uint8_t* string = viewBytes(size);
+        if (string == nullptr) { m_cursor = cursor; return nullptr; }
+
+        out_stringSize = static_cast<SizeType>(size);
+        return reinterpret_cast<const char*>(string);
+      }
+
+      const uint8_t* viewBinary(size_t& out_size)
+      {
+        const size_t cursor = m_cursor;
+        uint32_t size;
+        if (!readHeader(size, 0, 0, msgpack::binary8, msgpack::binary16, msgpack::binary32)) { return nullptr; }
+
+        const uint8_t* binary = viewBytes(size);
+        if (binary == nullptr) { m_cursor = cursor; return nullptr; }
+
+        out_size = size;
+        return binary;
+      }
+
+      bool readNil()
+      {
+        if (!isNil()) { return false; }
+
+        m_cursor = m_cursor + 1;
+        return true;
+      }
+
+      bool readArrayHeader(uint32_t& out_elementCount)
+      {
+        return readHeader(out_elementCount, msgpack::fixArray, 0x0f, msgpack::nil, msgpack::array16, msgpack::array32);
+      }
+
+      bool readMapHeader(uint32_t& out_pairCount)
+      {
+        return readHeader(out_pairCount, msgpack::fixMap, 0x0f, msgpack::nil, msgpack::map16, msgpack::map32);
+      }
+  };
+}
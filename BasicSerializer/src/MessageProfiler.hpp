@@ -0,0 +1,403 @@
+#pragma once
+
+#include <type_traits>
+#include <limits>
+#include <array>
+#include <cmath>
+
+#include "BasicSerializer.hpp"
+#include "Protobuf.hpp"
+#include "Cbor.hpp"
+
+// **** **** **** ****
+// NOTE: ProfilingSerializer forwards every write to your Serializer and records the values per field in
+//       a MessageProfile. Fields are identified by their position in the message: the n-th write after
+//       constructing the ProfilingSerializer is field n (an array counts as one field).
+//       skip() reserves space to be filled in later (e.g. a length or checksum); it is not a field, its
+//       bytes are counted as padding (getPaddingBytes()), which no re-encoding saves.
+//       Feed it a representative capture and read getFieldProfile() to see what each field would cost as
+//       varint, narrowed (smallest fixed width that holds every value; for floating point values the
+//       smallest IEEE width that is exact), bit-packed (the widest value's bits) or entropy-coded
+//       (Shannon bound for enums and bools, bit width classes plus raw bits for integers and string sizes).
+//       Profiling is meant for captures on the host or in a diagnostic build; it is not a hot path.
+// **** **** **** ****
+
+namespace halvoe
+{
+  enum class FieldKind : uint8_t
+  {
+    none = 0,
+    boolean,
+    integer,
+    floatingPoint,
+    enumeration,
+    string,
+    array
+  };
+
+  struct FieldProfile
+  {
+    FieldKind kind = FieldKind::none;
+    uint32_t count = 0; // number of values (array elements count individually)
+    uint8_t maxBits = 0; // widest value (zigzag encoded for signed values, the size for strings)
+    uint64_t nativeBytes = 0;
+    uint64_t varintBytes = 0;
+    uint64_t narrowedBytes = 0;
+    uint64_t bitPackedBytes = 0;
+    uint64_t entropyCodedBytes = 0;
+  };
+
+  template<size_t tc_maxFieldCount = 32, size_t tc_maxSymbolCount = 16>
+  class MessageProfile
+  {
+    static constexpr size_t c_widthCount = 65;
+
+    private:
+      struct FieldStatistics
+      {
+        FieldKind kind = FieldKind::none;
+        uint32_t count = 0;
+        uint8_t maxBits = 0;
+        uint8_t maxNarrowedSize = 0;
+        bool isFloatingPoint = false;
+        uint64_t nativeBytes = 0;
+        uint64_t varintBytes = 0;
+        uint64_t payloadBytes = 0; // string contents, they are never re-encoded
+        std::array<uint32_t, c_widthCount> widthCounts{};
+        std::array<uint64_t, tc_maxSymbolCount> symbols{};
+        std::array<uint32_t, tc_maxSymbolCount> symbolCounts{};
+        uint8_t symbolCount = 0;
+        bool hasTooManySymbols = false;
+      };
+
+      std::array<FieldStatistics, tc_maxFieldCount> m_fields{};
+      uint32_t m_messageCount = 0;
+      uint32_t m_droppedFieldCount = 0;
+      uint64_t m_paddingBytes = 0;
+
+    private:
+      static uint8_t getBitWidth(uint64_t in_value)
+      {
+        return in_value == 0 ? 0 : static_cast<uint8_t>(64 - __builtin_clzll(in_value));
+      }
+
+      static uint8_t getNarrowedSize(uint8_t in_bitWidth)
+      {
+        return in_bitWidth <= 8 ? 1 : in_bitWidth <= 16 ? 2 : in_bitWidth <= 32 ? 4 : 8;
+      }
+
+      // Entropy of the bit width classes plus the raw bits below the leading one.
+      static double getWidthClassBits(const FieldStatistics& in_field)
+      {
+        double bits = 0;
+        for (size_t width = 0; width < c_widthCount; ++width)
+        {
+          const uint32_t count = in_field.widthCounts[width];
+          if (count == 0) { continue; }
+
+          bits = bits + count * std::log2(static_cast<double>(in_field.count) / count);
+          bits = bits + static_cast<double>(count) * (width > 1 ? width - 1 : 0);
+        }
+        return bits;
+      }
+
+      static double getSymbolBits(const FieldStatistics& in_field)
+      {
+        double bits = 0;
+        for (size_t index = 0; index < in_field.symbolCount; ++index)
+        {
+          const uint32_t count = in_field.symbolCounts[index];
+          bits = bits + count * std::log2(static_cast<double>(in_field.count) / count);
+        }
+        return bits;
+      }
+
+      static uint64_t toBytes(double in_bits)
+      {
+        return static_cast<uint64_t>(std::ceil(in_bits / 8));
+      }
+
+      static void recordWidth(FieldStatistics& io_field, uint64_t in_magnitude)
+      {
+        const uint8_t width = getBitWidth(in_magnitude);
+        io_field.widthCounts[width] = io_field.widthCounts[width] + 1;
+        if (width > io_field.maxBits) { io_field.maxBits = width; }
+      }
+
+      static void recordSymbol(FieldStatistics& io_field, uint64_t in_symbol)
+      {
+        for (size_t index = 0; index < io_field.symbolCount; ++index)
+        {
+          if (io_field.symbols[index] == in_symbol) { io_field.symbolCounts[index] = io_field.symbolCounts[index] + 1; return; }
+        }
+
+        if (io_field.symbolCount == tc_maxSymbolCount) { io_field.hasTooManySymbols = true; return; }
+        io_field.symbols[io_field.symbolCount] = in_symbol;
+        io_field.symbolCounts[io_field.symbolCount] = 1;
+        io_field.symbolCount = io_field.symbolCount + 1;
+      }
+
+      template<typename Type>
+      static uint64_t getMagnitude(Type in_value, std::true_type /* isSigned */)
+      {
+        return protobuf::encodeZigZag(static_cast<int64_t>(in_value));
+      }
+
+      template<typename Type>
+      static uint64_t getMagnitude(Type in_value, std::false_type /* isSigned */)
+      {
+        return static_cast<uint64_t>(in_value);
+      }
+
+      template<typename Type>
+      static uint8_t getNarrowedFloatSize(Type in_value)
+      {
+        uint16_t half;
+        if (std::isnan(in_value)) { return 2; }
+        if (static_cast<Type>(static_cast<float>(in_value)) != in_value) { return sizeof(Type); }
+        return cbor::toHalf(static_cast<float>(in_value), half) ? 2 : 4;
+      }
+
+      FieldStatistics* getField(size_t in_index, FieldKind in_kind)
+      {
+        if (in_index >= tc_maxFieldCount) { m_droppedFieldCount = m_droppedFieldCount + 1; return nullptr; }
+
+        FieldStatistics& field = m_fields[in_index];
+        if (field.kind == FieldKind::none) { field.kind = in_kind; }
+        return &field;
+      }
+
+      template<typename Type>
+      void recordValue(FieldStatistics& io_field, Type in_value, std::false_type /* isFloatingPoint */)
+      {
+        const uint64_t magnitude = getMagnitude(in_value, std::is_signed<Type>());
+        recordWidth(io_field, magnitude);
+        io_field.varintBytes = io_field.varintBytes + protobuf::getVarintSize(magnitude);
+
+        const uint8_t narrowedSize = getNarrowedSize(getBitWidth(magnitude));
+        if (narrowedSize > io_field.maxNarrowedSize) { io_field.maxNarrowedSize = narrowedSize; }
+        io_field.count = io_field.count + 1;
+      }
+
+      template<typename Type>
+      void recordValue(FieldStatistics& io_field, Type in_value, std::true_type /* isFloatingPoint */)
+      {
+        io_field.isFloatingPoint = true;
+        io_field.maxBits = sizeof(Type) * 8;
+        io_field.varintBytes = io_field.varintBytes + sizeof(Type);
+
+        const uint8_t narrowedSize = getNarrowedFloatSize(in_value);
+        if (narrowedSize > io_field.maxNarrowedSize) { io_field.maxNarrowedSize = narrowedSize; }
+        io_field.count = io_field.count + 1;
+      }
+
+    public:
+      void beginMessage()
+      {
+        m_messageCount = m_messageCount + 1;
+      }
+
+      uint32_t getMessageCount() const
+      {
+        return m_messageCount;
+      }
+
+      // Writes beyond tc_maxFieldCount fields per message are forwarded, but not profiled.
+      uint32_t getDroppedFieldCount() const
+      {
+        return m_droppedFieldCount;
+      }
+
+      // Bytes reserved by skip() over all messages.
+      uint64_t getPaddingBytes() const
+      {
+        return m_paddingBytes;
+      }
+
+      constexpr size_t getMaxFieldCount() const
+      {
+        return tc_maxFieldCount;
+      }
+
+      // Number of values of field in_index that were in_bits wide (for strings: the size).
+      uint32_t getBitWidthCount(size_t in_index, size_t in_bits) const
+      {
+        if (in_index >= tc_maxFieldCount || in_bits >= c_widthCount) { return 0; }
+        return m_fields[in_index].widthCounts[in_bits];
+      }
+
+      // The distinct values seen for the enum or bool field in_index, up to tc_maxSymbolCount.
+      size_t getSymbolCount(size_t in_index) const
+      {
+        if (in_index >= tc_maxFieldCount) { return 0; }
+        return m_fields[in_index].symbolCount;
+      }
+
+      bool getSymbol(size_t in_index, size_t in_symbolIndex, uint64_t& out_symbol, uint32_t& out_count) const
+      {
+        if (in_symbolIndex >= getSymbolCount(in_index)) { return false; }
+
+        out_symbol = m_fields[in_index].symbols[in_symbolIndex];
+        out_count = m_fields[in_index].symbolCounts[in_symbolIndex];
+        return true;
+      }
+
+      template<typename Type>
+      void record(size_t in_index, Type in_value, size_t in_nativeSize)
+      {
+        static_assert(std::is_arithmetic<Type>::value, "Type must be arithmetic!");
+        FieldStatistics* field = getField(in_index, std::is_same<Type, bool>::value ? FieldKind::boolean :
+                                                    std::is_floating_point<Type>::value ? FieldKind::floatingPoint : FieldKind::integer);
+        if (field == nullptr) { return; }
+
+        field->nativeBytes = field->nativeBytes + in_nativeSize;
+        if (std::is_same<Type, bool>::value) { recordSymbol(*field, static_cast<uint64_t>(in_value)); }
+        recordValue(*field, in_value, std::is_floating_point<Type>());
+      }
+
+      template<typename Type>
+      void recordEnum(size_t in_index, Type in_value, size_t in_nativeSize)
+      {
+        using UnderlyingType = typename std::underlying_type<Type>::type;
+        FieldStatistics* field = getField(in_index, FieldKind::enumeration);
+        if (field == nullptr) { return; }
+
+        const UnderlyingType value = static_cast<UnderlyingType>(in_value);
+        field->nativeBytes = field->nativeBytes + in_nativeSize;
+        recordSymbol(*field, getMagnitude(value, std::is_signed<UnderlyingType>()));
+        recordValue(*field, value, std::false_type());
+      }
+
+      void recordString(size_t in_index, size_t in_size, size_t in_nativeSize)
+      {
+        FieldStatistics* field = getField(in_index, FieldKind::string);
+        if (field == nullptr) { return; }
+
+        field->nativeBytes = field->nativeBytes + in_nativeSize;
+        field->payloadBytes = field->payloadBytes + in_size;
+        recordValue(*field, static_cast<uint64_t>(in_size), std::false_type());
+      }
+
+      template<typename Type>
+      void recordArray(size_t in_index, const Type* in_values, size_t in_count, size_t in_nativeSize)
+      {
+        FieldStatistics* field = getField(in_index, FieldKind::array);
+        if (field == nullptr) { return; }
+
+        field->nativeBytes = field->nativeBytes + in_nativeSize;
+        for (size_t index = 0; index < in_count; ++index) { recordValue(*field, in_values[index], std::is_floating_point<Type>()); }
+      }
+
+      void recordPadding(size_t in_nativeSize)
+      {
+        m_paddingBytes = m_paddingBytes + in_nativeSize;
+      }
+
+      FieldProfile getFieldProfile(size_t in_index) const
+      {
+        FieldProfile profile;
+        if (in_index >= tc_maxFieldCount) { return profile; }
+
+        const FieldStatistics& field = m_fields[in_index];
+        const bool hasSymbols = (field.kind == FieldKind::enumeration || field.kind == FieldKind::boolean) && !field.hasTooManySymbols;
+        const uint8_t packedBits = field.kind == FieldKind::boolean ? 1 : field.maxBits;
+
+        profile.kind = field.kind;
+        profile.count = field.count;
+        profile.maxBits = field.maxBits;
+        profile.nativeBytes = field.nativeBytes;
+        profile.varintBytes = field.varintBytes + field.payloadBytes;
+        profile.narrowedBytes = static_cast<uint64_t>(field.count) * field.maxNarrowedSize + field.payloadBytes;
+        profile.bitPackedBytes = toBytes(static_cast<double>(field.count) * packedBits) + field.payloadBytes;
+        profile.entropyCodedBytes = field.isFloatingPoint ? profile.narrowedBytes :
+                                    (hasSymbols ? toBytes(getSymbolBits(field)) : toBytes(getWidthClassBits(field))) + field.payloadBytes;
+        return profile;
+      }
+
+      void reset()
+      {
+        m_fields = std::array<FieldStatistics, tc_maxFieldCount>{};
+        m_messageCount = 0;
+        m_droppedFieldCount = 0;
+        m_paddingBytes = 0;
+      }
+  };
+
+  // Mirrors the write API of Serializer, see MessageProfile.
+  template<size_t tc_bufferSize, typename CursorType = size_t, size_t tc_maxFieldCount = 32, size_t tc_maxSymbolCount = 16>
+  class ProfilingSerializer
+  {
+    private:
+      Serializer<tc_bufferSize, CursorType>& m_serializer;
+      MessageProfile<tc_maxFieldCount, tc_maxSymbolCount>& m_profile;
+      size_t m_fieldIndex = 0;
+
+    public:
+      ProfilingSerializer() = delete;
+      ProfilingSerializer(Serializer<tc_bufferSize, CursorType>& io_serializer, MessageProfile<tc_maxFieldCount, tc_maxSymbolCount>& io_profile) :
+        m_serializer(io_serializer), m_profile(io_profile)
+      {
+        m_profile.beginMessage();
+      }
+
+      size_t getBytesWritten() const
+      {
+        return m_serializer.getBytesWritten();
+      }
+
+      template<typename Type>
+      bool write(Type in_value)
+      {
+        const size_t cursor = m_serializer.getBytesWritten();
+        if (!m_serializer.template write<Type>(in_value)) { return false; }
+
+        m_profile.record(m_fieldIndex, in_value, m_serializer.getBytesWritten() - cursor);
+        m_fieldIndex = m_fieldIndex + 1;
+        return true;
+      }
+
+      template<typename Type>
+      bool writeEnum(Type in_value)
+      {
+        const size_t cursor = m_serializer.getBytesWritten();
+        if (!m_serializer.writeEnum(in_value)) { return false; }
+
+        m_profile.recordEnum(m_fieldIndex, in_value, m_serializer.getBytesWritten() - cursor);
+        m_fieldIndex = m_fieldIndex + 1;
+        return true;
+      }
+
+      template<typename SizeType>
+      bool write(const char* in_string, SizeType in_size)
+      {
+        const size_t cursor = m_serializer.getBytesWritten();
+        if (!m_serializer.write(in_string, in_size)) { return false; }
+
+        m_profile.recordString(m_fieldIndex, in_size, m_serializer.getBytesWritten() - cursor);
+        m_fieldIndex = m_fieldIndex + 1;
+        return true;
+      }
+
+      template<typename Type>
+      bool writeArray(const Type* in_values, size_t in_count)
+      {
+        const size_t cursor = m_serializer.getBytesWritten();
+        if (!m_serializer.writeArray(in_values, in_count)) { return false; }
+
+        m_profile.recordArray(m_fieldIndex, in_values, in_count, m_serializer.getBytesWritten() - cursor);
+        m_fieldIndex = m_fieldIndex + 1;
+        return true;
+      }
+
+      template<typename Type>
+      SerializerReference<Type> skip()
+      {
+        const size_t cursor = m_serializer.getBytesWritten();
+        SerializerReference<Type> element = m_serializer.template skip<Type>();
+        if (element.isNull()) { return element; }
+
+        m_profile.recordPadding(m_serializer.getBytesWritten() - cursor);
+        return element;
+      }
+  };
+}
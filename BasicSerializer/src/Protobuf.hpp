@@ -0,0 +1,530 @@
+#pragma once
+
+#include <type_traits>
+#include <limits>
+#include <array>
+#include <cstring>
+
+#include "BasicSerializer.hpp"
+#include "ByteOrder.hpp"
+
+// **** **** **** ****
+// NOTE: ProtobufSerializer and ProtobufDeserializer write and read the Protocol Buffers wire format
+//       (https://protobuf.dev/programming-guides/encoding/) over the same buffer model as Serializer.
+//       There is no schema: every write takes the field number, and reads are driven by readTag().
+//       write() uses the int32/int64/uint32/uint64/bool encoding, writeSigned() the zigzag sint32/sint64
+//       encoding and writeFixed() the fixed32/fixed64/sfixed32/sfixed64/float/double encoding.
+//       Nested messages are serialized into their own buffer and written with writeBytes().
+// **** **** **** ****
+
+namespace halvoe
+{
+  enum class ProtobufWireType : uint8_t
+  {
+    varint = 0,
+    fixed64 = 1,
+    lengthDelimited = 2,
+    fixed32 = 5
+  };
+
+  namespace protobuf
+  {
+    static constexpr size_t c_maxVarintSize = 10;
+
+    inline constexpr size_t getVarintSize(uint64_t in_value)
+    {
+      return in_value < (uint64_t{ 1 } << 7) ? 1 :
+             in_value < (uint64_t{ 1 } << 14) ? 2 :
+             in_value < (uint64_t{ 1 } << 21) ? 3 :
+             in_value < (uint64_t{ 1 } << 28) ? 4 :
+             in_value < (uint64_t{ 1 } << 35) ? 5 :
+             in_value < (uint64_t{ 1 } << 42) ? 6 :
+             in_value < (uint64_t{ 1 } << 49) ? 7 :
+             in_value < (uint64_t{ 1 } << 56) ? 8 :
+             in_value < (uint64_t{ 1 } << 63) ? 9 : 10;
+    }
+
+    inline constexpr uint64_t encodeZigZag(int64_t in_value)
+    {
+      return (static_cast<uint64_t>(in_value) << 1) ^ static_cast<uint64_t>(in_value >> 63);
+    }
+
+    inline constexpr int64_t decodeZigZag(uint64_t in_value)
+    {
+      return static_cast<int64_t>(in_value >> 1) ^ -static_cast<int64_t>(in_value & 1);
+    }
+
+    template<typename Type>
+    constexpr uint64_t toVarint(Type in_value)
+    {
+      // Negative int32 and int64 values are sign extended to 64 bits, as protoc does.
+      return std::is_signed<Type>::value ? static_cast<uint64_t>(static_cast<int64_t>(in_value)) : static_cast<uint64_t>(in_value);
+    }
+
+    template<typename Type>
+    constexpr bool isFixedType()
+    {
+      return (sizeof(Type) == 4 || sizeof(Type) == 8) && std::is_arithmetic<Type>::value && !std::is_same<Type, bool>::value;
+    }
+
+    template<typename Type>
+    using FixedBitsType = typename std::conditional<sizeof(Type) == 4, uint32_t, uint64_t>::type;
+  }
+
+  template<size_t tc_bufferSize>
+  class ProtobufSerializer
+  {
+    private:
+      uint8_t* m_begin;
+      size_t m_cursor = 0;
+
+    private:
+      // The caller has checked that the varint fits into the buffer.
+      void putVarint(uint64_t in_value)
+      {
+        while (in_value >= 0x80)
+        {
+          m_begin[m_cursor] = static_cast<uint8_t>(in_value | 0x80);
+          m_cursor = m_cursor + 1;
+          in_value = in_value >> 7;
+        }
+
+        m_begin[m_cursor] = static_cast<uint8_t>(in_value);
+        m_cursor = m_cursor + 1;
+      }
+
+      template<typename Type>
+      void putFixed(Type in_value)
+      {
+        using BitsType = protobuf::FixedBitsType<Type>;
+        BitsType bits;
+        std::memcpy(&bits, &in_value, sizeof(bits));
+        storeLittleEndian<BitsType>(m_begin + m_cursor, bits);
+        m_cursor = m_cursor + sizeof(bits);
+      }
+
+      static constexpr uint64_t makeTag(uint32_t in_fieldNumber, ProtobufWireType in_wireType)
+      {
+        return (static_cast<uint64_t>(in_fieldNumber) << 3) | static_cast<uint8_t>(in_wireType);
+      }
+
+      bool writeVarintField(uint32_t in_fieldNumber, uint64_t in_value)
+      {
+        const uint64_t tag = makeTag(in_fieldNumber, ProtobufWireType::varint);
+        if (m_cursor + protobuf::getVarintSize(tag) + protobuf::getVarintSize(in_value) > tc_bufferSize) { return false; }
+
+        putVarint(tag);
+        putVarint(in_value);
+        return true;
+      }
+
+      bool writeLengthDelimitedField(uint32_t in_fieldNumber, const void* in_data, size_t in_size)
+      {
+        const uint64_t tag = makeTag(in_fieldNumber, ProtobufWireType::lengthDelimited);
+        if (in_size > tc_bufferSize) { return false; }
+        if (m_cursor + protobuf::getVarintSize(tag) + protobuf::getVarintSize(in_size) + in_size > tc_bufferSize) { return false; }
+
+        putVarint(tag);
+        putVarint(in_size);
+        if (in_size > 0) { std::memcpy(m_begin + m_cursor, in_data, in_size); }
+        m_cursor = m_cursor + in_size;
+        return true;
+      }
+
+      template<typename Type, typename EncodeFunction>
+      bool writePackedVarints(uint32_t in_fieldNumber, const Type* in_values, size_t in_count, EncodeFunction in_encode)
+      {
+        size_t size = 0;
+        for (size_t index = 0; index < in_count; ++index)
+        {
+          size = size + protobuf::getVarintSize(in_encode(in_values[index]));
+        }
+
+        const uint64_t tag = makeTag(in_fieldNumber, ProtobufWireType::lengthDelimited);
+        if (size > tc_bufferSize) { return false; }
+        if (m_cursor + protobuf::getVarintSize(tag) + protobuf::getVarintSize(size) + size > tc_bufferSize) { return false; }
+
+        putVarint(tag);
+        putVarint(size);
+        for (size_t index = 0; index < in_count; ++index)
+        {
+          putVarint(in_encode(in_values[index]));
+        }
+        return true;
+      }
+
+    public:
+      ProtobufSerializer() = delete;
+      ProtobufSerializer(uint8_t* out_begin) : m_begin(out_begin)
+      {}
+      ProtobufSerializer(std::array<uint8_t, tc_bufferSize>& out_array) : m_begin(out_array.data())
+      {}
+
+      constexpr size_t getBufferSize() const
+      {
+        return tc_bufferSize;
+      }
+
+      size_t getBytesWritten() const
+      {
+        return m_cursor;
+      }
+
+      size_t getBytesLeft() const
+      {
+        return tc_bufferSize - m_cursor;
+      }
+
+      uint8_t* getBuffer()
+      {
+        return m_begin;
+      }
+
+      const uint8_t* getBuffer() const
+      {
+        return m_begin;
+      }
+
+      bool fitsInBuffer(size_t in_size) const
+      {
+        return in_size <= tc_bufferSize - m_cursor;
+      }
+
+      template<typename Type>
+      bool write(uint32_t in_fieldNumber, Type in_value)
+      {
+        static_assert(std::is_integral<Type>::value, "Type must be integral, use writeFixed() for floating point values!");
+        return writeVarintField(in_fieldNumber, protobuf::toVarint(in_value));
+      }
+
+      template<typename Type>
+      bool writeSigned(uint32_t in_fieldNumber, Type in_value)
+      {
+        static_assert(std::is_integral<Type>::value && std::is_signed<Type>::value, "Type must be a signed int!");
+        return writeVarintField(in_fieldNumber, protobuf::encodeZigZag(in_value));
+      }
+
+      template<typename Type>
+      bool writeFixed(uint32_t in_fieldNumber, Type in_value)
+      {
+        static_assert(protobuf::isFixedType<Type>(), "Type must be a 32 or 64 bit arithmetic type!");
+        const ProtobufWireType wireType = sizeof(Type) == 4 ? ProtobufWireType::fixed32 : ProtobufWireType::fixed64;
+        const uint64_t tag = makeTag(in_fieldNumber, wireType);
+        if (m_cursor + protobuf::getVarintSize(tag) + sizeof(Type) > tc_bufferSize) { return false; }
+
+        putVarint(tag);
+        putFixed(in_value);
+        return true;
+      }
+
+      template<typename Type>
+      bool writeEnum(uint32_t in_fieldNumber, Type in_value)
+      {
+        using UnderlyingType = typename std::underlying_type<Type>::type;
+        static_assert(std::is_enum<Type>::value && std::is_arithmetic<UnderlyingType>::value, "Type must be an enum and underlying type must be arithmetic!");
+        return writeVarintField(in_fieldNumber, protobuf::toVarint(static_cast<UnderlyingType>(in_value)));
+      }
+
+      template<typename SizeType>
+      bool write(uint32_t in_fieldNumber, const char* in_string, SizeType in_size)
+      {
+        static_assert(isSizeType<SizeType>(), "SizeType must be an unsigned int!");
+        return writeLengthDelimitedField(in_fieldNumber, in_string, in_size);
+      }
+
+      bool writeBytes(uint32_t in_fieldNumber, const uint8_t* in_data, size_t in_size)
+      {
+        return writeLengthDelimitedField(in_fieldNumber, in_data, in_size);
+      }
+
+      // Packed repeated fields. Fixed width values go through a single copy on little endian targets.
+      template<typename Type>
+      bool writePacked(uint32_t in_fieldNumber, const Type* in_values, size_t in_count)
+      {
+        static_assert(std::is_integral<Type>::value, "Type must be integral, use writePackedFixed() for floating point values!");
+        return writePackedVarints(in_fieldNumber, in_values, in_count, [](Type in_value) { return protobuf::toVarint(in_value); });
+      }
+
+      template<typename Type>
+      bool writePackedSigned(uint32_t in_fieldNumber, const Type* in_values, size_t in_count)
+      {
+        static_assert(std::is_integral<Type>::value && std::is_signed<Type>::value, "Type must be a signed int!");
+        return writePackedVarints(in_fieldNumber, in_values, in_count, [](Type in_value) { return protobuf::encodeZigZag(in_value); });
+      }
+
+      template<typename Type>
+      bool writePackedFixed(uint32_t in_fieldNumber, const Type* in_values, size_t in_count)
+      {
+        static_assert(protobuf::isFixedType<Type>(), "Type must be a 32 or 64 bit arithmetic type!");
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+        if (in_count > tc_bufferSize / sizeof(Type)) { return false; }
+        return writeLengthDelimitedField(in_fieldNumber, in_values, in_count * sizeof(Type));
+#else
+        const uint64_t tag = makeTag(in_fieldNumber, ProtobufWireType::lengthDelimited);
+        if (in_count > tc_bufferSize / sizeof(Type)) { return false; }
+        const size_t size = in_count * sizeof(Type);
+        if (m_cursor + protobuf::getVarintSize(tag) + protobuf::getVarintSize(size) + size > tc_bufferSize) { return false; }
+
+        putVarint(tag);
+        putVarint(size);
+        for (size_t index = 0; index < in_count; ++index)
+        {
+          putFixed(in_values[index]);
+        }
+        return true;
+#endif
+      }
+  };
+
+  template<size_t tc_bufferSize>
+  class ProtobufDeserializer
+  {
+    private:
+      const uint8_t* m_begin;
+      size_t m_cursor = 0;
+
+    private:
+      // Returns the size of the varint at in_offset, 0 if it is incomplete or longer than ten bytes.
+      size_t peekVarint(size_t in_offset, uint64_t& out_value) const
+      {
+        uint64_t value = 0;
+
+        for (size_t index = 0; index < protobuf::c_maxVarintSize; ++index)
+        {
+          if (in_offset + index + 1 > tc_bufferSize) { return 0; }
+
+          const uint8_t byte = m_begin[in_offset + index];
+          value = value | (static_cast<uint64_t>(byte & 0x7f) << (7 * index));
+          if ((byte & 0x80) == 0)
+          {
+            out_value = value;
+            return index + 1;
+          }
+        }
+
+        return 0;
+      }
+
+      bool readVarint(uint64_t& out_value)
+      {
+        const size_t size = peekVarint(m_cursor, out_value);
+        if (size == 0) { return false; }
+
+        m_cursor = m_cursor + size;
+        return true;
+      }
+
+      template<typename Type>
+      Type getFixed(size_t in_offset) const
+      {
+        using BitsType = protobuf::FixedBitsType<Type>;
+        const BitsType bits = loadLittleEndian<BitsType>(m_begin + in_offset);
+        Type value;
+        std::memcpy(&value, &bits, sizeof(value));
+        return value;
+      }
+
+      const uint8_t* viewLengthDelimited(size_t& out_size)
+      {
+        uint64_t size;
+        const size_t headerSize = peekVarint(m_cursor, size);
+        if (headerSize == 0 || size > tc_bufferSize || m_cursor + headerSize + size > tc_bufferSize) { return nullptr; }
+
+        const uint8_t* data = m_begin + m_cursor + headerSize;
+        m_cursor = m_cursor + headerSize + static_cast<size_t>(size);
+        out_size = static_cast<size_t>(size);
+        return data;
+      }
+
+      template<typename Type, typename DecodeFunction>
+      bool readPackedVarints(Type* out_values, size_t in_maxCount, size_t& out_count, DecodeFunction in_decode)
+      {
+        const size_t cursor = m_cursor;
+        size_t size;
+        const uint8_t* data = viewLengthDelimited(size);
+        if (data == nullptr) { return false; }
+
+        const size_t end = static_cast<size_t>(data - m_begin) + size;
+        size_t offset = static_cast<size_t>(data - m_begin);
+        size_t count = 0;
+
+        while (offset < end)
+        {
+          uint64_t value;
+          const size_t valueSize = peekVarint(offset, value);
+          if (valueSize == 0 || offset + valueSize > end || count == in_maxCount) { m_cursor = cursor; return false; }
+
+          out_values[count] = in_decode(value);
+          offset = offset + valueSize;
+          count = count + 1;
+        }
+
+        out_count = count;
+        return true;
+      }
+
+    public:
+      ProtobufDeserializer() = delete;
+      ProtobufDeserializer(const uint8_t* in_begin) : m_begin(in_begin)
+      {}
+      ProtobufDeserializer(const std::array<uint8_t, tc_bufferSize>& in_array) : m_begin(in_array.data())
+      {}
+
+      constexpr size_t getBufferSize() const
+      {
+        return tc_bufferSize;
+      }
+
+      size_t getBytesRead() const
+      {
+        return m_cursor;
+      }
+
+      size_t getBytesLeft() const
+      {
+        return tc_bufferSize - m_cursor;
+      }
+
+      const uint8_t* getBuffer() const
+      {
+        return m_begin;
+      }
+
+      // Reads the key of the next field. The value has to be read with the function matching out_wireType or skipped with skip().
+      bool readTag(uint32_t& out_fieldNumber, ProtobufWireType& out_wireType)
+      {
+        uint64_t tag;
+        const size_t size = peekVarint(m_cursor, tag);
+        if (size == 0 || (tag >> 3) == 0 || (tag >> 3) > std::numeric_limits<uint32_t>::max()) { return false; }
+
+        const uint8_t wireType = tag & 0x07;
+        if (wireType != 0 && wireType != 1 && wireType != 2 && wireType != 5) { return false; }
+
+        m_cursor = m_cursor + size;
+        out_fieldNumber = static_cast<uint32_t>(tag >> 3);
+        out_wireType = static_cast<ProtobufWireType>(wireType);
+        return true;
+      }
+
+      bool skip(ProtobufWireType in_wireType)
+      {
+        uint64_t value;
+        size_t size;
+
+        switch (in_wireType)
+        {
+          case ProtobufWireType::varint: return readVarint(value);
+          case ProtobufWireType::lengthDelimited: return viewLengthDelimited(size) != nullptr;
+          case ProtobufWireType::fixed32: size = 4; break;
+          case ProtobufWireType::fixed64: size = 8; break;
+          default: return false;
+        }
+
+        if (m_cursor + size > tc_bufferSize) { return false; }
+
+        m_cursor = m_cursor + size;
+        return true;
+      }
+
+      template<typename Type>
+      Type read()
+      {
+        static_assert(std::is_integral<Type>::value, "Type must be integral, use readFixed() for floating point values!");
+        uint64_t value;
+        if (!readVarint(value)) { return std::numeric_limits<Type>::max(); }
+
+        return std::is_same<Type, bool>::value ? static_cast<Type>(value != 0) : static_cast<Type>(value);
+      }
+
+      template<typename Type>
+      Type readSigned()
+      {
+        static_assert(std::is_integral<Type>::value && std::is_signed<Type>::value, "Type must be a signed int!");
+        uint64_t value;
+        if (!readVarint(value)) { return std::numeric_limits<Type>::max(); }
+
+        return static_cast<Type>(protobuf::decodeZigZag(value));
+      }
+
+      template<typename Type>
+      Type readFixed()
+      {
+        static_assert(protobuf::isFixedType<Type>(), "Type must be a 32 or 64 bit arithmetic type!");
+        if (m_cursor + sizeof(Type) > tc_bufferSize) { return std::numeric_limits<Type>::max(); }
+
+        const Type value = getFixed<Type>(m_cursor);
+        m_cursor = m_cursor + sizeof(Type);
+        return value;
+      }
+
+      template<typename Type>
+      Type readEnum()
+      {
+        using UnderlyingType = typename std::underlying_type<Type>::type;
+        static_assert(std::is_enum<Type>::value && std::is_arithmetic<UnderlyingType>::value, "Type must be an enum and underlying type must be arithmetic!");
+        return Type{ read<UnderlyingType>() };
+      }
+
+      // Returns a view into the buffer, which is NOT null terminated.
+      template<typename SizeType>
+      const char* view(SizeType& out_stringSize)
+      {
+        static_assert(isSizeType<SizeType>(), "SizeType must be an unsigned int!");
+        const size_t cursor = m_cursor;
+        size_t size;
+        const uint8_t* string = viewLengthDelimited(size);
+        if (string == nullptr) { return nullptr; }
+        if (size > std::numeric_limits<SizeType>::max()) { m_cursor = cursor; return nullptr; }
+
+        out_stringSize = static_cast<SizeType>(size);
+        return reinterpret_cast<const char*>(string);
+      }
+
+      // Also used for embedded messages, which can be read with a nested ProtobufDeserializer.
+      const uint8_t* viewBytes(size_t& out_size)
+      {
+        return viewLengthDelimited(out_size);
+      }
+
+      // Packed repeated fields. out_count is the number of values read, which is 0 for an empty field.
+      // Fails without advancing, if the field is malformed or holds more than in_maxCount values.
+      template<typename Type>
+      bool readPacked(Type* out_values, size_t in_maxCount, size_t& out_count)
+      {
+        static_assert(std::is_integral<Type>::value, "Type must be integral, use readPackedFixed() for floating point values!");
+        return readPackedVarints(out_values, in_maxCount, out_count, [](uint64_t in_value) { return static_cast<Type>(in_value); });
+      }
+
+      template<typename Type>
+      bool readPackedSigned(Type* out_values, size_t in_maxCount, size_t& out_count)
+      {
+        static_assert(std::is_integral<Type>::value && std::is_signed<Type>::value, "Type must be a signed int!");
+        return readPackedVarints(out_values, in_maxCount, out_count, [](uint64_t in_value) { return static_cast<Type>(protobuf::decodeZigZag(in_value)); });
+      }
+
+      template<typename Type>
+      bool readPackedFixed(Type* out_values, size_t in_maxCount, size_t& out_count)
+      {
+        static_assert(protobuf::isFixedType<Type>(), "Type must be a 32 or 64 bit arithmetic type!");
+        const size_t cursor = m_cursor;
+        size_t size;
+        const uint8_t* data = viewLengthDelimited(size);
+        if (data == nullptr) { return false; }
+
+        const size_t count = size / sizeof(Type);
+        if (size % sizeof(Type) != 0 || count > in_maxCount) { m_cursor = cursor; return false; }
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+        if (size > 0) { std::memcpy(out_values, data, size); }
+#else
+        const size_t offset = static_cast<size_t>(data - m_begin);
+        for (size_t index = 0; index < count; ++index)
+        {
+          out_values[index] = getFixed<Type>(offset + index * sizeof(Type));
+        }
+#endif
+        out_count = count;
+        return true;
+      }
+  };
+}
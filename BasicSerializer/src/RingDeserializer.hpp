@@ -0,0 +1,150 @@
+#pragma once
+
+#include <array>
+
+#include "SegmentedBuffer.hpp"
+
+// **** **** **** ****
+// NOTE: RingDeserializer reads the native format directly from a circular buffer, e.g. a UART RX ring,
+//       so a frame that wraps around the end does not have to be linearised first.
+//       The ring is given as in Arduino's HardwareSerial: in_head is the index the producer writes to next,
+//       in_tail the index of the first unread byte, so (in_head - in_tail) mod in_capacity bytes are readable.
+//       The unread bytes are at most two spans, which are read like the segments of a SegmentedDeserializer.
+//       view() returns a string as one or two spans without copying it. After parsing, store getTail()
+//       as the new read index to release the consumed bytes to the producer.
+//       Invalid rings (in_capacity 0, in_head or in_tail not below in_capacity) read as empty; getTail() is 0.
+//       The ring contents must not change while a RingDeserializer is reading from it!
+// **** **** **** ****
+
+namespace halvoe
+{
+  class RingDeserializer
+  {
+    private:
+      size_t m_capacity;
+      size_t m_tail;
+      std::array<BufferSegment, 2> m_spans;
+      SegmentedDeserializer m_deserializer;
+
+    private:
+      static bool isValid(size_t in_capacity, size_t in_head, size_t in_tail)
+      {
+        return in_head < in_capacity && in_tail < in_capacity;
+      }
+
+      static std::array<BufferSegment, 2> getSpans(const uint8_t* in_base, size_t in_capacity, size_t in_head, size_t in_tail)
+      {
+        std::array<BufferSegment, 2> spans;
+        if (!isValid(in_capacity, in_head, in_tail)) { return spans; }
+
+        if (in_head >= in_tail)
+        {
+          spans[0].data = in_base + in_tail;
+          spans[0].size = in_head - in_tail;
+        }
+        else
+        {
+          spans[0].data = in_base + in_tail;
+          spans[0].size = in_capacity - in_tail;
+          spans[1].data = in_base;
+          spans[1].size = in_head;
+        }
+
+        return spans;
+      }
+
+    public:
+      RingDeserializer() = delete;
+      RingDeserializer(const uint8_t* in_base, size_t in_capacity, size_t in_head, size_t in_tail) :
+        m_capacity(isValid(in_capacity, in_head, in_tail) ? in_capacity : 0), m_tail(isValid(in_capacity, in_head, in_tail) ? in_tail : 0),
+        m_spans(getSpans(in_base, in_capacity, in_head, in_tail)), m_deserializer(m_spans.data(), m_spans.size())
+      {}
+
+      RingDeserializer(const RingDeserializer&) = delete;
+      RingDeserializer& operator=(const RingDeserializer&) = delete;
+
+      // The read index behind the bytes read so far.
+      size_t getTail() const
+      {
+        if (m_capacity == 0) { return 0; }
+        return (m_tail + m_deserializer.getBytesRead()) % m_capacity;
+      }
+
+      size_t getBytesRead() const
+      {
+        return m_deserializer.getBytesRead();
+      }
+
+      size_t getBytesLeft() const
+      {
+        return m_deserializer.getBytesLeft();
+      }
+
+#if defined(HALVOE_SERIALIZER_TYPE_TAGS)
+      bool hasTypeTagMismatch() const
+      {
+        return m_deserializer.hasTypeTagMismatch();
+      }
+
+      const TypeTagMismatch& getTypeTagMismatch() const
+      {
+        return m_deserializer.getTypeTagMismatch();
+      }
+#endif
+
+      bool fitsInBuffer(size_t in_size) const
+      {
+        return m_deserializer.fitsInBuffer(in_size);
+      }
+
+      template<typename Type>
+      bool fitsInBuffer() const
+      {
+        return m_deserializer.fitsInBuffer<Type>();
+      }
+
+      template<typename Type>
+      bool skip()
+      {
+        return m_deserializer.skip<Type>();
+      }
+
+      template<typename Type>
+      Type read()
+      {
+        return m_deserializer.read<Type>();
+      }
+
+      template<typename Type>
+      Type readEnum()
+      {
+        return m_deserializer.readEnum<Type>();
+      }
+
+      // Returns a string as out_first and, if it wraps around the end of the ring, out_second
+      // (otherwise out_second is empty). Fails without consuming anything.
+      template<typename SizeType>
+      bool view(BufferSegment& out_first, BufferSegment& out_second, SizeType& out_stringSize)
+      {
+        BufferSegment spans[2];
+        size_t spanCount;
+        if (!m_deserializer.view(spans, 2, spanCount, out_stringSize)) { return false; }
+
+        out_first = spanCount > 0 ? spans[0] : BufferSegment();
+        out_second = spanCount > 1 ? spans[1] : BufferSegment();
+        return true;
+      }
+
+      template<typename SizeType>
+      bool read(char* out_string, size_t in_capacity, SizeType& out_stringSize)
+      {
+        return m_deserializer.read(out_string, in_capacity, out_stringSize);
+      }
+
+      template<typename Type>
+      bool readArray(Type* out_values, size_t in_count)
+      {
+        return m_deserializer.readArray(out_values, in_count);
+      }
+  };
+}
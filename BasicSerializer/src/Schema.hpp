@@ -0,0 +1,231 @@
+#pragma once
+
+#include <type_traits>
+#include <utility>
+#include <tuple>
+#include <array>
+
+#include "BasicSerializer.hpp"
+
+// **** **** **** ****
+// NOTE: A Schema maps the members of a message struct to the native format and makes it evolvable.
+//       Each SchemaField names the schema version that introduced it; new fields go to the end.
+//       The defaults are the default member initializers of the message, so MessageType has to be a
+//       literal type (constexpr default constructible).
+//
+//       Wire format: uint8_t field count, uint16_t byte size of the fields, then the fields in schema order.
+//       A sender omits trailing fields that equal their default, a receiver fills missing trailing fields
+//       with their default. Both select the code for the field count with a single table lookup, so there
+//       is no branch per field, and the receiver checks the buffer size once.
+//       A receiver on an older version reads the fields it knows and skips the rest by the byte size, as
+//       their types are unknown to it (the plain format has no type tags to derive sizes from).
+// **** **** **** ****
+
+namespace halvoe
+{
+  template<typename MessageType, typename MemberType, MemberType MessageType::* tc_member, uint8_t tc_sinceVersion>
+  struct SchemaField
+  {
+    static_assert(std::is_arithmetic<MemberType>::value || std::is_enum<MemberType>::value, "MemberType must be arithmetic or an enum!");
+
+    static constexpr uint8_t c_sinceVersion = tc_sinceVersion;
+    static constexpr size_t c_size = c_typeTagSize + sizeof(MemberType);
+
+    static bool isDefault(const MessageType& in_message, const MessageType& in_defaults)
+    {
+      return in_message.*tc_member == in_defaults.*tc_member;
+    }
+
+    template<typename SerializerType>
+    static bool write(SerializerType& out_serializer, const MessageType& in_message)
+    {
+      return writeMember(out_serializer, in_message.*tc_member, std::is_enum<MemberType>());
+    }
+
+    // Fails on a type tag mismatch, which read() only reports as a max() placeholder.
+    template<typename DeserializerType>
+    static bool read(DeserializerType& io_deserializer, MessageType& out_message)
+    {
+      const MemberType value = readMember(io_deserializer, std::is_enum<MemberType>());
+#if defined(HALVOE_SERIALIZER_TYPE_TAGS)
+      if (io_deserializer.hasTypeTagMismatch()) { return false; }
+#endif
+      out_message.*tc_member = value;
+      return true;
+    }
+
+    template<typename SerializerType>
+    static bool writeMember(SerializerType& out_serializer, MemberType in_value, std::true_type /* isEnum */)
+    {
+      return out_serializer.writeEnum(in_value);
+    }
+
+    template<typename SerializerType>
+    static bool writeMember(SerializerType& out_serializer, MemberType in_value, std::false_type /* isEnum */)
+    {
+      return out_serializer.template write<MemberType>(in_value);
+    }
+
+    template<typename DeserializerType>
+    static MemberType readMember(DeserializerType& io_deserializer, std::true_type /* isEnum */)
+    {
+      return io_deserializer.template readEnum<MemberType>();
+    }
+
+    template<typename DeserializerType>
+    static MemberType readMember(DeserializerType& io_deserializer, std::false_type /* isEnum */)
+    {
+      return io_deserializer.template read<MemberType>();
+    }
+  };
+
+  template<typename MessageType, typename... Fields>
+  class Schema
+  {
+    static_assert(sizeof...(Fields) > 0 && sizeof...(Fields) < 256, "Schema needs between 1 and 255 fields!");
+
+    private:
+      using FieldTuple = std::tuple<Fields...>;
+
+      template<size_t tc_index>
+      using Field = typename std::tuple_element<tc_index, FieldTuple>::type;
+
+      template<size_t tc_bufferSize, typename CursorType>
+      using ReadFunction = bool (*)(Deserializer<tc_bufferSize, CursorType>&, MessageType&);
+
+      template<size_t tc_bufferSize, typename CursorType>
+      using WriteFunction = bool (*)(Serializer<tc_bufferSize, CursorType>&, const MessageType&);
+
+      static constexpr size_t c_fieldCount = sizeof...(Fields);
+      static constexpr std::array<uint8_t, c_fieldCount> c_versions = {{ Fields::c_sinceVersion... }};
+
+      static constexpr bool hasOrderedVersions()
+      {
+        for (size_t index = 1; index < c_fieldCount; ++index)
+        {
+          if (c_versions[index] < c_versions[index - 1]) { return false; }
+        }
+        return true;
+      }
+
+      static_assert(hasOrderedVersions(), "Fields must be ordered by the version that introduced them!");
+
+      // c_prefixSizes[n] is the wire size of the first n fields.
+      static constexpr std::array<size_t, c_fieldCount + 1> makePrefixSizes()
+      {
+        constexpr std::array<size_t, c_fieldCount> sizes = {{ Fields::c_size... }};
+        std::array<size_t, c_fieldCount + 1> prefixSizes{};
+        for (size_t index = 0; index < c_fieldCount; ++index)
+        {
+          prefixSizes[index + 1] = prefixSizes[index] + sizes[index];
+        }
+        return prefixSizes;
+      }
+
+      static constexpr std::array<size_t, c_fieldCount + 1> c_prefixSizes = makePrefixSizes();
+
+      static constexpr MessageType c_defaults{};
+
+      template<size_t tc_bufferSize, typename CursorType, size_t... tc_indices>
+      static bool readFields(Deserializer<tc_bufferSize, CursorType>& io_deserializer, MessageType& out_message, std::index_sequence<tc_indices...>)
+      {
+        (void)io_deserializer;
+        (void)out_message;
+        return (Field<tc_indices>::read(io_deserializer, out_message) && ...);
+      }
+
+      template<size_t tc_bufferSize, typename CursorType, size_t tc_count>
+      static bool readFirstFields(Deserializer<tc_bufferSize, CursorType>& io_deserializer, MessageType& out_message)
+      {
+        return readFields(io_deserializer, out_message, std::make_index_sequence<tc_count>());
+      }
+
+      template<size_t tc_bufferSize, typename CursorType, size_t... tc_counts>
+      static constexpr std::array<ReadFunction<tc_bufferSize, CursorType>, c_fieldCount + 1> makeReadTable(std::index_sequence<tc_counts...>)
+      {
+        return {{ &readFirstFields<tc_bufferSize, CursorType, tc_counts>... }};
+      }
+
+      template<size_t tc_bufferSize, typename CursorType, size_t... tc_indices>
+      static bool writeFields(Serializer<tc_bufferSize, CursorType>& out_serializer, const MessageType& in_message, std::index_sequence<tc_indices...>)
+      {
+        (void)out_serializer;
+        (void)in_message;
+        return (Field<tc_indices>::write(out_serializer, in_message) && ...);
+      }
+
+      template<size_t tc_bufferSize, typename CursorType, size_t tc_count>
+      static bool writeFirstFields(Serializer<tc_bufferSize, CursorType>& out_serializer, const MessageType& in_message)
+      {
+        return writeFields(out_serializer, in_message, std::make_index_sequence<tc_count>());
+      }
+
+      template<size_t tc_bufferSize, typename CursorType, size_t... tc_counts>
+      static constexpr std::array<WriteFunction<tc_bufferSize, CursorType>, c_fieldCount + 1> makeWriteTable(std::index_sequence<tc_counts...>)
+      {
+        return {{ &writeFirstFields<tc_bufferSize, CursorType, tc_counts>... }};
+      }
+
+      template<size_t... tc_indices>
+      static size_t getLastNonDefaultCount(const MessageType& in_message, size_t in_maxCount, std::index_sequence<tc_indices...>)
+      {
+        size_t count = 0;
+        ((count = tc_indices < in_maxCount && !Field<tc_indices>::isDefault(in_message, c_defaults) ? tc_indices + 1 : count), ...);
+        return count;
+      }
+
+    public:
+      static constexpr uint8_t c_version = c_versions[c_fieldCount - 1];
+
+      static constexpr size_t getFieldCount()
+      {
+        return c_fieldCount;
+      }
+
+      // Number of fields a peer on schema version in_version knows about.
+      static constexpr size_t getFieldCount(uint8_t in_version)
+      {
+        size_t count = 0;
+        while (count < c_fieldCount && c_versions[count] <= in_version) { ++count; }
+        return count;
+      }
+
+      static constexpr const MessageType& getDefaults()
+      {
+        return c_defaults;
+      }
+
+      // Writes the fields known to schema version in_version, without trailing fields equal to their defaults.
+      template<size_t tc_bufferSize, typename CursorType>
+      static bool serialize(const MessageType& in_message, Serializer<tc_bufferSize, CursorType>& out_serializer, uint8_t in_version = c_version)
+      {
+        static constexpr std::array<WriteFunction<tc_bufferSize, CursorType>, c_fieldCount + 1> writeTable = makeWriteTable<tc_bufferSize, CursorType>(std::make_index_sequence<c_fieldCount + 1>());
+        const size_t count = getLastNonDefaultCount(in_message, getFieldCount(in_version), std::make_index_sequence<c_fieldCount>());
+
+        if (!out_serializer.template write<uint8_t>(static_cast<uint8_t>(count))) { return false; }
+        if (!out_serializer.template write<uint16_t>(static_cast<uint16_t>(c_prefixSizes[count]))) { return false; }
+        return writeTable[count](out_serializer, in_message);
+      }
+
+      template<size_t tc_bufferSize, typename CursorType>
+      static bool deserialize(Deserializer<tc_bufferSize, CursorType>& io_deserializer, MessageType& out_message)
+      {
+        static constexpr std::array<ReadFunction<tc_bufferSize, CursorType>, c_fieldCount + 1> readTable = makeReadTable<tc_bufferSize, CursorType>(std::make_index_sequence<c_fieldCount + 1>());
+
+        if (!io_deserializer.fitsInBuffer(2 * c_typeTagSize + sizeof(uint8_t) + sizeof(uint16_t))) { return false; }
+        const uint8_t count = io_deserializer.template read<uint8_t>();
+        const uint16_t size = io_deserializer.template read<uint16_t>();
+#if defined(HALVOE_SERIALIZER_TYPE_TAGS)
+        if (io_deserializer.hasTypeTagMismatch()) { return false; }
+#endif
+        // Fields of a newer version follow the known ones, so their size is all that has to be checked.
+        const size_t knownCount = count < c_fieldCount ? count : c_fieldCount;
+        if (count <= c_fieldCount ? size != c_prefixSizes[count] : size < c_prefixSizes[c_fieldCount]) { return false; }
+        if (!io_deserializer.fitsInBuffer(size)) { return false; }
+
+        out_message = c_defaults;
+        if (!readTable[knownCount](io_deserializer, out_message)) { return false; }
+        return io_deserializer.skipBytes(size - c_prefixSizes[knownCount]);
+      }
+  };
+}
@@ -0,0 +1,605 @@
+#pragma once
+
+#include <type_traits>
+#include <limits>
+#include <atomic>
+#include <array>
+#include <cstring>
+
+#include "BasicSerializer.hpp"
+
+// **** **** **** ****
+// NOTE: SegmentedSerializer writes the native format into a chain of fixed size blocks taken from a
+//       BlockPool, instead of one contiguous buffer. Values, strings and arrays are split across blocks
+//       as needed; the bytes are the same as Serializer would write. All blocks a write needs are taken
+//       from the pool before anything is written, so a failed write leaves the message unchanged.
+//       getSegments() gathers the written blocks for transmission (e.g. scatter/gather DMA or writev).
+//       The blocks go back to the pool when the SegmentedSerializer is destroyed or reset, so the pool
+//       must outlive it and the segments must not be used afterwards!
+//
+//       SegmentedDeserializer reads the native format from a list of BufferSegments (e.g. a received
+//       buffer chain or DMA descriptors), without flattening it first. A value inside one segment is
+//       read with a single copy, a value crossing a segment boundary is stitched together.
+//       view(SizeType&) only succeeds for strings that lie in one segment, view(BufferSegment*, ...) returns
+//       a string as several spans and read(char*, ...) copies any string.
+// **** **** **** ****
+
+namespace halvoe
+{
+  struct BufferSegment
+  {
+    const uint8_t* data = nullptr;
+    size_t size = 0;
+  };
+
+  template<size_t tc_blockSize>
+  struct BufferBlock
+  {
+    std::array<uint8_t, tc_blockSize> data;
+    BufferBlock* next = nullptr;
+    size_t size = 0;
+  };
+
+  template<size_t tc_blockSize, size_t tc_blockCount>
+  class BlockPool
+  {
+    static_assert(tc_blockSize > 0 && tc_blockCount > 0, "BlockPool needs at least one block of at least one byte!");
+
+    private:
+      std::array<BufferBlock<tc_blockSize>, tc_blockCount> m_blocks;
+      std::array<std::atomic<bool>, tc_blockCount> m_isInUse{};
+
+    public:
+      BlockPool() = default;
+      BlockPool(const BlockPool&) = delete;
+      BlockPool& operator=(const BlockPool&) = delete;
+
+      constexpr size_t getBlockSize() const
+      {
+        return tc_blockSize;
+      }
+
+      constexpr size_t getBlockCount() const
+      {
+        return tc_blockCount;
+      }
+
+      size_t getBlocksInUse() const
+      {
+        size_t count = 0;
+
+        for (const std::atomic<bool>& isInUse : m_isInUse)
+        {
+          if (isInUse.load(std::memory_order_acquire)) { ++count; }
+        }
+
+        return count;
+      }
+
+      // Returns an empty block, or nullptr if the pool is exhausted.
+      BufferBlock<tc_blockSize>* acquire()
+      {
+        for (size_t index = 0; index < tc_blockCount; ++index)
+        {
+          bool isInUse = false;
+          if (m_isInUse[index].compare_exchange_strong(isInUse, true, std::memory_order_acq_rel))
+          {
+            m_blocks[index].next = nullptr;
+            m_blocks[index].size = 0;
+            return &m_blocks[index];
+          }
+        }
+
+        return nullptr;
+      }
+
+      // Hands back in_block and all blocks chained behind it.
+      void release(BufferBlock<tc_blockSize>* in_block)
+      {
+        while (in_block != nullptr)
+        {
+          BufferBlock<tc_blockSize>* next = in_block->next;
+          in_block->next = nullptr;
+          m_isInUse[static_cast<size_t>(in_block - m_blocks.data())].store(false, std::memory_order_release);
+          in_block = next;
+        }
+      }
+  };
+
+  template<size_t tc_blockSize, size_t tc_blockCount>
+  class SegmentedSerializer
+  {
+    private:
+      BlockPool<tc_blockSize, tc_blockCount>& m_pool;
+      BufferBlock<tc_blockSize>* m_first = nullptr;
+      BufferBlock<tc_blockSize>* m_current = nullptr; // the block written to; blocks behind it are reserved
+      BufferBlock<tc_blockSize>* m_last = nullptr;
+      size_t m_bytesWritten = 0;
+
+    private:
+      // Makes sure in_size more bytes fit into the chain, taking blocks from the pool.
+      // Fails without keeping any block, if the pool runs dry.
+      bool reserve(size_t in_size)
+      {
+        size_t capacity = m_current == nullptr ? 0 : tc_blockSize - m_current->size;
+        for (BufferBlock<tc_blockSize>* block = m_current == nullptr ? nullptr : m_current->next; block != nullptr; block = block->next)
+        {
+          capacity = capacity + tc_blockSize;
+        }
+
+        BufferBlock<tc_blockSize>* const last = m_last; // where the chain ended before
+        while (capacity < in_size)
+        {
+          BufferBlock<tc_blockSize>* block = m_pool.acquire();
+          if (block == nullptr)
+          {
+            if (last == nullptr)
+            {
+              m_pool.release(m_first);
+              m_first = nullptr;
+              m_current = nullptr;
+            }
+            else
+            {
+              m_pool.release(last->next);
+              last->next = nullptr;
+            }
+
+            m_last = last;
+            return false;
+          }
+
+          if (m_last == nullptr) { m_first = block; m_current = block; }
+          else { m_last->next = block; }
+          m_last = block;
+          capacity = capacity + tc_blockSize;
+        }
+
+        return true;
+      }
+
+      // The caller has reserved in_size bytes.
+      void put(const void* in_data, size_t in_size)
+      {
+        const uint8_t* data = static_cast<const uint8_t*>(in_data);
+        m_bytesWritten = m_bytesWritten + in_size;
+
+        while (in_size > 0)
+        {
+          if (m_current->size == tc_blockSize) { m_current = m_current->next; }
+
+          const size_t chunkSize = in_size < tc_blockSize - m_current->size ? in_size : tc_blockSize - m_current->size;
+          std::memcpy(m_current->data.data() + m_current->size, data, chunkSize);
+          m_current->size = m_current->size + chunkSize;
+          data = data + chunkSize;
+          in_size = in_size - chunkSize;
+        }
+      }
+
+      template<typename Type>
+      bool putValue(uint8_t in_typeTag, Type in_value)
+      {
+        uint8_t bytes[c_typeTagSize + sizeof(Type)];
+        if (c_typeTagSize > 0) { bytes[0] = in_typeTag; }
+        std::memcpy(bytes + c_typeTagSize, &in_value, sizeof(Type));
+
+        if (sizeof(bytes) <= tc_blockSize && m_current != nullptr && sizeof(bytes) <= tc_blockSize - m_current->size)
+        {
+          std::memcpy(m_current->data.data() + m_current->size, bytes, sizeof(bytes));
+          m_current->size = m_current->size + sizeof(bytes);
+          m_bytesWritten = m_bytesWritten + sizeof(bytes);
+          return true;
+        }
+
+        if (!reserve(sizeof(bytes))) { return false; }
+        put(bytes, sizeof(bytes));
+        return true;
+      }
+
+    public:
+      SegmentedSerializer() = delete;
+      SegmentedSerializer(BlockPool<tc_blockSize, tc_blockCount>& io_pool) : m_pool(io_pool)
+      {}
+
+      SegmentedSerializer(const SegmentedSerializer&) = delete;
+      SegmentedSerializer& operator=(const SegmentedSerializer&) = delete;
+
+      ~SegmentedSerializer()
+      {
+        reset();
+      }
+
+      // Returns all blocks to the pool and starts a new message.
+      void reset()
+      {
+        m_pool.release(m_first);
+        m_first = nullptr;
+        m_current = nullptr;
+        m_last = nullptr;
+        m_bytesWritten = 0;
+      }
+
+      size_t getBytesWritten() const
+      {
+        return m_bytesWritten;
+      }
+
+      size_t getSegmentCount() const
+      {
+        size_t count = 0;
+        for (const BufferBlock<tc_blockSize>* block = m_first; block != nullptr && block->size > 0; block = block->next) { ++count; }
+        return count;
+      }
+
+      // Fills out_segments with the written blocks in order and returns their number,
+      // or 0 if in_capacity is smaller than getSegmentCount().
+      size_t getSegments(BufferSegment* out_segments, size_t in_capacity) const
+      {
+        const size_t count = getSegmentCount();
+        if (count > in_capacity) { return 0; }
+
+        const BufferBlock<tc_blockSize>* block = m_first;
+        for (size_t index = 0; index < count; ++index)
+        {
+          out_segments[index].data = block->data.data();
+          out_segments[index].size = block->size;
+          block = block->next;
+        }
+
+        return count;
+      }
+
+      template<typename Type>
+      bool write(Type in_value)
+      {
+        static_assert(std::is_arithmetic<Type>::value, "Type must be arithmetic!");
+        return putValue(getTypeTag<Type>(), in_value);
+      }
+
+      template<typename Type>
+      bool writeEnum(Type in_value)
+      {
+        using UnderlyingType = typename std::underlying_type<Type>::type;
+        static_assert(std::is_enum<Type>::value && std::is_arithmetic<UnderlyingType>::value, "Type must be an enum and underlying type must be arithmetic!");
+        return putValue(type_tag::c_enum | getTypeTag<UnderlyingType>(), static_cast<UnderlyingType>(in_value));
+      }
+
+      template<typename SizeType>
+      bool write(const char* in_string, SizeType in_size)
+      {
+        static_assert(isSizeType<SizeType>(), "SizeType must be an unsigned int!");
+        if (in_size > std::numeric_limits<size_t>::max() - c_typeTagSize - sizeof(SizeType) || !reserve(c_typeTagSize + sizeof(SizeType) + in_size)) { return false; }
+
+        uint8_t header[c_typeTagSize + sizeof(SizeType)];
+        if (c_typeTagSize > 0) { header[0] = type_tag::c_string | getTypeTag<SizeType>(); }
+        std::memcpy(header + c_typeTagSize, &in_size, sizeof(SizeType));
+        put(header, sizeof(header));
+        put(in_string, in_size);
+        return true;
+      }
+
+      // Writes in_count elements without a size prefix, like Serializer::writeArray.
+      template<typename Type>
+      bool writeArray(const Type* in_values, size_t in_count)
+      {
+        static_assert(std::is_arithmetic<Type>::value, "Type must be arithmetic!");
+        if (in_count > (std::numeric_limits<size_t>::max() - c_typeTagSize) / sizeof(Type) || !reserve(c_typeTagSize + in_count * sizeof(Type))) { return false; }
+
+        const uint8_t typeTag = type_tag::c_array | getTypeTag<Type>();
+        put(&typeTag, c_typeTagSize);
+        put(in_values, in_count * sizeof(Type));
+        return true;
+      }
+  };
+
+  class SegmentedDeserializer
+  {
+    private:
+      const BufferSegment* m_segments;
+      size_t m_segmentCount;
+      size_t m_nextSegmentIndex = 0;
+      const uint8_t* m_position = nullptr; // into the current segment
+      const uint8_t* m_segmentEnd = nullptr;
+      size_t m_segmentEndOffset = 0; // bytes up to the end of the current segment
+      size_t m_size = 0;
+#if defined(HALVOE_SERIALIZER_TYPE_TAGS)
+      TypeTagMismatch m_typeTagMismatch;
+      bool m_hasTypeTagMismatch = false;
+#endif
+
+    private:
+      // Moves past exhausted (and empty) segments, so the current segment always has bytes left.
+      void skipExhaustedSegments()
+      {
+        while (m_position == m_segmentEnd && m_nextSegmentIndex < m_segmentCount)
+        {
+          const BufferSegment& segment = m_segments[m_nextSegmentIndex];
+          m_nextSegmentIndex = m_nextSegmentIndex + 1;
+          m_position = segment.data;
+          m_segmentEnd = segment.data + segment.size;
+          m_segmentEndOffset = m_segmentEndOffset + segment.size;
+        }
+      }
+
+      // The caller has checked that in_size more bytes are left.
+      void advance(size_t in_size)
+      {
+        while (in_size > 0)
+        {
+          const size_t available = static_cast<size_t>(m_segmentEnd - m_position);
+          const size_t chunkSize = in_size < available ? in_size : available;
+          m_position = m_position + chunkSize;
+          in_size = in_size - chunkSize;
+          skipExhaustedSegments();
+        }
+      }
+
+      // Returns the next in_size bytes, if they lie in the current segment, otherwise nullptr.
+      const uint8_t* getContiguous(size_t in_size) const
+      {
+        return in_size <= static_cast<size_t>(m_segmentEnd - m_position) ? m_position : nullptr;
+      }
+
+      // Calls in_function(const BufferSegment& span, size_t offset) -> bool for each span of the in_size bytes
+      // following in_skip bytes (offset counts from their start), without advancing, until it returns false;
+      // the caller has checked the size.
+      template<typename Function>
+      bool forEachSpan(size_t in_skip, size_t in_size, Function&& in_function) const
+      {
+        const uint8_t* position = m_position;
+        const uint8_t* end = m_segmentEnd;
+        size_t nextSegmentIndex = m_nextSegmentIndex;
+        size_t offset = 0;
+        while (offset < in_size)
+        {
+          const size_t available = static_cast<size_t>(end - position);
+          if (in_skip >= available)
+          {
+            in_skip = in_skip - available;
+            position = m_segments[nextSegmentIndex].data;
+            end = position + m_segments[nextSegmentIndex].size;
+            nextSegmentIndex = nextSegmentIndex + 1;
+            continue;
+          }
+
+          position = position + in_skip;
+          in_skip = 0;
+          const size_t left = in_size - offset;
+          const size_t chunkSize = left < static_cast<size_t>(end - position) ? left : static_cast<size_t>(end - position);
+          if (!in_function(BufferSegment{ position, chunkSize }, offset)) { return false; }
+          position = position + chunkSize;
+          offset = offset + chunkSize;
+        }
+
+        return true;
+      }
+
+      // Copies the in_size bytes following in_skip bytes without advancing; the caller has checked the size.
+      void copy(uint8_t* out_data, size_t in_skip, size_t in_size) const
+      {
+        forEachSpan(in_skip, in_size, [out_data](const BufferSegment& in_span, size_t in_offset)
+        {
+          std::memcpy(out_data + in_offset, in_span.data, in_span.size);
+          return true;
+        });
+      }
+
+      // Fills out_spans with the in_size bytes following in_skip bytes and returns the number of spans,
+      // or in_capacity + 1 if more spans are needed; the caller has checked the size.
+      size_t getSpans(size_t in_skip, size_t in_size, BufferSegment* out_spans, size_t in_capacity) const
+      {
+        size_t count = 0;
+        const bool hasFitted = forEachSpan(in_skip, in_size, [&count, out_spans, in_capacity](const BufferSegment& in_span, size_t)
+        {
+          if (count == in_capacity) { return false; }
+          out_spans[count] = in_span;
+          count = count + 1;
+          return true;
+        });
+
+        return hasFitted ? count : in_capacity + 1;
+      }
+
+      bool checkTypeTag(const uint8_t* in_bytes, uint8_t in_typeTag)
+      {
+#if defined(HALVOE_SERIALIZER_TYPE_TAGS)
+        if (in_bytes[0] != in_typeTag)
+        {
+          m_typeTagMismatch.offset = getBytesRead();
+          m_typeTagMismatch.expected = in_typeTag;
+          m_typeTagMismatch.actual = in_bytes[0];
+          m_hasTypeTagMismatch = true;
+          HALVOE_ON_TYPE_TAG_MISMATCH(getBytesRead(), in_typeTag, in_bytes[0]);
+          return false;
+        }
+#else
+        (void)in_bytes;
+        (void)in_typeTag;
+#endif
+        return true;
+      }
+
+      // Reads a value that crosses a segment boundary.
+      template<typename Type>
+      bool readStitchedValue(uint8_t in_typeTag, Type& out_value)
+      {
+        uint8_t bytes[c_typeTagSize + sizeof(Type)];
+        if (sizeof(bytes) > getBytesLeft()) { return false; }
+
+        copy(bytes, 0, sizeof(bytes));
+        if (!checkTypeTag(bytes, in_typeTag)) { return false; }
+
+        std::memcpy(&out_value, bytes + c_typeTagSize, sizeof(Type));
+        advance(sizeof(bytes));
+        return true;
+      }
+
+      // Reads a type tag and value, without advancing on failure.
+      template<typename Type>
+      bool readValue(uint8_t in_typeTag, Type& out_value)
+      {
+        constexpr size_t c_size = c_typeTagSize + sizeof(Type);
+        if (c_size > static_cast<size_t>(m_segmentEnd - m_position)) { return readStitchedValue(in_typeTag, out_value); }
+        if (!checkTypeTag(m_position, in_typeTag)) { return false; }
+
+        std::memcpy(&out_value, m_position + c_typeTagSize, sizeof(Type));
+        m_position = m_position + c_size;
+        if (m_position == m_segmentEnd) { skipExhaustedSegments(); }
+        return true;
+      }
+
+      // Reads the tag and size of a string, without advancing.
+      template<typename SizeType>
+      bool peekStringSize(SizeType& out_size)
+      {
+        uint8_t bytes[c_typeTagSize + sizeof(SizeType)];
+        if (sizeof(bytes) > getBytesLeft()) { return false; }
+
+        copy(bytes, 0, sizeof(bytes));
+        if (!checkTypeTag(bytes, type_tag::c_string | getTypeTag<SizeType>())) { return false; }
+
+        std::memcpy(&out_size, bytes + c_typeTagSize, sizeof(SizeType));
+        return out_size <= getBytesLeft() - sizeof(bytes);
+      }
+
+    public:
+      SegmentedDeserializer() = delete;
+      SegmentedDeserializer(const BufferSegment* in_segments, size_t in_segmentCount) : m_segments(in_segments), m_segmentCount(in_segmentCount)
+      {
+        for (size_t index = 0; index < m_segmentCount; ++index) { m_size = m_size + m_segments[index].size; }
+        skipExhaustedSegments();
+      }
+
+      size_t getSize() const
+      {
+        return m_size;
+      }
+
+      size_t getBytesRead() const
+      {
+        return m_segmentEndOffset - static_cast<size_t>(m_segmentEnd - m_position);
+      }
+
+      size_t getBytesLeft() const
+      {
+        return m_size - getBytesRead();
+      }
+
+#if defined(HALVOE_SERIALIZER_TYPE_TAGS)
+      bool hasTypeTagMismatch() const
+      {
+        return m_hasTypeTagMismatch;
+      }
+
+      const TypeTagMismatch& getTypeTagMismatch() const
+      {
+        return m_typeTagMismatch;
+      }
+#endif
+
+      bool fitsInBuffer(size_t in_size) const
+      {
+        return in_size <= getBytesLeft();
+      }
+
+      template<typename Type>
+      bool fitsInBuffer() const
+      {
+        static_assert(std::is_arithmetic<Type>::value, "Type must be arithmetic!");
+        return fitsInBuffer(c_typeTagSize + sizeof(Type));
+      }
+
+      template<typename Type>
+      bool skip()
+      {
+        static_assert(std::is_arithmetic<Type>::value, "Type must be arithmetic!");
+        Type value;
+        return readValue(getTypeTag<Type>(), value);
+      }
+
+      template<typename Type>
+      Type read()
+      {
+        static_assert(std::is_arithmetic<Type>::value, "Type must be arithmetic!");
+        Type value;
+        if (!readValue(getTypeTag<Type>(), value)) { return std::numeric_limits<Type>::max(); }
+        return value;
+      }
+
+      template<typename Type>
+      Type readEnum()
+      {
+        using UnderlyingType = typename std::underlying_type<Type>::type;
+        static_assert(std::is_enum<Type>::value && std::is_arithmetic<UnderlyingType>::value, "Type must be an enum and underlying type must be arithmetic!");
+        UnderlyingType value;
+        if (!readValue(type_tag::c_enum | getTypeTag<UnderlyingType>(), value)) { return Type{ std::numeric_limits<UnderlyingType>::max() }; }
+        return Type{ value };
+      }
+
+      // Returns a view of a string, if it lies in one segment; otherwise nullptr, and nothing is consumed.
+      template<typename SizeType>
+      const char* view(SizeType& out_stringSize)
+      {
+        static_assert(isSizeType<SizeType>(), "SizeType must be an unsigned int!");
+        SizeType size;
+        if (!peekStringSize(size)) { return nullptr; }
+
+        const uint8_t* data = getContiguous(c_typeTagSize + sizeof(SizeType) + size);
+        if (data == nullptr) { return nullptr; }
+
+        out_stringSize = size;
+        advance(c_typeTagSize + sizeof(SizeType) + size);
+        return reinterpret_cast<const char*>(data + c_typeTagSize + sizeof(SizeType));
+      }
+
+      // Returns a string as up to in_capacity spans into the segments, without copying it.
+      // Fails without consuming anything, if the string is spread over more segments.
+      template<typename SizeType>
+      bool view(BufferSegment* out_spans, size_t in_capacity, size_t& out_spanCount, SizeType& out_stringSize)
+      {
+        static_assert(isSizeType<SizeType>(), "SizeType must be an unsigned int!");
+        SizeType size;
+        if (!peekStringSize(size)) { return false; }
+
+        const size_t spanCount = getSpans(c_typeTagSize + sizeof(SizeType), size, out_spans, in_capacity);
+        if (spanCount > in_capacity) { return false; }
+
+        out_spanCount = spanCount;
+        out_stringSize = size;
+        advance(c_typeTagSize + sizeof(SizeType) + size);
+        return true;
+      }
+
+      // Copies a string and a terminating '\0' into out_string. Fails without consuming anything,
+      // if the string needs more than in_capacity chars.
+      template<typename SizeType>
+      bool read(char* out_string, size_t in_capacity, SizeType& out_stringSize)
+      {
+        static_assert(isSizeType<SizeType>(), "SizeType must be an unsigned int!");
+        SizeType size;
+        if (!peekStringSize(size) || size >= in_capacity) { return false; }
+
+        copy(reinterpret_cast<uint8_t*>(out_string), c_typeTagSize + sizeof(SizeType), size);
+        out_string[size] = '\0';
+        out_stringSize = size;
+        advance(c_typeTagSize + sizeof(SizeType) + size);
+        return true;
+      }
+
+      // Reads in_count elements, written by Serializer::writeArray.
+      template<typename Type>
+      bool readArray(Type* out_values, size_t in_count)
+      {
+        static_assert(std::is_arithmetic<Type>::value, "Type must be arithmetic!");
+        if (c_typeTagSize > getBytesLeft() || in_count > (getBytesLeft() - c_typeTagSize) / sizeof(Type)) { return false; }
+
+        uint8_t typeTag[c_typeTagSize + 1];
+        copy(typeTag, 0, c_typeTagSize);
+        if (!checkTypeTag(typeTag, type_tag::c_array | getTypeTag<Type>())) { return false; }
+
+        copy(reinterpret_cast<uint8_t*>(out_values), c_typeTagSize, in_count * sizeof(Type));
+        advance(c_typeTagSize + in_count * sizeof(Type));
+        return true;
+      }
+  };
+}
@@ -0,0 +1,193 @@
+#pragma once
+
+#include <array>
+#include <utility>
+
+#include "BasicSerializer.hpp"
+#include "SharedBuffer.hpp"
+
+// **** **** **** ****
+// NOTE: SerializationCache remembers the serialized bytes of objects that rarely change (e.g. configuration),
+//       so they are not serialized again for every client. An entry is keyed by the object's address and a
+//       version counter, which the owner must increment on every change; a lookup with another version misses
+//       and drops the stale entry. Hits return a SharedBuffer to the cached bytes, no copy is made.
+//       Memory is bounded: at most tc_entryCount entries, whose bytes live in a SharedBufferPool. When the
+//       cache is full the least recently used entry is replaced; its buffer returns to the pool once the last
+//       client has released its SharedBuffer. When the pool is exhausted, only entries no client holds are
+//       evicted (they free a buffer right away), least recently used first. If clients hold every cached
+//       buffer, getOrSerialize fails and leaves the cache as it is.
+//       The cache itself is not thread safe, use it from one thread (the SharedBuffers it returns may be
+//       handed to other threads).
+// **** **** **** ****
+
+namespace halvoe
+{
+  template<size_t tc_entryCount>
+  class SerializationCache
+  {
+    static_assert(tc_entryCount > 0, "SerializationCache needs at least one entry!");
+
+    private:
+      struct Entry
+      {
+        const void* object = nullptr;
+        uint32_t version = 0;
+        uint32_t lastUse = 0;
+        SharedBuffer buffer;
+      };
+
+      std::array<Entry, tc_entryCount> m_entries;
+      uint32_t m_useCounter = 0;
+      uint32_t m_hitCount = 0;
+      uint32_t m_missCount = 0;
+
+    private:
+      Entry* findEntry(const void* in_object)
+      {
+        for (Entry& entry : m_entries)
+        {
+          if (entry.object == in_object && !entry.buffer.isNull()) { return &entry; }
+        }
+
+        return nullptr;
+      }
+
+      // Returns the entry of in_object, an empty entry or the least recently used one, in this order.
+      Entry& getEntryToReplace(const void* in_object)
+      {
+        Entry* entry = findEntry(in_object);
+        if (entry != nullptr) { return *entry; }
+
+        Entry* leastRecentlyUsed = &m_entries[0];
+        for (Entry& candidate : m_entries)
+        {
+          if (candidate.buffer.isNull()) { return candidate; }
+          // Wrap-around safe, as long as an entry is not left unused for 2^31 lookups.
+          if (static_cast<int32_t>(candidate.lastUse - leastRecentlyUsed->lastUse) < 0) { leastRecentlyUsed = &candidate; }
+        }
+
+        return *leastRecentlyUsed;
+      }
+
+      void clearEntry(Entry& io_entry)
+      {
+        io_entry.object = nullptr;
+        io_entry.buffer.reset();
+      }
+
+      // Evicts the least recently used entry whose buffer only the cache holds, so its buffer goes back to the pool.
+      bool evictLeastRecentlyUsedIdle()
+      {
+        Entry* leastRecentlyUsed = nullptr;
+        for (Entry& entry : m_entries)
+        {
+          if (entry.buffer.getReferenceCount() != 1) { continue; }
+          if (leastRecentlyUsed == nullptr || static_cast<int32_t>(entry.lastUse - leastRecentlyUsed->lastUse) < 0) { leastRecentlyUsed = &entry; }
+        }
+
+        if (leastRecentlyUsed == nullptr) { return false; }
+
+        clearEntry(*leastRecentlyUsed);
+        return true;
+      }
+
+    public:
+      SerializationCache() = default;
+      SerializationCache(const SerializationCache&) = delete;
+      SerializationCache& operator=(const SerializationCache&) = delete;
+
+      constexpr size_t getEntryCapacity() const
+      {
+        return tc_entryCount;
+      }
+
+      size_t getEntryCount() const
+      {
+        size_t count = 0;
+
+        for (const Entry& entry : m_entries)
+        {
+          if (!entry.buffer.isNull()) { ++count; }
+        }
+
+        return count;
+      }
+
+      uint32_t getHitCount() const
+      {
+        return m_hitCount;
+      }
+
+      uint32_t getMissCount() const
+      {
+        return m_missCount;
+      }
+
+      // Returns the cached bytes of in_object at in_version, or a null SharedBuffer on a miss.
+      SharedBuffer find(const void* in_object, uint32_t in_version)
+      {
+        Entry* entry = findEntry(in_object);
+        if (entry == nullptr || entry->version != in_version)
+        {
+          if (entry != nullptr) { clearEntry(*entry); }
+          m_missCount = m_missCount + 1;
+          return SharedBuffer();
+        }
+
+        m_useCounter = m_useCounter + 1;
+        entry->lastUse = m_useCounter;
+        m_hitCount = m_hitCount + 1;
+        return entry->buffer;
+      }
+
+      // Caches in_buffer as the bytes of in_object at in_version, replacing an older version.
+      void insert(const void* in_object, uint32_t in_version, SharedBuffer in_buffer)
+      {
+        if (in_buffer.isNull()) { return; }
+
+        Entry& entry = getEntryToReplace(in_object);
+        m_useCounter = m_useCounter + 1;
+        entry.object = in_object;
+        entry.version = in_version;
+        entry.lastUse = m_useCounter;
+        entry.buffer = std::move(in_buffer);
+      }
+
+      // Returns the cached bytes of in_object at in_version or, on a miss, serializes it with
+      // in_serialize(Serializer<tc_bufferSize, CursorType>&) -> bool into a buffer of io_pool and caches the result.
+      // Returns a null SharedBuffer, if in_serialize fails or no buffer can be freed in io_pool.
+      template<typename CursorType = size_t, size_t tc_bufferSize, size_t tc_bufferCount, typename SerializeFunction>
+      SharedBuffer getOrSerialize(SharedBufferPool<tc_bufferSize, tc_bufferCount>& io_pool, const void* in_object, uint32_t in_version,
+                                  SerializeFunction&& in_serialize)
+      {
+        SharedBuffer buffer = find(in_object, in_version);
+        if (!buffer.isNull()) { return buffer; }
+
+        uint8_t* data = io_pool.acquire();
+        while (data == nullptr && evictLeastRecentlyUsedIdle()) { data = io_pool.acquire(); }
+        if (data == nullptr) { return SharedBuffer(); }
+
+        Serializer<tc_bufferSize, CursorType> serializer(data);
+        if (!in_serialize(serializer))
+        {
+          io_pool.release(data);
+          return SharedBuffer();
+        }
+
+        buffer = io_pool.finalise(serializer);
+        insert(in_object, in_version, buffer);
+        return buffer;
+      }
+
+      void invalidate(const void* in_object)
+      {
+        Entry* entry = findEntry(in_object);
+        if (entry != nullptr) { clearEntry(*entry); }
+      }
+
+      void clear()
+      {
+        for (Entry& entry : m_entries) { clearEntry(entry); }
+      }
+  };
+}
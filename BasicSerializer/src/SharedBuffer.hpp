@@ -0,0 +1,204 @@
+#pragma once
+
+#include <atomic>
+#include <array>
+#include <utility>
+
+#include "BasicSerializer.hpp"
+
+// **** **** **** ****
+// NOTE: A SharedBuffer is an immutable, reference counted handle to a finalised message.
+//       Copies of a SharedBuffer share the same bytes, so one frame can be handed to several
+//       sinks (and threads) without copying it. The storage goes back to its SharedBufferPool
+//       when the last handle is destroyed, so the pool must outlive all of its SharedBuffers!
+// **** **** **** ****
+
+namespace halvoe
+{
+  class SharedBufferBlock
+  {
+    template<size_t tc_bufferSize, size_t tc_bufferCount>
+    friend class SharedBufferPool;
+    friend class SharedBuffer;
+
+    private:
+      std::atomic<uint32_t> m_referenceCount{ 0 };
+      std::atomic<bool> m_isInUse{ false };
+      size_t m_size = 0;
+      uint8_t* m_data = nullptr;
+
+    private:
+      void addReference()
+      {
+        m_referenceCount.fetch_add(1, std::memory_order_relaxed);
+      }
+
+      void removeReference()
+      {
+        if (m_referenceCount.fetch_sub(1, std::memory_order_acq_rel) == 1)
+        {
+          m_isInUse.store(false, std::memory_order_release);
+        }
+      }
+  };
+
+  class SharedBuffer
+  {
+    private:
+      SharedBufferBlock* m_block;
+
+    public:
+      SharedBuffer() : m_block(nullptr)
+      {}
+
+      explicit SharedBuffer(SharedBufferBlock* in_block) : m_block(in_block)
+      {
+        if (m_block != nullptr) { m_block->addReference(); }
+      }
+
+      SharedBuffer(const SharedBuffer& in_other) : m_block(in_other.m_block)
+      {
+        if (m_block != nullptr) { m_block->addReference(); }
+      }
+
+      SharedBuffer(SharedBuffer&& in_other) noexcept : m_block(in_other.m_block)
+      {
+        in_other.m_block = nullptr;
+      }
+
+      ~SharedBuffer()
+      {
+        reset();
+      }
+
+      SharedBuffer& operator=(SharedBuffer in_other) noexcept
+      {
+        std::swap(m_block, in_other.m_block);
+        return *this;
+      }
+
+      void reset()
+      {
+        if (m_block != nullptr) { m_block->removeReference(); }
+        m_block = nullptr;
+      }
+
+      bool isNull() const
+      {
+        return m_block == nullptr;
+      }
+
+      const uint8_t* getBuffer() const
+      {
+        if (m_block == nullptr) { return nullptr; }
+
+        return m_block->m_data;
+      }
+
+      size_t getSize() const
+      {
+        if (m_block == nullptr) { return 0; }
+
+        return m_block->m_size;
+      }
+
+      uint32_t getReferenceCount() const
+      {
+        if (m_block == nullptr) { return 0; }
+
+        return m_block->m_referenceCount.load(std::memory_order_relaxed);
+      }
+  };
+
+  template<size_t tc_bufferSize, size_t tc_bufferCount>
+  class SharedBufferPool
+  {
+    static_assert(tc_bufferCount > 0, "SharedBufferPool needs at least one buffer!");
+
+    private:
+      std::array<SharedBufferBlock, tc_bufferCount> m_blocks;
+      std::array<std::array<uint8_t, tc_bufferSize>, tc_bufferCount> m_buffers;
+
+    private:
+      SharedBufferBlock* findBlock(const uint8_t* in_buffer)
+      {
+        for (size_t index = 0; index < tc_bufferCount; ++index)
+        {
+          if (m_buffers[index].data() == in_buffer) { return &m_blocks[index]; }
+        }
+
+        return nullptr;
+      }
+
+    public:
+      SharedBufferPool()
+      {
+        for (size_t index = 0; index < tc_bufferCount; ++index)
+        {
+          m_blocks[index].m_data = m_buffers[index].data();
+        }
+      }
+
+      SharedBufferPool(const SharedBufferPool&) = delete;
+      SharedBufferPool& operator=(const SharedBufferPool&) = delete;
+
+      constexpr size_t getBufferSize() const
+      {
+        return tc_bufferSize;
+      }
+
+      constexpr size_t getBufferCount() const
+      {
+        return tc_bufferCount;
+      }
+
+      size_t getBuffersInUse() const
+      {
+        size_t count = 0;
+
+        for (const auto& block : m_blocks)
+        {
+          if (block.m_isInUse.load(std::memory_order_acquire)) { ++count; }
+        }
+
+        return count;
+      }
+
+      // Returns the buffer a Serializer<tc_bufferSize> writes into, or nullptr if the pool is exhausted.
+      uint8_t* acquire()
+      {
+        for (size_t index = 0; index < tc_bufferCount; ++index)
+        {
+          bool isInUse = false;
+          if (m_blocks[index].m_isInUse.compare_exchange_strong(isInUse, true, std::memory_order_acq_rel))
+          {
+            m_blocks[index].m_size = 0;
+            return m_buffers[index].data();
+          }
+        }
+
+        return nullptr;
+      }
+
+      // Hands an acquired buffer back without finalising it (e.g. when serialization failed).
+      bool release(uint8_t* in_buffer)
+      {
+        SharedBufferBlock* block = findBlock(in_buffer);
+        if (block == nullptr || block->m_referenceCount.load(std::memory_order_acquire) != 0) { return false; }
+
+        block->m_isInUse.store(false, std::memory_order_release);
+        return true;
+      }
+
+      // Freezes the bytes written so far. The serializer must not be written to afterwards.
+      template<typename CursorType>
+      SharedBuffer finalise(const Serializer<tc_bufferSize, CursorType>& in_serializer)
+      {
+        SharedBufferBlock* block = findBlock(in_serializer.getBuffer());
+        if (block == nullptr || !block->m_isInUse.load(std::memory_order_acquire) || block->m_referenceCount.load(std::memory_order_acquire) != 0) { return SharedBuffer(); }
+
+        block->m_size = in_serializer.getBytesWritten();
+        return SharedBuffer(block);
+      }
+  };
+}
@@ -0,0 +1,178 @@
+#pragma once
+
+#include <array>
+#include <cstring>
+
+#include "BasicSerializer.hpp"
+#include "ByteOrder.hpp"
+
+// **** **** **** ****
+// NOTE: SipHash-2-4 message authentication for frames that need integrity, but no secrecy.
+//       appendSipHashTag appends the 8 byte tag behind the bytes a Serializer has written (it needs
+//       c_sipHashTagSize bytes left), verifySipHashTag checks it in constant time on receive.
+//       SipHash24 can also be updated while the message is written: update(serializer) hashes only the
+//       bytes written since the previous update, so it must be fed by one Serializer from its first byte on.
+//       A tag does not stop replays, so include a sequence number in the message if that matters.
+// **** **** **** ****
+
+namespace halvoe
+{
+  static constexpr size_t c_sipHashKeySize = 16;
+  static constexpr size_t c_sipHashTagSize = 8;
+
+  using SipHashKey = std::array<uint8_t, c_sipHashKeySize>;
+
+  class SipHash24
+  {
+    private:
+      uint64_t m_v0;
+      uint64_t m_v1;
+      uint64_t m_v2;
+      uint64_t m_v3;
+      uint8_t m_tail[8];
+      size_t m_size = 0;
+
+    private:
+      static uint64_t rotate(uint64_t in_value, int in_shift)
+      {
+        return (in_value << in_shift) | (in_value >> (64 - in_shift));
+      }
+
+      void round()
+      {
+        m_v0 = m_v0 + m_v1; m_v1 = rotate(m_v1, 13); m_v1 = m_v1 ^ m_v0; m_v0 = rotate(m_v0, 32);
+        m_v2 = m_v2 + m_v3; m_v3 = rotate(m_v3, 16); m_v3 = m_v3 ^ m_v2;
+        m_v0 = m_v0 + m_v3; m_v3 = rotate(m_v3, 21); m_v3 = m_v3 ^ m_v0;
+        m_v2 = m_v2 + m_v1; m_v1 = rotate(m_v1, 17); m_v1 = m_v1 ^ m_v2; m_v2 = rotate(m_v2, 32);
+      }
+
+      void compress(uint64_t in_word)
+      {
+        m_v3 = m_v3 ^ in_word;
+        round();
+        round();
+        m_v0 = m_v0 ^ in_word;
+      }
+
+    public:
+      SipHash24() = delete;
+      SipHash24(const SipHashKey& in_key)
+      {
+        const uint64_t key0 = loadLittleEndian<uint64_t>(in_key.data());
+        const uint64_t key1 = loadLittleEndian<uint64_t>(in_key.data() + 8);
+        m_v0 = key0 ^ 0x736f6d6570736575;
+        m_v1 = key1 ^ 0x646f72616e646f6d;
+        m_v2 = key0 ^ 0x6c7967656e657261;
+        m_v3 = key1 ^ 0x7465646279746573;
+      }
+
+      // The number of bytes hashed so far.
+      size_t getSize() const
+      {
+        return m_size;
+      }
+
+      void update(const uint8_t* in_data, size_t in_size)
+      {
+        size_t tailSize = m_size % 8;
+        m_size = m_size + in_size;
+
+        if (tailSize > 0)
+        {
+          const size_t count = in_size < 8 - tailSize ? in_size : 8 - tailSize;
+          std::memcpy(m_tail + tailSize, in_data, count);
+          in_data = in_data + count;
+          in_size = in_size - count;
+          tailSize = tailSize + count;
+          if (tailSize < 8) { return; }
+
+          compress(loadLittleEndian<uint64_t>(m_tail));
+        }
+
+        while (in_size >= 8)
+        {
+          compress(loadLittleEndian<uint64_t>(in_data));
+          in_data = in_data + 8;
+          in_size = in_size - 8;
+        }
+
+        std::memcpy(m_tail, in_data, in_size);
+      }
+
+      // Hashes the bytes in_serializer has written since the previous update.
+      template<size_t tc_bufferSize, typename CursorType>
+      bool update(const Serializer<tc_bufferSize, CursorType>& in_serializer)
+      {
+        if (in_serializer.getBytesWritten() < m_size) { return false; }
+
+        update(in_serializer.getBuffer() + m_size, in_serializer.getBytesWritten() - m_size);
+        return true;
+      }
+
+      // Returns the tag of everything hashed so far. The hash must not be updated afterwards.
+      uint64_t finish()
+      {
+        uint8_t lastBlock[8] = {};
+        std::memcpy(lastBlock, m_tail, m_size % 8);
+        lastBlock[7] = static_cast<uint8_t>(m_size);
+        compress(loadLittleEndian<uint64_t>(lastBlock));
+
+        m_v2 = m_v2 ^ 0xff;
+        round();
+        round();
+        round();
+        round();
+        return m_v0 ^ m_v1 ^ m_v2 ^ m_v3;
+      }
+  };
+
+  inline uint64_t getSipHash24(const SipHashKey& in_key, const uint8_t* in_data, size_t in_size)
+  {
+    SipHash24 hash(in_key);
+    hash.update(in_data, in_size);
+    return hash.finish();
+  }
+
+  // Appends the tag of the first in_size bytes of io_buffer behind them. Returns the frame size
+  // (in_size + c_sipHashTagSize), or 0 if in_capacity is too small.
+  inline size_t appendSipHashTag(uint8_t* io_buffer, size_t in_size, size_t in_capacity, const SipHashKey& in_key)
+  {
+    if (in_size > in_capacity || c_sipHashTagSize > in_capacity - in_size) { return 0; }
+
+    storeLittleEndian<uint64_t>(io_buffer + in_size, getSipHash24(in_key, io_buffer, in_size));
+    return in_size + c_sipHashTagSize;
+  }
+
+  // Appends the tag of everything in_hash has been updated with. Use it with update(serializer)
+  // to hash the message while it is written.
+  template<size_t tc_bufferSize, typename CursorType>
+  size_t appendSipHashTag(Serializer<tc_bufferSize, CursorType>& io_serializer, SipHash24& io_hash)
+  {
+    const size_t size = io_serializer.getBytesWritten();
+    if (!io_hash.update(io_serializer) || !io_serializer.fitsInBuffer(c_sipHashTagSize)) { return 0; }
+
+    storeLittleEndian<uint64_t>(io_serializer.getBuffer() + size, io_hash.finish());
+    return size + c_sipHashTagSize;
+  }
+
+  // Appends the tag of the bytes written so far. Send getBuffer()[0..returned size).
+  template<size_t tc_bufferSize, typename CursorType>
+  size_t appendSipHashTag(Serializer<tc_bufferSize, CursorType>& io_serializer, const SipHashKey& in_key)
+  {
+    return appendSipHashTag(io_serializer.getBuffer(), io_serializer.getBytesWritten(), tc_bufferSize, in_key);
+  }
+
+  // Checks the tag at the end of the in_frameSize bytes of in_buffer in constant time.
+  // On success out_size is the size of the message in front of the tag.
+  inline bool verifySipHashTag(const uint8_t* in_buffer, size_t in_frameSize, const SipHashKey& in_key, size_t& out_size)
+  {
+    if (in_frameSize < c_sipHashTagSize) { return false; }
+
+    const size_t size = in_frameSize - c_sipHashTagSize;
+    const uint64_t difference = getSipHash24(in_key, in_buffer, size) ^ loadLittleEndian<uint64_t>(in_buffer + size);
+    if (difference != 0) { return false; }
+
+    out_size = size;
+    return true;
+  }
+}
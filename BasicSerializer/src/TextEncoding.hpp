@@ -0,0 +1,445 @@
+#pragma once
+
+#include <array>
+#include <cstring>
+
+#include "BasicSerializer.hpp"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSSE3__)
+#include <tmmintrin.h>
+#endif
+
+// **** **** **** ****
+// NOTE: Base64 (RFC 4648, with padding) and lower case hex encoding of serialized buffers.
+//       encodeBase64/decodeBase64/encodeHex/decodeHex use AVX2 or SSSE3 when the compiler targets them
+//       (e.g. -mavx2 or -march=native) and fall back to the ...Scalar variants otherwise, e.g. on the MCU.
+//       The Scalar variants are always available, so both can be compared on the same machine.
+//       Decoding accepts upper and lower case hex digits and Base64 with or without padding; padding that
+//       does not complete the last quad is rejected.
+// **** **** **** ****
+
+namespace halvoe
+{
+  namespace base64
+  {
+    static constexpr char c_alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    static constexpr uint8_t c_invalid = 0xff;
+
+    static constexpr std::array<uint8_t, 256> makeDecodeTable()
+    {
+      std::array<uint8_t, 256> table{};
+      for (size_t index = 0; index < table.size(); ++index) { table[index] = c_invalid; }
+      for (size_t index = 0; index < 64; ++index) { table[static_cast<uint8_t>(c_alphabet[index])] = static_cast<uint8_t>(index); }
+      return table;
+    }
+
+    static constexpr std::array<uint8_t, 256> c_decodeTable = makeDecodeTable();
+
+#if defined(__SSSE3__)
+    inline __m128i encodeBlock(__m128i in_bytes)
+    {
+      // Spreads 12 bytes into 16 six bit indices (W. Muła, "Base64 encoding with SIMD instructions").
+      const __m128i input = _mm_shuffle_epi8(in_bytes, _mm_set_epi8(10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1));
+      const __m128i high = _mm_mulhi_epu16(_mm_and_si128(input, _mm_set1_epi32(0x0fc0fc00)), _mm_set1_epi32(0x04000040));
+      const __m128i low = _mm_mullo_epi16(_mm_and_si128(input, _mm_set1_epi32(0x003f03f0)), _mm_set1_epi32(0x01000010));
+      const __m128i indices = _mm_or_si128(high, low);
+
+      __m128i shiftIndex = _mm_subs_epu8(indices, _mm_set1_epi8(51));
+      const __m128i isUpper = _mm_cmpgt_epi8(_mm_set1_epi8(26), indices);
+      shiftIndex = _mm_or_si128(shiftIndex, _mm_and_si128(isUpper, _mm_set1_epi8(13)));
+      const __m128i shifts = _mm_setr_epi8('a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                                           '0' - 52, '0' - 52, '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0);
+      return _mm_add_epi8(_mm_shuffle_epi8(shifts, shiftIndex), indices);
+    }
+
+    // Translates 16 characters into 12 bytes (in the low 12 bytes); returns false on an invalid character.
+    inline bool decodeBlock(__m128i in_text, __m128i& out_bytes)
+    {
+      const __m128i mask2F = _mm_set1_epi8(0x2f);
+      const __m128i lowLookup = _mm_setr_epi8(0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x13, 0x1a, 0x1b, 0x1b, 0x1b, 0x1a);
+      const __m128i highLookup = _mm_setr_epi8(0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10);
+      const __m128i rollLookup = _mm_setr_epi8(0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0);
+
+      const __m128i highNibbles = _mm_and_si128(_mm_srli_epi32(in_text, 4), mask2F);
+      const __m128i lowNibbles = _mm_and_si128(in_text, mask2F);
+      const __m128i low = _mm_shuffle_epi8(lowLookup, lowNibbles);
+      const __m128i high = _mm_shuffle_epi8(highLookup, highNibbles);
+      if (_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_and_si128(low, high), _mm_setzero_si128())) != 0xffff) { return false; }
+
+      const __m128i roll = _mm_shuffle_epi8(rollLookup, _mm_add_epi8(_mm_cmpeq_epi8(in_text, mask2F), highNibbles));
+      const __m128i indices = _mm_add_epi8(in_text, roll);
+      const __m128i pairs = _mm_maddubs_epi16(indices, _mm_set1_epi32(0x01400140));
+      const __m128i triples = _mm_madd_epi16(pairs, _mm_set1_epi32(0x00011000));
+      out_bytes = _mm_shuffle_epi8(triples, _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1));
+      return true;
+    }
+#endif
+
+#if defined(__AVX2__)
+    inline __m256i encodeBlock(__m256i in_bytes)
+    {
+      const __m256i input = _mm256_shuffle_epi8(in_bytes, _mm256_set_epi8(10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1,
+                                                                           10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1));
+      const __m256i high = _mm256_mulhi_epu16(_mm256_and_si256(input, _mm256_set1_epi32(0x0fc0fc00)), _mm256_set1_epi32(0x04000040));
+      const __m256i low = _mm256_mullo_epi16(_mm256_and_si256(input, _mm256_set1_epi32(0x003f03f0)), _mm256_set1_epi32(0x01000010));
+      const __m256i indices = _mm256_or_si256(high, low);
+
+      __m256i shiftIndex = _mm256_subs_epu8(indices, _mm256_set1_epi8(51));
+      const __m256i isUpper = _mm256_cmpgt_epi8(_mm256_set1_epi8(26), indices);
+      shiftIndex = _mm256_or_si256(shiftIndex, _mm256_and_si256(isUpper, _mm256_set1_epi8(13)));
+      const __m256i shifts = _mm256_setr_epi8('a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                                              '0' - 52, '0' - 52, '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0,
+                                              'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                                              '0' - 52, '0' - 52, '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0);
+      return _mm256_add_epi8(_mm256_shuffle_epi8(shifts, shiftIndex), indices);
+    }
+
+    // Translates 32 characters into 24 bytes (in the low 24 bytes); returns false on an invalid character.
+    inline bool decodeBlock(__m256i in_text, __m256i& out_bytes)
+    {
+      const __m256i mask2F = _mm256_set1_epi8(0x2f);
+      const __m256i lowLookup = _mm256_setr_epi8(0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x13, 0x1a, 0x1b, 0x1b, 0x1b, 0x1a,
+                                                 0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x13, 0x1a, 0x1b, 0x1b, 0x1b, 0x1a);
+      const __m256i highLookup = _mm256_setr_epi8(0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+                                                  0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10);
+      const __m256i rollLookup = _mm256_setr_epi8(0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0,
+                                                  0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0);
+
+      const __m256i highNibbles = _mm256_and_si256(_mm256_srli_epi32(in_text, 4), mask2F);
+      const __m256i lowNibbles = _mm256_and_si256(in_text, mask2F);
+      const __m256i low = _mm256_shuffle_epi8(lowLookup, lowNibbles);
+      const __m256i high = _mm256_shuffle_epi8(highLookup, highNibbles);
+      if (!_mm256_testz_si256(low, high)) { return false; }
+
+      const __m256i roll = _mm256_shuffle_epi8(rollLookup, _mm256_add_epi8(_mm256_cmpeq_epi8(in_text, mask2F), highNibbles));
+      const __m256i indices = _mm256_add_epi8(in_text, roll);
+      const __m256i pairs = _mm256_maddubs_epi16(indices, _mm256_set1_epi32(0x01400140));
+      const __m256i triples = _mm256_madd_epi16(pairs, _mm256_set1_epi32(0x00011000));
+      const __m256i packed = _mm256_shuffle_epi8(triples, _mm256_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1,
+                                                                           2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1));
+      out_bytes = _mm256_permutevar8x32_epi32(packed, _mm256_setr_epi32(0, 1, 2, 4, 5, 6, 3, 7));
+      return true;
+    }
+#endif
+  }
+
+  namespace hex
+  {
+    static constexpr char c_digits[] = "0123456789abcdef";
+    static constexpr uint8_t c_invalid = 0xff;
+
+    static constexpr std::array<uint8_t, 256> makeDecodeTable()
+    {
+      std::array<uint8_t, 256> table{};
+      for (size_t index = 0; index < table.size(); ++index) { table[index] = c_invalid; }
+      for (uint8_t index = 0; index < 10; ++index) { table['0' + index] = index; }
+      for (uint8_t index = 0; index < 6; ++index) { table['a' + index] = static_cast<uint8_t>(10 + index); table['A' + index] = static_cast<uint8_t>(10 + index); }
+      return table;
+    }
+
+    static constexpr std::array<uint8_t, 256> c_decodeTable = makeDecodeTable();
+
+#if defined(__SSSE3__)
+    // Converts 16 characters into 16 nibble values; returns false on an invalid character.
+    inline bool decodeNibbles(__m128i in_text, __m128i& out_nibbles)
+    {
+      const __m128i digits = _mm_sub_epi8(in_text, _mm_set1_epi8('0'));
+      const __m128i letters = _mm_sub_epi8(_mm_or_si128(in_text, _mm_set1_epi8(0x20)), _mm_set1_epi8('a'));
+      const __m128i isDigit = _mm_cmpeq_epi8(_mm_min_epu8(digits, _mm_set1_epi8(9)), digits);
+      const __m128i isLetter = _mm_cmpeq_epi8(_mm_min_epu8(letters, _mm_set1_epi8(5)), letters);
+      if (_mm_movemask_epi8(_mm_or_si128(isDigit, isLetter)) != 0xffff) { return false; }
+
+      out_nibbles = _mm_or_si128(_mm_and_si128(isDigit, digits), _mm_and_si128(isLetter, _mm_add_epi8(letters, _mm_set1_epi8(10))));
+      return true;
+    }
+#endif
+  }
+
+  constexpr size_t getBase64Size(size_t in_byteCount)
+  {
+    return (in_byteCount + 2) / 3 * 4;
+  }
+
+  constexpr size_t getHexSize(size_t in_byteCount)
+  {
+    return in_byteCount * 2;
+  }
+
+  // Writes getBase64Size(in_size) chars (no null terminator) and returns their count.
+  inline size_t encodeBase64Scalar(const uint8_t* in_data, size_t in_size, char* out_text)
+  {
+    size_t textSize = 0;
+    size_t index = 0;
+
+    for (; index + 3 <= in_size; index = index + 3)
+    {
+      const uint32_t triple = (uint32_t{ in_data[index] } << 16) | (uint32_t{ in_data[index + 1] } << 8) | in_data[index + 2];
+      out_text[textSize] = base64::c_alphabet[(triple >> 18) & 0x3f];
+      out_text[textSize + 1] = base64::c_alphabet[(triple >> 12) & 0x3f];
+      out_text[textSize + 2] = base64::c_alphabet[(triple >> 6) & 0x3f];
+      out_text[textSize + 3] = base64::c_alphabet[triple & 0x3f];
+      textSize = textSize + 4;
+    }
+
+    if (index < in_size)
+    {
+      const uint32_t triple = (uint32_t{ in_data[index] } << 16) | (index + 1 < in_size ? uint32_t{ in_data[index + 1] } << 8 : 0);
+      out_text[textSize] = base64::c_alphabet[(triple >> 18) & 0x3f];
+      out_text[textSize + 1] = base64::c_alphabet[(triple >> 12) & 0x3f];
+      out_text[textSize + 2] = index + 1 < in_size ? base64::c_alphabet[(triple >> 6) & 0x3f] : '=';
+      out_text[textSize + 3] = '=';
+      textSize = textSize + 4;
+    }
+
+    return textSize;
+  }
+
+  namespace base64
+  {
+    // Removes the padding from io_size. Padding is optional, but if present, it has to complete the last quad.
+    inline bool stripPadding(const char* in_text, size_t& io_size)
+    {
+      size_t paddingSize = 0;
+      while (paddingSize < 2 && paddingSize < io_size && in_text[io_size - 1 - paddingSize] == '=') { paddingSize = paddingSize + 1; }
+
+      io_size = io_size - paddingSize;
+      return io_size % 4 != 1 && (paddingSize == 0 || (io_size + paddingSize) % 4 == 0);
+    }
+
+    constexpr size_t getDecodedSize(size_t in_unpaddedSize)
+    {
+      return in_unpaddedSize / 4 * 3 + (in_unpaddedSize % 4 == 0 ? 0 : in_unpaddedSize % 4 - 1);
+    }
+
+    // Decodes text without padding, which stripPadding() has checked.
+    inline bool decodeUnpadded(const char* in_text, size_t in_size, uint8_t* out_data, size_t in_capacity, size_t& out_size)
+    {
+      const size_t size = getDecodedSize(in_size);
+      if (size > in_capacity) { return false; }
+
+      size_t byteCount = 0;
+      size_t index = 0;
+      for (; index + 4 <= in_size; index = index + 4)
+      {
+        const uint8_t* text = reinterpret_cast<const uint8_t*>(in_text + index);
+        const uint32_t a = c_decodeTable[text[0]];
+        const uint32_t b = c_decodeTable[text[1]];
+        const uint32_t c = c_decodeTable[text[2]];
+        const uint32_t d = c_decodeTable[text[3]];
+        if ((a | b | c | d) == c_invalid) { return false; }
+
+        const uint32_t triple = (a << 18) | (b << 12) | (c << 6) | d;
+        out_data[byteCount] = static_cast<uint8_t>(triple >> 16);
+        out_data[byteCount + 1] = static_cast<uint8_t>(triple >> 8);
+        out_data[byteCount + 2] = static_cast<uint8_t>(triple);
+        byteCount = byteCount + 3;
+      }
+
+      if (index < in_size)
+      {
+        uint32_t triple = 0;
+        for (size_t offset = 0; offset < 4; ++offset)
+        {
+          const uint32_t value = index + offset < in_size ? c_decodeTable[static_cast<uint8_t>(in_text[index + offset])] : 0;
+          if (value == c_invalid) { return false; }
+          triple = (triple << 6) | value;
+        }
+
+        out_data[byteCount] = static_cast<uint8_t>(triple >> 16);
+        if (in_size - index == 3) { out_data[byteCount + 1] = static_cast<uint8_t>(triple >> 8); }
+      }
+
+      out_size = size;
+      return true;
+    }
+  }
+
+  // Decodes in_text into out_data (at most in_capacity bytes). Returns false on invalid input or insufficient capacity.
+  inline bool decodeBase64Scalar(const char* in_text, size_t in_size, uint8_t* out_data, size_t in_capacity, size_t& out_size)
+  {
+    return base64::stripPadding(in_text, in_size) && base64::decodeUnpadded(in_text, in_size, out_data, in_capacity, out_size);
+  }
+
+  inline size_t encodeHexScalar(const uint8_t* in_data, size_t in_size, char* out_text)
+  {
+    for (size_t index = 0; index < in_size; ++index)
+    {
+      out_text[2 * index] = hex::c_digits[in_data[index] >> 4];
+      out_text[2 * index + 1] = hex::c_digits[in_data[index] & 0x0f];
+    }
+
+    return getHexSize(in_size);
+  }
+
+  inline bool decodeHexScalar(const char* in_text, size_t in_size, uint8_t* out_data, size_t in_capacity, size_t& out_size)
+  {
+    if (in_size % 2 != 0 || in_size / 2 > in_capacity) { return false; }
+
+    for (size_t index = 0; index < in_size / 2; ++index)
+    {
+      const uint8_t high = hex::c_decodeTable[static_cast<uint8_t>(in_text[2 * index])];
+      const uint8_t low = hex::c_decodeTable[static_cast<uint8_t>(in_text[2 * index + 1])];
+      if ((high | low) == hex::c_invalid) { return false; }
+
+      out_data[index] = static_cast<uint8_t>((high << 4) | low);
+    }
+
+    out_size = in_size / 2;
+    return true;
+  }
+
+  inline size_t encodeBase64(const uint8_t* in_data, size_t in_size, char* out_text)
+  {
+    size_t index = 0;
+    size_t textSize = 0;
+
+#if defined(__AVX2__)
+    // Each block reads 16 bytes from two places but only consumes 24 of them, so 4 bytes must remain readable.
+    for (; index + 28 <= in_size; index = index + 24)
+    {
+      const __m128i first = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in_data + index));
+      const __m128i second = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in_data + index + 12));
+      const __m256i text = base64::encodeBlock(_mm256_inserti128_si256(_mm256_castsi128_si256(first), second, 1));
+      _mm256_storeu_si256(reinterpret_cast<__m256i*>(out_text + textSize), text);
+      textSize = textSize + 32;
+    }
+#endif
+#if defined(__SSSE3__)
+    for (; index + 16 <= in_size; index = index + 12)
+    {
+      const __m128i text = base64::encodeBlock(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in_data + index)));
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(out_text + textSize), text);
+      textSize = textSize + 16;
+    }
+#endif
+
+    return textSize + encodeBase64Scalar(in_data + index, in_size - index, out_text + textSize);
+  }
+
+  inline bool decodeBase64(const char* in_text, size_t in_size, uint8_t* out_data, size_t in_capacity, size_t& out_size)
+  {
+    if (!base64::stripPadding(in_text, in_size) || base64::getDecodedSize(in_size) > in_capacity) { return false; }
+
+    size_t index = 0;
+    size_t byteCount = 0;
+
+#if defined(__AVX2__)
+    // A block stores 32 bytes but only produces 24; the surplus is overwritten by the following blocks.
+    for (; index + 48 <= in_size; index = index + 32)
+    {
+      __m256i bytes;
+      if (!base64::decodeBlock(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(in_text + index)), bytes)) { return false; }
+      _mm256_storeu_si256(reinterpret_cast<__m256i*>(out_data + byteCount), bytes);
+      byteCount = byteCount + 24;
+    }
+#endif
+#if defined(__SSSE3__)
+    for (; index + 24 <= in_size; index = index + 16)
+    {
+      __m128i bytes;
+      if (!base64::decodeBlock(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in_text + index)), bytes)) { return false; }
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(out_data + byteCount), bytes);
+      byteCount = byteCount + 12;
+    }
+#endif
+
+    size_t tailSize;
+    if (!base64::decodeUnpadded(in_text + index, in_size - index, out_data + byteCount, in_capacity - byteCount, tailSize)) { return false; }
+
+    out_size = byteCount + tailSize;
+    return true;
+  }
+
+  inline size_t encodeHex(const uint8_t* in_data, size_t in_size, char* out_text)
+  {
+    size_t index = 0;
+
+#if defined(__AVX2__)
+    const __m256i digits256 = _mm256_setr_epi8('0', '1', '2', '3', '4', '5', '6', '7', '8', '9', 'a', 'b', 'c', 'd', 'e', 'f',
+                                               '0', '1', '2', '3', '4', '5', '6', '7', '8', '9', 'a', 'b', 'c', 'd', 'e', 'f');
+    for (; index + 32 <= in_size; index = index + 32)
+    {
+      const __m256i bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in_data + index));
+      const __m256i high = _mm256_shuffle_epi8(digits256, _mm256_and_si256(_mm256_srli_epi16(bytes, 4), _mm256_set1_epi8(0x0f)));
+      const __m256i low = _mm256_shuffle_epi8(digits256, _mm256_and_si256(bytes, _mm256_set1_epi8(0x0f)));
+      const __m256i first = _mm256_unpacklo_epi8(high, low);
+      const __m256i second = _mm256_unpackhi_epi8(high, low);
+      _mm256_storeu_si256(reinterpret_cast<__m256i*>(out_text + 2 * index), _mm256_permute2x128_si256(first, second, 0x20));
+      _mm256_storeu_si256(reinterpret_cast<__m256i*>(out_text + 2 * index + 32), _mm256_permute2x128_si256(first, second, 0x31));
+    }
+#endif
+#if defined(__SSSE3__)
+    const __m128i digits = _mm_setr_epi8('0', '1', '2', '3', '4', '5', '6', '7', '8', '9', 'a', 'b', 'c', 'd', 'e', 'f');
+    for (; index + 16 <= in_size; index = index + 16)
+    {
+      const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in_data + index));
+      const __m128i high = _mm_shuffle_epi8(digits, _mm_and_si128(_mm_srli_epi16(bytes, 4), _mm_set1_epi8(0x0f)));
+      const __m128i low = _mm_shuffle_epi8(digits, _mm_and_si128(bytes, _mm_set1_epi8(0x0f)));
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(out_text + 2 * index), _mm_unpacklo_epi8(high, low));
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(out_text + 2 * index + 16), _mm_unpackhi_epi8(high, low));
+    }
+#endif
+
+    encodeHexScalar(in_data + index, in_size - index, out_text + 2 * index);
+    return getHexSize(in_size);
+  }
+
+  inline bool decodeHex(const char* in_text, size_t in_size, uint8_t* out_data, size_t in_capacity, size_t& out_size)
+  {
+    if (in_size % 2 != 0 || in_size / 2 > in_capacity) { return false; }
+
+    size_t index = 0;
+
+#if defined(__SSSE3__)
+    for (; index + 32 <= in_size; index = index + 32)
+    {
+      __m128i first;
+      __m128i second;
+      if (!hex::decodeNibbles(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in_text + index)), first)) { return false; }
+      if (!hex::decodeNibbles(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in_text + index + 16)), second)) { return false; }
+
+      const __m128i pairWeights = _mm_set1_epi16(0x0110);
+      const __m128i bytes = _mm_packus_epi16(_mm_maddubs_epi16(first, pairWeights), _mm_maddubs_epi16(second, pairWeights));
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(out_data + index / 2), bytes);
+    }
+#endif
+
+    size_t tailSize;
+    if (!decodeHexScalar(in_text + index, in_size - index, out_data + index / 2, in_capacity - index / 2, tailSize)) { return false; }
+
+    out_size = in_size / 2;
+    return true;
+  }
+
+  // Encodes the bytes written so far. Returns the number of chars written, 0 if in_textCapacity is too small.
+  template<size_t tc_bufferSize, typename CursorType>
+  size_t encodeBase64(const Serializer<tc_bufferSize, CursorType>& in_serializer, char* out_text, size_t in_textCapacity)
+  {
+    if (getBase64Size(in_serializer.getBytesWritten()) > in_textCapacity) { return 0; }
+
+    return encodeBase64(in_serializer.getBuffer(), in_serializer.getBytesWritten(), out_text);
+  }
+
+  template<size_t tc_bufferSize, typename CursorType>
+  size_t encodeHex(const Serializer<tc_bufferSize, CursorType>& in_serializer, char* out_text, size_t in_textCapacity)
+  {
+    if (getHexSize(in_serializer.getBytesWritten()) > in_textCapacity) { return 0; }
+
+    return encodeHex(in_serializer.getBuffer(), in_serializer.getBytesWritten(), out_text);
+  }
+
+  // Decodes into the buffer a Deserializer<tc_bufferSize> is then constructed on.
+  template<size_t tc_bufferSize>
+  bool decodeBase64(const char* in_text, size_t in_size, std::array<uint8_t, tc_bufferSize>& out_array, size_t& out_size)
+  {
+    return decodeBase64(in_text, in_size, out_array.data(), tc_bufferSize, out_size);
+  }
+
+  template<size_t tc_bufferSize>
+  bool decodeHex(const char* in_text, size_t in_size, std::array<uint8_t, tc_bufferSize>& out_array, size_t& out_size)
+  {
+    return decodeHex(in_text, in_size, out_array.data(), tc_bufferSize, out_size);
+  }
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// **** **** **** ****
+// NOTE: A minimal host benchmark harness. HALVOE_BENCHMARK registers a function that runs in_iterations
+//       iterations of the measured operation; every iteration handles getItemCount() items (e.g. values
+//       written) and getByteCount() bytes, so results are reported per item and as throughput.
+//       The runner (main.cpp) calibrates the iteration count, repeats the measurement and compares the
+//       median against the stored baselines.
+// **** **** **** ****
+
+namespace halvoe
+{
+  namespace bench
+  {
+    using BenchmarkFunction = void (*)(size_t in_iterations);
+
+    struct Benchmark
+    {
+      const char* name;
+      BenchmarkFunction function;
+      size_t itemsPerIteration;
+      size_t bytesPerIteration;
+    };
+
+    inline std::vector<Benchmark>& getBenchmarks()
+    {
+      static std::vector<Benchmark> benchmarks;
+      return benchmarks;
+    }
+
+    struct Registrar
+    {
+      Registrar(const char* in_name, BenchmarkFunction in_function, size_t in_itemsPerIteration, size_t in_bytesPerIteration)
+      {
+        getBenchmarks().push_back(Benchmark{ in_name, in_function, in_itemsPerIteration, in_bytesPerIteration });
+      }
+    };
+
+    // Keeps the compiler from dropping the computation of in_value.
+    template<typename Type>
+    inline void doNotOptimize(const Type& in_value)
+    {
+      asm volatile("" : : "r,m"(in_value) : "memory");
+    }
+
+    // Forces pending stores to memory, e.g. a serialized buffer nobody reads.
+    inline void clobberMemory()
+    {
+      asm volatile("" : : : "memory");
+    }
+  }
+}
+
+#define HALVOE_BENCHMARK_CONCAT_IMPL(in_a, in_b) in_a##in_b
+#define HALVOE_BENCHMARK_CONCAT(in_a, in_b) HALVOE_BENCHMARK_CONCAT_IMPL(in_a, in_b)
+
+// HALVOE_BENCHMARK("suite/name", items per iteration, bytes per iteration) { body using in_iterations }
+#define HALVOE_BENCHMARK(in_name, in_items, in_bytes) \
+  static void HALVOE_BENCHMARK_CONCAT(benchmark, __LINE__)(size_t in_iterations); \
+  static const ::halvoe::bench::Registrar HALVOE_BENCHMARK_CONCAT(registrar, __LINE__)(in_name, &HALVOE_BENCHMARK_CONCAT(benchmark, __LINE__), in_items, in_bytes); \
+  static void HALVOE_BENCHMARK_CONCAT(benchmark, __LINE__)(size_t in_iterations)
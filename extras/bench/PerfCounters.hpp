@@ -0,0 +1,167 @@
+#pragma once
+
+#include <array>
+#include <cerrno>
+#include <cstdint>
+#include <utility>
+
+#if defined(__linux__)
+#include <cstring>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+// **** **** **** ****
+// NOTE: PerfCounters reads hardware counters of the calling thread through Linux perf_event_open
+//       (user space only): cycles, instructions, branch misses, L1D read misses and LLC misses.
+//       Every counter is opened on its own, so a counter the CPU, VM or perf_event_paranoid setting
+//       does not allow is reported as unavailable while the others still work. Multiplexed counts
+//       are scaled by time enabled / time running. On other systems no counter is available.
+// **** **** **** ****
+
+namespace halvoe
+{
+  namespace bench
+  {
+    enum class Counter : size_t
+    {
+      cycles = 0,
+      instructions,
+      branchMisses,
+      l1dMisses,
+      llcMisses,
+      count
+    };
+
+    constexpr size_t c_counterCount = static_cast<size_t>(Counter::count);
+
+    struct CounterValues
+    {
+      std::array<double, c_counterCount> values{};
+      std::array<bool, c_counterCount> isAvailable{};
+
+      double get(Counter in_counter) const
+      {
+        return values[static_cast<size_t>(in_counter)];
+      }
+
+      bool has(Counter in_counter) const
+      {
+        return isAvailable[static_cast<size_t>(in_counter)];
+      }
+    };
+
+    class PerfCounters
+    {
+      private:
+        std::array<int, c_counterCount> m_descriptors;
+        int m_lastError = 0;
+
+#if defined(__linux__)
+        static int open(uint32_t in_type, uint64_t in_config)
+        {
+          perf_event_attr attribute;
+          std::memset(&attribute, 0, sizeof(attribute));
+          attribute.size = sizeof(attribute);
+          attribute.type = in_type;
+          attribute.config = in_config;
+          attribute.disabled = 1;
+          attribute.exclude_kernel = 1;
+          attribute.exclude_hv = 1;
+          attribute.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+          return static_cast<int>(syscall(SYS_perf_event_open, &attribute, 0, -1, -1, 0));
+        }
+#endif
+
+      public:
+        PerfCounters()
+        {
+          m_descriptors.fill(-1);
+
+#if defined(__linux__)
+          constexpr uint64_t c_l1dReadMiss = PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+          const std::array<std::pair<uint32_t, uint64_t>, c_counterCount> events = {{
+            { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES },
+            { PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS },
+            { PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES },
+            { PERF_TYPE_HW_CACHE, c_l1dReadMiss },
+            { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES }
+          }};
+
+          for (size_t index = 0; index < c_counterCount; ++index)
+          {
+            m_descriptors[index] = open(events[index].first, events[index].second);
+            if (m_descriptors[index] < 0) { m_lastError = errno; }
+          }
+#else
+          m_lastError = ENOSYS;
+#endif
+        }
+
+        PerfCounters(const PerfCounters&) = delete;
+        PerfCounters& operator=(const PerfCounters&) = delete;
+
+        ~PerfCounters()
+        {
+#if defined(__linux__)
+          for (int descriptor : m_descriptors)
+          {
+            if (descriptor >= 0) { close(descriptor); }
+          }
+#endif
+        }
+
+        bool isAnyAvailable() const
+        {
+          for (int descriptor : m_descriptors)
+          {
+            if (descriptor >= 0) { return true; }
+          }
+          return false;
+        }
+
+        // errno of the last counter that could not be opened, 0 if all are available.
+        int getLastError() const
+        {
+          return m_lastError;
+        }
+
+        void start()
+        {
+#if defined(__linux__)
+          for (int descriptor : m_descriptors)
+          {
+            if (descriptor < 0) { continue; }
+            ioctl(descriptor, PERF_EVENT_IOC_RESET, 0);
+            ioctl(descriptor, PERF_EVENT_IOC_ENABLE, 0);
+          }
+#endif
+        }
+
+        CounterValues stop()
+        {
+          CounterValues result;
+
+#if defined(__linux__)
+          for (int descriptor : m_descriptors)
+          {
+            if (descriptor >= 0) { ioctl(descriptor, PERF_EVENT_IOC_DISABLE, 0); }
+          }
+
+          for (size_t index = 0; index < c_counterCount; ++index)
+          {
+            uint64_t data[3];
+            if (m_descriptors[index] < 0 || read(m_descriptors[index], data, sizeof(data)) != static_cast<ssize_t>(sizeof(data)) || data[2] == 0) { continue; }
+
+            result.values[index] = static_cast<double>(data[0]) * static_cast<double>(data[1]) / static_cast<double>(data[2]);
+            result.isAvailable[index] = true;
+          }
+#endif
+
+          return result;
+        }
+    };
+  }
+}
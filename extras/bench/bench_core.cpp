@@ -0,0 +1,165 @@
+#include <array>
+
+#include "BasicSerializer.hpp"
+#include "Benchmark.hpp"
+
+// Write, read, string and enum suites of the native Serializer/Deserializer.
+// Every iteration handles one full buffer of c_valueCount values (or c_stringCount strings).
+
+using namespace halvoe;
+
+namespace
+{
+  constexpr size_t c_valueCount = 256;
+  constexpr size_t c_bufferSize = 4096;
+  constexpr size_t c_stringCount = 64;
+  constexpr size_t c_stringSize = 16;
+
+  enum class Mode : uint8_t
+  {
+    idle = 0,
+    running,
+    stopped
+  };
+
+  const char c_string[c_stringSize + 1] = "sixteen chars ok";
+
+  std::array<uint8_t, c_bufferSize> g_buffer{};
+
+  template<typename Type>
+  void fillBuffer()
+  {
+    Serializer<c_bufferSize> serializer(g_buffer);
+    for (size_t index = 0; index < c_valueCount; ++index) { serializer.write<Type>(static_cast<Type>(index)); }
+  }
+
+  void fillStrings()
+  {
+    Serializer<c_bufferSize> serializer(g_buffer);
+    for (size_t index = 0; index < c_stringCount; ++index) { serializer.write(c_string, static_cast<uint8_t>(c_stringSize)); }
+  }
+
+  template<typename Type>
+  void writeValues(size_t in_iterations)
+  {
+    for (size_t iteration = 0; iteration < in_iterations; ++iteration)
+    {
+      Serializer<c_bufferSize> serializer(g_buffer);
+      for (size_t index = 0; index < c_valueCount; ++index) { serializer.write<Type>(static_cast<Type>(index + iteration)); }
+      bench::clobberMemory();
+    }
+  }
+
+  template<typename Type>
+  void readValues(size_t in_iterations)
+  {
+    fillBuffer<Type>();
+    for (size_t iteration = 0; iteration < in_iterations; ++iteration)
+    {
+      Deserializer<c_bufferSize> deserializer(g_buffer);
+      Type sum = 0;
+      for (size_t index = 0; index < c_valueCount; ++index) { sum = sum + deserializer.read<Type>(); }
+      bench::doNotOptimize(sum);
+      bench::clobberMemory();
+    }
+  }
+}
+
+HALVOE_BENCHMARK("core/write<uint32_t>", c_valueCount, c_valueCount * sizeof(uint32_t)) { writeValues<uint32_t>(in_iterations); }
+HALVOE_BENCHMARK("core/write<double>", c_valueCount, c_valueCount * sizeof(double)) { writeValues<double>(in_iterations); }
+HALVOE_BENCHMARK("core/read<uint32_t>", c_valueCount, c_valueCount * sizeof(uint32_t)) { readValues<uint32_t>(in_iterations); }
+HALVOE_BENCHMARK("core/read<float>", c_valueCount, c_valueCount * sizeof(float)) { readValues<float>(in_iterations); }
+
+HALVOE_BENCHMARK("core/writeArray<float>", c_valueCount, c_valueCount * sizeof(float))
+{
+  static std::array<float, c_valueCount> values{};
+  for (size_t iteration = 0; iteration < in_iterations; ++iteration)
+  {
+    Serializer<c_bufferSize> serializer(g_buffer);
+    bench::doNotOptimize(serializer.writeArray(values.data(), values.size()));
+    bench::clobberMemory();
+  }
+}
+
+HALVOE_BENCHMARK("core/readArray<float>", c_valueCount, c_valueCount * sizeof(float))
+{
+  static std::array<float, c_valueCount> values{};
+  {
+    Serializer<c_bufferSize> serializer(g_buffer);
+    serializer.writeArray(values.data(), values.size());
+  }
+  for (size_t iteration = 0; iteration < in_iterations; ++iteration)
+  {
+    Deserializer<c_bufferSize> deserializer(g_buffer);
+    bench::doNotOptimize(deserializer.readArray(values.data(), values.size()));
+    bench::clobberMemory();
+  }
+}
+
+HALVOE_BENCHMARK("enum/writeEnum", c_valueCount, c_valueCount * sizeof(Mode))
+{
+  for (size_t iteration = 0; iteration < in_iterations; ++iteration)
+  {
+    Serializer<c_bufferSize> serializer(g_buffer);
+    for (size_t index = 0; index < c_valueCount; ++index) { serializer.writeEnum(static_cast<Mode>((index + iteration) % 3)); }
+    bench::clobberMemory();
+  }
+}
+
+HALVOE_BENCHMARK("enum/readEnum", c_valueCount, c_valueCount * sizeof(Mode))
+{
+  {
+    Serializer<c_bufferSize> serializer(g_buffer);
+    for (size_t index = 0; index < c_valueCount; ++index) { serializer.writeEnum(static_cast<Mode>(index % 3)); }
+  }
+  for (size_t iteration = 0; iteration < in_iterations; ++iteration)
+  {
+    Deserializer<c_bufferSize> deserializer(g_buffer);
+    size_t runningCount = 0;
+    for (size_t index = 0; index < c_valueCount; ++index) { runningCount = runningCount + (deserializer.readEnum<Mode>() == Mode::running); }
+    bench::doNotOptimize(runningCount);
+    bench::clobberMemory();
+  }
+}
+
+HALVOE_BENCHMARK("string/write", c_stringCount, c_stringCount * c_stringSize)
+{
+  for (size_t iteration = 0; iteration < in_iterations; ++iteration)
+  {
+    Serializer<c_bufferSize> serializer(g_buffer);
+    for (size_t index = 0; index < c_stringCount; ++index) { serializer.write(c_string, static_cast<uint8_t>(c_stringSize)); }
+    bench::clobberMemory();
+  }
+}
+
+HALVOE_BENCHMARK("string/view", c_stringCount, c_stringCount * c_stringSize)
+{
+  fillStrings();
+  for (size_t iteration = 0; iteration < in_iterations; ++iteration)
+  {
+    Deserializer<c_bufferSize> deserializer(g_buffer);
+    size_t totalSize = 0;
+    for (size_t index = 0; index < c_stringCount; ++index)
+    {
+      uint8_t size = 0;
+      bench::doNotOptimize(deserializer.view(size));
+      totalSize = totalSize + size;
+    }
+    bench::doNotOptimize(totalSize);
+  }
+}
+
+HALVOE_BENCHMARK("string/read (unique_ptr)", c_stringCount, c_stringCount * c_stringSize)
+{
+  fillStrings();
+  for (size_t iteration = 0; iteration < in_iterations; ++iteration)
+  {
+    Deserializer<c_bufferSize> deserializer(g_buffer);
+    for (size_t index = 0; index < c_stringCount; ++index)
+    {
+      uint8_t size = 0;
+      const std::unique_ptr<const char[]> string = deserializer.read(static_cast<uint8_t>(c_stringSize), size);
+      bench::doNotOptimize(string.get());
+    }
+  }
+}
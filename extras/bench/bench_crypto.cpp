@@ -0,0 +1,41 @@
+#include <array>
+
+#include "ChaCha20Poly1305.hpp"
+#include "SipHash.hpp"
+#include "Benchmark.hpp"
+
+// Frame authentication: SipHash-2-4 tags and ChaCha20-Poly1305 sealing on small and large frames.
+
+using namespace halvoe;
+
+namespace
+{
+  std::array<uint8_t, 1024 + c_chaChaTagSize> g_frame{};
+  const SipHashKey c_sipHashKey = {{ 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15 }};
+  const ChaChaKey c_chaChaKey{};
+  const ChaChaNonce c_chaChaNonce{};
+
+  void getSipHash(size_t in_iterations, size_t in_size)
+  {
+    for (size_t iteration = 0; iteration < in_iterations; ++iteration)
+    {
+      g_frame[0] = static_cast<uint8_t>(iteration);
+      bench::doNotOptimize(getSipHash24(c_sipHashKey, g_frame.data(), in_size));
+    }
+  }
+
+  void seal(size_t in_iterations, size_t in_size)
+  {
+    for (size_t iteration = 0; iteration < in_iterations; ++iteration)
+    {
+      bench::doNotOptimize(sealChaCha20Poly1305(g_frame.data(), in_size, g_frame.size(), c_chaChaKey, c_chaChaNonce));
+      bench::clobberMemory();
+    }
+  }
+}
+
+HALVOE_BENCHMARK("mac/siphash 16B", 1, 16) { getSipHash(in_iterations, 16); }
+HALVOE_BENCHMARK("mac/siphash 64B", 1, 64) { getSipHash(in_iterations, 64); }
+HALVOE_BENCHMARK("mac/siphash 1024B", 1, 1024) { getSipHash(in_iterations, 1024); }
+HALVOE_BENCHMARK("aead/chacha20poly1305 seal 64B", 1, 64) { seal(in_iterations, 64); }
+HALVOE_BENCHMARK("aead/chacha20poly1305 seal 1024B", 1, 1024) { seal(in_iterations, 1024); }
@@ -0,0 +1,155 @@
+#include <array>
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+#include "JsonConverter.hpp"
+#include "JsonWriter.hpp"
+#include "Benchmark.hpp"
+
+// JsonConverter (JSON text to native frames) and writeJson (native frames to JSON text).
+// Every iteration handles one record (the stream benchmark 64 records); throughput is reported in JSON bytes.
+// "json/snprintf record" is the printf based dumper writeJson replaces, for the speedup of writeJson.
+
+using namespace halvoe;
+
+namespace
+{
+  const FieldDescriptor c_fields[] = { { "id", FieldType::uint16 }, { "speed", FieldType::float32 }, { "on", FieldType::boolean },
+                                       { "name", FieldType::string8 }, { "t", FieldType::int64 } };
+  constexpr size_t c_fieldCount = sizeof(c_fields) / sizeof(c_fields[0]);
+
+  const char c_record[] = "{\"id\": 513, \"speed\": 12.25, \"on\": false, \"name\": \"forward thruster\", \"t\": 1700000000123}\n";
+  constexpr size_t c_recordSize = sizeof(c_record) - 1;
+
+  // A newline delimited stream of 64 records with varying values, as a test rig sends them.
+  constexpr size_t c_streamRecordCount = 64;
+
+  std::string makeStream()
+  {
+    const char* const names[] = { "forward thruster", "aft thruster", "ballast pump \\\"B\\\"", "rudder" };
+    std::string stream;
+    for (size_t index = 0; index < c_streamRecordCount; ++index)
+    {
+      char record[160];
+      const int size = std::snprintf(record, sizeof(record), "{\"id\": %zu, \"speed\": %.3f, \"on\": %s, \"name\": \"%s\", \"t\": %llu}\n",
+                                     500 + index * 37, -40.0 + static_cast<double>(index) * 1.625, index % 3 == 0 ? "true" : "false", names[index % 4],
+                                     1700000000000ull + index * 20);
+      stream.append(record, static_cast<size_t>(size));
+    }
+    return stream;
+  }
+
+  const std::string c_stream = makeStream();
+
+  // The snprintf dumper: one call per field, floats with enough digits to round trip, strings unescaped.
+  size_t dumpWithSnprintf(Deserializer<64>& io_deserializer, const FieldDescriptor* in_fields, size_t in_fieldCount, char* out_json, size_t in_size)
+  {
+    size_t cursor = 0;
+    for (size_t index = 0; index < in_fieldCount && cursor < in_size; ++index)
+    {
+      char* const out = out_json + cursor;
+      const size_t left = in_size - cursor;
+      const char* const separator = index == 0 ? "{" : ",";
+      const char* const name = in_fields[index].name;
+      int written = 0;
+
+      switch (in_fields[index].type)
+      {
+        case FieldType::boolean: written = std::snprintf(out, left, "%s\"%s\":%s", separator, name, io_deserializer.read<bool>() ? "true" : "false"); break;
+        case FieldType::int8: written = std::snprintf(out, left, "%s\"%s\":%d", separator, name, io_deserializer.read<int8_t>()); break;
+        case FieldType::uint8: written = std::snprintf(out, left, "%s\"%s\":%u", separator, name, io_deserializer.read<uint8_t>()); break;
+        case FieldType::int16: written = std::snprintf(out, left, "%s\"%s\":%d", separator, name, io_deserializer.read<int16_t>()); break;
+        case FieldType::uint16: written = std::snprintf(out, left, "%s\"%s\":%u", separator, name, io_deserializer.read<uint16_t>()); break;
+        case FieldType::int32: written = std::snprintf(out, left, "%s\"%s\":%" PRId32, separator, name, io_deserializer.read<int32_t>()); break;
+        case FieldType::uint32: written = std::snprintf(out, left, "%s\"%s\":%" PRIu32, separator, name, io_deserializer.read<uint32_t>()); break;
+        case FieldType::int64: written = std::snprintf(out, left, "%s\"%s\":%" PRId64, separator, name, io_deserializer.read<int64_t>()); break;
+        case FieldType::uint64: written = std::snprintf(out, left, "%s\"%s\":%" PRIu64, separator, name, io_deserializer.read<uint64_t>()); break;
+        case FieldType::float32: written = std::snprintf(out, left, "%s\"%s\":%.9g", separator, name, static_cast<double>(io_deserializer.read<float>())); break;
+        case FieldType::float64: written = std::snprintf(out, left, "%s\"%s\":%.17g", separator, name, io_deserializer.read<double>()); break;
+        case FieldType::string8:
+        {
+          uint8_t size = 0;
+          const char* string = io_deserializer.view(size);
+          written = std::snprintf(out, left, "%s\"%s\":\"%.*s\"", separator, name, static_cast<int>(size), string);
+          break;
+        }
+        default: return 0;
+      }
+
+      if (written < 0) { return 0; }
+      cursor = cursor + static_cast<size_t>(written);
+    }
+
+    if (cursor + 1 >= in_size) { return 0; }
+    out_json[cursor] = '}';
+    return cursor + 1;
+  }
+}
+
+HALVOE_BENCHMARK("json/convert record", 1, c_recordSize)
+{
+  JsonConverter converter(c_fields, c_fieldCount);
+  std::array<uint8_t, 64> buffer;
+  for (size_t iteration = 0; iteration < in_iterations; ++iteration)
+  {
+    Serializer<64> serializer(buffer);
+    bench::doNotOptimize(converter.convert(c_record, c_recordSize, serializer));
+    bench::clobberMemory();
+  }
+}
+
+HALVOE_BENCHMARK("json/convert stream", c_streamRecordCount, c_stream.size())
+{
+  JsonConverter converter(c_fields, c_fieldCount);
+  std::array<uint8_t, 64> buffer;
+  for (size_t iteration = 0; iteration < in_iterations; ++iteration)
+  {
+    const char* json = c_stream.data();
+    size_t size = c_stream.size();
+    while (size > 0)
+    {
+      Serializer<64> serializer(buffer);
+      const size_t consumed = converter.convert(json, size, serializer);
+      if (consumed == 0) { break; }
+      bench::doNotOptimize(buffer);
+      json = json + consumed;
+      size = size - consumed;
+    }
+    bench::clobberMemory();
+  }
+}
+
+HALVOE_BENCHMARK("json/writeJson record", 1, c_recordSize)
+{
+  JsonConverter converter(c_fields, c_fieldCount);
+  std::array<uint8_t, 64> buffer;
+  Serializer<64> serializer(buffer);
+  converter.convert(c_record, c_recordSize, serializer);
+
+  std::array<char, 256> json;
+  for (size_t iteration = 0; iteration < in_iterations; ++iteration)
+  {
+    Deserializer<64> deserializer(buffer);
+    JsonWriter<256> writer(json);
+    bench::doNotOptimize(writeJson(deserializer, c_fields, c_fieldCount, writer));
+    bench::clobberMemory();
+  }
+}
+
+HALVOE_BENCHMARK("json/snprintf record", 1, c_recordSize)
+{
+  JsonConverter converter(c_fields, c_fieldCount);
+  std::array<uint8_t, 64> buffer;
+  Serializer<64> serializer(buffer);
+  converter.convert(c_record, c_recordSize, serializer);
+
+  std::array<char, 256> json;
+  for (size_t iteration = 0; iteration < in_iterations; ++iteration)
+  {
+    Deserializer<64> deserializer(buffer);
+    bench::doNotOptimize(dumpWithSnprintf(deserializer, c_fields, c_fieldCount, json.data(), json.size()));
+    bench::clobberMemory();
+  }
+}
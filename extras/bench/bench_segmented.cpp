@@ -0,0 +1,90 @@
+#include <array>
+
+#include "SegmentedBuffer.hpp"
+#include "Benchmark.hpp"
+
+// SegmentedDeserializer against Deserializer over the same 1024 uint32_t values, with one segment,
+// 64 byte segments (values never straddle) and 31/33 byte segments (values straddle often).
+
+using namespace halvoe;
+
+namespace
+{
+  constexpr size_t c_valueCount = 1024;
+  constexpr size_t c_bufferSize = c_valueCount * (c_typeTagSize + sizeof(uint32_t));
+  constexpr size_t c_maxSegmentCount = c_bufferSize / 31 + 1;
+
+  struct SegmentedData
+  {
+    std::array<uint8_t, c_bufferSize> buffer{};
+    BufferSegment single{ buffer.data(), c_bufferSize };
+    std::array<BufferSegment, c_bufferSize / 64 + 1> aligned{};
+    size_t alignedCount = 0;
+    std::array<BufferSegment, c_maxSegmentCount> odd{};
+    size_t oddCount = 0;
+
+    SegmentedData()
+    {
+      Serializer<c_bufferSize> serializer(buffer);
+      for (size_t index = 0; index < c_valueCount; ++index) { serializer.write<uint32_t>(static_cast<uint32_t>(index)); }
+
+      for (size_t offset = 0; offset < c_bufferSize; offset = offset + 64)
+      {
+        aligned[alignedCount++] = BufferSegment{ buffer.data() + offset, c_bufferSize - offset < 64 ? c_bufferSize - offset : 64 };
+      }
+      for (size_t offset = 0; offset < c_bufferSize;)
+      {
+        size_t size = oddCount % 2 == 0 ? 31 : 33;
+        if (size > c_bufferSize - offset) { size = c_bufferSize - offset; }
+        odd[oddCount++] = BufferSegment{ buffer.data() + offset, size };
+        offset = offset + size;
+      }
+    }
+  };
+
+  SegmentedData& getSegmentedData()
+  {
+    static SegmentedData segmentedData;
+    return segmentedData;
+  }
+
+  void readSegmented(size_t in_iterations, const BufferSegment* in_segments, size_t in_segmentCount)
+  {
+    for (size_t iteration = 0; iteration < in_iterations; ++iteration)
+    {
+      SegmentedDeserializer deserializer(in_segments, in_segmentCount);
+      uint32_t sum = 0;
+      for (size_t index = 0; index < c_valueCount; ++index) { sum = sum + deserializer.read<uint32_t>(); }
+      bench::doNotOptimize(sum);
+    }
+  }
+}
+
+HALVOE_BENCHMARK("segmented/Deserializer baseline", c_valueCount, c_valueCount * sizeof(uint32_t))
+{
+  SegmentedData& data = getSegmentedData();
+  for (size_t iteration = 0; iteration < in_iterations; ++iteration)
+  {
+    Deserializer<c_bufferSize> deserializer(data.buffer);
+    uint32_t sum = 0;
+    for (size_t index = 0; index < c_valueCount; ++index) { sum = sum + deserializer.read<uint32_t>(); }
+    bench::doNotOptimize(sum);
+  }
+}
+
+HALVOE_BENCHMARK("segmented/read 1 segment", c_valueCount, c_valueCount * sizeof(uint32_t))
+{
+  readSegmented(in_iterations, &getSegmentedData().single, 1);
+}
+
+HALVOE_BENCHMARK("segmented/read 64B segments", c_valueCount, c_valueCount * sizeof(uint32_t))
+{
+  SegmentedData& data = getSegmentedData();
+  readSegmented(in_iterations, data.aligned.data(), data.alignedCount);
+}
+
+HALVOE_BENCHMARK("segmented/read 31-33B segments", c_valueCount, c_valueCount * sizeof(uint32_t))
+{
+  SegmentedData& data = getSegmentedData();
+  readSegmented(in_iterations, data.odd.data(), data.oddCount);
+}
@@ -0,0 +1,89 @@
+#include <array>
+
+#include "TextEncoding.hpp"
+#include "Benchmark.hpp"
+
+// Base64 and hex encoding of a 64 KiB buffer, with the dispatching (SIMD, when built with -mssse3/-mavx2)
+// and the scalar functions. Throughput is reported in binary bytes.
+
+using namespace halvoe;
+
+namespace
+{
+  constexpr size_t c_dataSize = size_t{ 1 } << 16;
+
+  // Static, cache line aligned arrays, so the buffer layout does not depend on earlier heap use.
+  struct TextData
+  {
+    alignas(64) std::array<uint8_t, c_dataSize> data;
+    alignas(64) std::array<uint8_t, c_dataSize> decoded;
+    alignas(64) std::array<char, getBase64Size(c_dataSize)> base64;
+    alignas(64) std::array<char, getHexSize(c_dataSize)> hex;
+
+    TextData()
+    {
+      uint32_t state = 1;
+      for (uint8_t& byte : data)
+      {
+        state = state * 1664525 + 1013904223;
+        byte = static_cast<uint8_t>(state >> 24);
+      }
+      encodeBase64Scalar(data.data(), data.size(), base64.data());
+      encodeHexScalar(data.data(), data.size(), hex.data());
+    }
+  };
+
+  TextData& getTextData()
+  {
+    static TextData textData;
+    return textData;
+  }
+}
+
+HALVOE_BENCHMARK("text/encodeBase64", 1, c_dataSize)
+{
+  TextData& text = getTextData();
+  for (size_t iteration = 0; iteration < in_iterations; ++iteration) { bench::doNotOptimize(encodeBase64(text.data.data(), c_dataSize, text.base64.data())); }
+}
+
+HALVOE_BENCHMARK("text/encodeBase64Scalar", 1, c_dataSize)
+{
+  TextData& text = getTextData();
+  for (size_t iteration = 0; iteration < in_iterations; ++iteration) { bench::doNotOptimize(encodeBase64Scalar(text.data.data(), c_dataSize, text.base64.data())); }
+}
+
+HALVOE_BENCHMARK("text/decodeBase64", 1, c_dataSize)
+{
+  TextData& text = getTextData();
+  size_t size;
+  for (size_t iteration = 0; iteration < in_iterations; ++iteration)
+  {
+    bench::doNotOptimize(decodeBase64(text.base64.data(), text.base64.size(), text.decoded.data(), c_dataSize, size));
+  }
+}
+
+HALVOE_BENCHMARK("text/decodeBase64Scalar", 1, c_dataSize)
+{
+  TextData& text = getTextData();
+  size_t size;
+  for (size_t iteration = 0; iteration < in_iterations; ++iteration)
+  {
+    bench::doNotOptimize(decodeBase64Scalar(text.base64.data(), text.base64.size(), text.decoded.data(), c_dataSize, size));
+  }
+}
+
+HALVOE_BENCHMARK("text/encodeHex", 1, c_dataSize)
+{
+  TextData& text = getTextData();
+  for (size_t iteration = 0; iteration < in_iterations; ++iteration) { bench::doNotOptimize(encodeHex(text.data.data(), c_dataSize, text.hex.data())); }
+}
+
+HALVOE_BENCHMARK("text/decodeHex", 1, c_dataSize)
+{
+  TextData& text = getTextData();
+  size_t size;
+  for (size_t iteration = 0; iteration < in_iterations; ++iteration)
+  {
+    bench::doNotOptimize(decodeHex(text.hex.data(), text.hex.size(), text.decoded.data(), c_dataSize, size));
+  }
+}
@@ -0,0 +1,72 @@
+#!/bin/sh
+# Runs the Cortex-M7 benchmark image (see main.cpp) on QEMU's mps2-an500 model with -icount shift=0 and
+# reports the instructions per item of every benchmark, optionally against a baseline file in the
+# layout of ../baselines.json.
+#
+#   ./check_instructions.sh run ELF
+#   ./check_instructions.sh check ELF BASELINE [THRESHOLD]   fail if a benchmark needs more than THRESHOLD
+#                                                             (default 1) percent more instructions
+#   ./check_instructions.sh baseline ELF BASELINE            write the counts as new baseline
+#
+# The counts do not change from run to run, so any change beyond the threshold comes from the code
+# (or the compiler): refresh the baseline together with the change that justifies it.
+
+set -e
+
+QEMU=${QEMU:-qemu-system-arm}
+MODE=$1
+ELF=$2
+BASELINE=$3
+THRESHOLD=${4:-1}
+
+case $MODE in
+  run) ;;
+  check|baseline)
+    if [ -z "$BASELINE" ]; then
+      echo "usage: $0 $MODE ELF BASELINE" >&2
+      exit 2
+    fi
+    ;;
+  *)
+    echo "usage: $0 run|check|baseline ELF [BASELINE [THRESHOLD]]" >&2
+    exit 2
+    ;;
+esac
+
+OUTPUT=$(dirname "$ELF")/instructions.txt
+$QEMU -M mps2-an500 -nographic -monitor none -serial none -semihosting-config enable=on,target=native -icount shift=0 \
+      -kernel "$ELF" > "$OUTPUT"
+
+case $MODE in
+  run)
+    awk -F '\t' 'BEGIN { printf "%-40s %12s\n", "benchmark", "instr/item" } { printf "%-40s %12s\n", $1, $2 }' "$OUTPUT"
+    ;;
+  baseline)
+    {
+      echo '{'
+      echo '  "unit": "instructions per item",'
+      echo '  "benchmarks": {'
+      awk -F '\t' 'NR > 1 { print line "," } { line = sprintf("    \"%s\": { \"instructions\": %s }", $1, $2) } END { if (NR > 0) { print line } }' "$OUTPUT"
+      echo '  }'
+      echo '}'
+    } > "$BASELINE"
+    echo "check_instructions: wrote $(wc -l < "$OUTPUT") benchmarks to $BASELINE"
+    ;;
+  check)
+    sed -n 's/^ *"\([^"]*\)": { "instructions": \([0-9.]*\) },*$/\1\t\2/p' "$BASELINE" |
+      awk -F '\t' -v threshold="$THRESHOLD" '
+        BEGIN { printf "%-40s %12s %12s %8s  %s\n", "benchmark", "instr/item", "baseline", "delta", "verdict" }
+        FILENAME == "-" { baselines[$1] = $2; next }
+        {
+          if (!($1 in baselines)) {
+            printf "%-40s %12s %12s %8s  new\n", $1, $2, "-", "-"
+            next
+          }
+          delta = baselines[$1] > 0 ? ($2 / baselines[$1] - 1) * 100 : 0
+          verdict = delta > threshold ? "REGRESSED" : delta < -threshold ? "improved" : "ok"
+          if (verdict == "REGRESSED") { failed = 1 }
+          printf "%-40s %12s %12s %+7.2f%%  %s\n", $1, $2, baselines[$1], delta, verdict
+        }
+        END { exit failed }' - "$OUTPUT"
+    ;;
+esac
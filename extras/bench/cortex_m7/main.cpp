@@ -0,0 +1,72 @@
+#include <cstdint>
+#include <cstdio>
+
+#include "Benchmark.hpp"
+
+// **** **** **** ****
+// NOTE: Runs the registered benchmarks on the Cortex-M7 of QEMU's mps2-an500 model and prints the
+//       instructions per item, one "name<TAB>count" line per benchmark, through semihosting.
+//       QEMU does not model pipeline timing, but with -icount shift=0 every executed instruction advances
+//       the virtual clock by exactly 1 ns, and SysTick counts the 25 MHz system clock of the board on that
+//       clock: one tick is 40 instructions, and the counts are the same in every run. Every benchmark
+//       doubles its iterations until a measurement spans c_minTicks (1M instructions), so the tick
+//       granularity is below 0.01%. check_instructions.sh compares the output against a baseline.
+// **** **** **** ****
+
+namespace
+{
+  constexpr uint32_t c_systemClockHz = 25000000;
+  constexpr uint32_t c_instructionsPerTick = 1000000000 / c_systemClockHz;
+  constexpr uint32_t c_minTicks = 25000;
+  constexpr uint32_t c_tickMask = 0x00ffffff; // SysTick is a 24 bit down counter
+
+  constexpr uintptr_t c_sysTickControl = 0xe000e010;
+  constexpr uintptr_t c_sysTickReload = 0xe000e014;
+  constexpr uintptr_t c_sysTickCurrent = 0xe000e018;
+
+  volatile uint32_t& getRegister(uintptr_t in_address)
+  {
+    return *reinterpret_cast<volatile uint32_t*>(in_address);
+  }
+
+  void startSysTick()
+  {
+    getRegister(c_sysTickReload) = c_tickMask;
+    getRegister(c_sysTickCurrent) = 0;
+    getRegister(c_sysTickControl) = 0x5; // enabled, processor clock, no interrupt
+  }
+
+  // The measurements stay far below 2^24 ticks, so the counter wraps at most once.
+  uint32_t measure(const halvoe::bench::Benchmark& in_benchmark, size_t in_iterations)
+  {
+    const uint32_t start = getRegister(c_sysTickCurrent);
+    in_benchmark.function(in_iterations);
+    const uint32_t end = getRegister(c_sysTickCurrent);
+    return (start - end) & c_tickMask;
+  }
+}
+
+int main()
+{
+  startSysTick();
+
+  for (const halvoe::bench::Benchmark& benchmark : halvoe::bench::getBenchmarks())
+  {
+    benchmark.function(1); // first use of function local statics and lazily filled buffers
+
+    size_t iterations = 1;
+    uint32_t ticks = measure(benchmark, iterations);
+    while (ticks < c_minTicks)
+    {
+      iterations = iterations * 2;
+      ticks = measure(benchmark, iterations);
+    }
+
+    // In hundredths, rounded, as newlib-nano's printf has no floating point.
+    const uint64_t items = static_cast<uint64_t>(iterations) * (benchmark.itemsPerIteration > 0 ? benchmark.itemsPerIteration : 1);
+    const uint64_t hundredths = (uint64_t{ ticks } * c_instructionsPerTick * 100 + items / 2) / items;
+    std::printf("%s\t%lu.%02lu\n", benchmark.name, static_cast<unsigned long>(hundredths / 100), static_cast<unsigned long>(hundredths % 100));
+  }
+
+  return 0;
+}
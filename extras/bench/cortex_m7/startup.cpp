@@ -0,0 +1,69 @@
+#include <cstdint>
+#include <cstdlib>
+
+// **** **** **** ****
+// NOTE: Vector table and reset handler of the Cortex-M7 benchmark image (linked with mps2_an500.ld).
+//       QEMU loads every section of the ELF to its address, so .data needs no copy. Reset_Handler enables
+//       the FPU, clears .bss, opens the semihosting handles of newlib's rdimon library, runs the static
+//       constructors (which register the benchmarks) and main, and exits QEMU through semihosting.
+//       A fault exits with status 1 instead of hanging the emulator.
+// **** **** **** ****
+
+extern "C"
+{
+  extern uint32_t __bss_start__;
+  extern uint32_t __bss_end__;
+  extern uint32_t __stack_top;
+
+  void initialise_monitor_handles();
+  void __libc_init_array();
+  int main();
+
+  void Reset_Handler();
+  void Fault_Handler();
+
+  // __libc_init_array calls _init, which -nostartfiles leaves out.
+  void _init() {}
+  void _fini() {}
+}
+
+namespace
+{
+  constexpr uintptr_t c_coprocessorAccessControl = 0xe000ed88;
+
+  using Handler = void (*)();
+}
+
+__attribute__((section(".vectors"), used)) const Handler g_vectors[16] = {
+  reinterpret_cast<Handler>(&__stack_top),
+  Reset_Handler,
+  Fault_Handler, // NMI
+  Fault_Handler, // HardFault
+  Fault_Handler, // MemManage
+  Fault_Handler, // BusFault
+  Fault_Handler, // UsageFault
+  nullptr, nullptr, nullptr, nullptr,
+  Fault_Handler, // SVCall
+  Fault_Handler, // DebugMonitor
+  nullptr,
+  Fault_Handler, // PendSV
+  Fault_Handler  // SysTick, its interrupt is never enabled
+};
+
+void Reset_Handler()
+{
+  // Full access to CP10 and CP11; nothing before the barriers may use the FPU.
+  *reinterpret_cast<volatile uint32_t*>(c_coprocessorAccessControl) |= 0xfu << 20;
+  __asm volatile("dsb\n\tisb" : : : "memory");
+
+  for (volatile uint32_t* word = &__bss_start__; word < &__bss_end__; ++word) { *word = 0; }
+
+  initialise_monitor_handles();
+  __libc_init_array();
+  std::exit(main());
+}
+
+void Fault_Handler()
+{
+  std::_Exit(1);
+}
@@ -0,0 +1,298 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "Benchmark.hpp"
+#include "PerfCounters.hpp"
+
+// **** **** **** ****
+// NOTE: Runs the registered benchmarks and optionally gates them against stored baselines.
+//       Every benchmark is calibrated to run for about --min-time ms, then measured --repetitions times.
+//       The result is the median time per item and its median absolute deviation (MAD).
+//       With --baseline FILE a benchmark counts as regressed, if its median is more than --threshold percent
+//       above the baseline median AND the difference exceeds 3 scaled MADs (of the noisier of both runs),
+//       so noise alone does not fail the gate. The exit code is 1, if any benchmark regressed.
+//       --update-baseline FILE writes the results as new baseline. Baselines only compare runs on the
+//       same machine and compiler; refresh them, when either changes.
+//       --counters adds one more run per benchmark under hardware counters (PerfCounters.hpp) and reports
+//       cycles, instructions, branch misses, L1D and LLC misses per item. Counters that cannot be opened
+//       (no perf support, a VM, perf_event_paranoid) are shown as "-"; timing and the gate are unaffected.
+// **** **** **** ****
+
+namespace
+{
+  struct Options
+  {
+    const char* filter = nullptr;
+    size_t repetitions = 15;
+    double minTimeMs = 20.0;
+    double thresholdPercent = 10.0;
+    const char* baselinePath = nullptr;
+    const char* updatePath = nullptr;
+    bool isListOnly = false;
+    bool hasCounters = false;
+  };
+
+  struct Result
+  {
+    std::string name;
+    double medianNs = 0.0;
+    double madNs = 0.0;
+    double megabytesPerSecond = 0.0;
+    halvoe::bench::CounterValues counters;
+  };
+
+  struct Baseline
+  {
+    double medianNs = 0.0;
+    double madNs = 0.0;
+  };
+
+  double getMedian(std::vector<double> in_values)
+  {
+    std::sort(in_values.begin(), in_values.end());
+    const size_t middle = in_values.size() / 2;
+    return in_values.size() % 2 == 1 ? in_values[middle] : (in_values[middle - 1] + in_values[middle]) / 2.0;
+  }
+
+  double getMedianAbsoluteDeviation(const std::vector<double>& in_values, double in_median)
+  {
+    std::vector<double> deviations;
+    deviations.reserve(in_values.size());
+    for (double value : in_values) { deviations.push_back(std::fabs(value - in_median)); }
+    return getMedian(deviations);
+  }
+
+  double runOnce(const halvoe::bench::Benchmark& in_benchmark, size_t in_iterations)
+  {
+    const auto begin = std::chrono::steady_clock::now();
+    in_benchmark.function(in_iterations);
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - begin).count();
+  }
+
+  // Doubles the iteration count until one run takes a tenth of the target time, then scales it up.
+  size_t calibrate(const halvoe::bench::Benchmark& in_benchmark, double in_minTimeMs)
+  {
+    const double targetNs = in_minTimeMs * 1e6;
+    size_t iterations = 1;
+    double elapsedNs = runOnce(in_benchmark, iterations);
+
+    while (elapsedNs < targetNs / 10.0 && iterations < (size_t{ 1 } << 40))
+    {
+      iterations = iterations * 2;
+      elapsedNs = runOnce(in_benchmark, iterations);
+    }
+
+    const double scaled = static_cast<double>(iterations) * targetNs / (elapsedNs > 0.0 ? elapsedNs : 1.0);
+    return scaled < 1.0 ? 1 : static_cast<size_t>(scaled);
+  }
+
+  Result measure(const halvoe::bench::Benchmark& in_benchmark, const Options& in_options, halvoe::bench::PerfCounters* io_counters)
+  {
+    const size_t iterations = calibrate(in_benchmark, in_options.minTimeMs);
+    const double items = static_cast<double>(iterations) * static_cast<double>(in_benchmark.itemsPerIteration);
+
+    std::vector<double> samples;
+    samples.reserve(in_options.repetitions);
+    for (size_t repetition = 0; repetition < in_options.repetitions; ++repetition)
+    {
+      samples.push_back(runOnce(in_benchmark, iterations) / items);
+    }
+
+    Result result;
+    result.name = in_benchmark.name;
+    result.medianNs = getMedian(samples);
+    result.madNs = getMedianAbsoluteDeviation(samples, result.medianNs);
+    if (in_benchmark.bytesPerIteration > 0)
+    {
+      const double bytesPerItem = static_cast<double>(in_benchmark.bytesPerIteration) / static_cast<double>(in_benchmark.itemsPerIteration);
+      result.megabytesPerSecond = bytesPerItem / result.medianNs * 1e3;
+    }
+
+    if (io_counters != nullptr)
+    {
+      io_counters->start();
+      in_benchmark.function(iterations);
+      result.counters = io_counters->stop();
+      for (double& value : result.counters.values) { value = value / items; }
+    }
+    return result;
+  }
+
+  // Reads the file written by writeBaselines, one benchmark per line.
+  bool readBaselines(const char* in_path, std::map<std::string, Baseline>& out_baselines)
+  {
+    FILE* file = std::fopen(in_path, "r");
+    if (file == nullptr) { return false; }
+
+    char line[512];
+    while (std::fgets(line, sizeof(line), file) != nullptr)
+    {
+      char name[256];
+      Baseline baseline;
+      if (std::sscanf(line, " \"%255[^\"]\" : { \"median_ns\" : %lf , \"mad_ns\" : %lf }", name, &baseline.medianNs, &baseline.madNs) == 3)
+      {
+        out_baselines[name] = baseline;
+      }
+    }
+
+    std::fclose(file);
+    return true;
+  }
+
+  bool writeBaselines(const char* in_path, const std::vector<Result>& in_results)
+  {
+    FILE* file = std::fopen(in_path, "w");
+    if (file == nullptr) { return false; }
+
+    std::fprintf(file, "{\n  \"unit\": \"ns per item\",\n  \"benchmarks\": {\n");
+    for (size_t index = 0; index < in_results.size(); ++index)
+    {
+      const Result& result = in_results[index];
+      std::fprintf(file, "    \"%s\": { \"median_ns\": %.4f, \"mad_ns\": %.4f }%s\n", result.name.c_str(), result.medianNs, result.madNs,
+                   index + 1 < in_results.size() ? "," : "");
+    }
+    std::fprintf(file, "  }\n}\n");
+    return std::fclose(file) == 0;
+  }
+
+  void printCounter(const halvoe::bench::CounterValues& in_counters, halvoe::bench::Counter in_counter)
+  {
+    if (in_counters.has(in_counter)) { std::printf(" %9.2f", in_counters.get(in_counter)); }
+    else { std::printf(" %9s", "-"); }
+  }
+
+  void printCounters(const halvoe::bench::CounterValues& in_counters)
+  {
+    using halvoe::bench::Counter;
+    printCounter(in_counters, Counter::cycles);
+    printCounter(in_counters, Counter::instructions);
+    if (in_counters.has(Counter::cycles) && in_counters.has(Counter::instructions) && in_counters.get(Counter::cycles) > 0.0)
+    {
+      std::printf(" %5.2f", in_counters.get(Counter::instructions) / in_counters.get(Counter::cycles));
+    }
+    else { std::printf(" %5s", "-"); }
+    printCounter(in_counters, Counter::branchMisses);
+    printCounter(in_counters, Counter::l1dMisses);
+    printCounter(in_counters, Counter::llcMisses);
+  }
+
+  bool parseOptions(int in_argc, char** in_argv, Options& out_options)
+  {
+    for (int index = 1; index < in_argc; ++index)
+    {
+      const char* argument = in_argv[index];
+      const bool hasValue = index + 1 < in_argc;
+
+      if (std::strcmp(argument, "--list") == 0) { out_options.isListOnly = true; }
+      else if (std::strcmp(argument, "--counters") == 0) { out_options.hasCounters = true; }
+      else if (std::strcmp(argument, "--filter") == 0 && hasValue) { out_options.filter = in_argv[++index]; }
+      else if (std::strcmp(argument, "--repetitions") == 0 && hasValue) { out_options.repetitions = std::strtoul(in_argv[++index], nullptr, 10); }
+      else if (std::strcmp(argument, "--min-time") == 0 && hasValue) { out_options.minTimeMs = std::strtod(in_argv[++index], nullptr); }
+      else if (std::strcmp(argument, "--threshold") == 0 && hasValue) { out_options.thresholdPercent = std::strtod(in_argv[++index], nullptr); }
+      else if (std::strcmp(argument, "--baseline") == 0 && hasValue) { out_options.baselinePath = in_argv[++index]; }
+      else if (std::strcmp(argument, "--update-baseline") == 0 && hasValue) { out_options.updatePath = in_argv[++index]; }
+      else { return false; }
+    }
+
+    return out_options.repetitions > 0 && out_options.minTimeMs > 0.0;
+  }
+}
+
+int main(int in_argc, char** in_argv)
+{
+  Options options;
+  if (!parseOptions(in_argc, in_argv, options))
+  {
+    std::fprintf(stderr, "usage: %s [--list] [--filter TEXT] [--repetitions N] [--min-time MS] [--threshold PERCENT]\n"
+                         "          [--baseline FILE] [--update-baseline FILE] [--counters]\n", in_argv[0]);
+    return 2;
+  }
+
+  std::map<std::string, Baseline> baselines;
+  if (options.baselinePath != nullptr && !readBaselines(options.baselinePath, baselines))
+  {
+    std::fprintf(stderr, "cannot read baseline file %s\n", options.baselinePath);
+    return 2;
+  }
+
+  std::unique_ptr<halvoe::bench::PerfCounters> counters;
+  if (options.hasCounters && !options.isListOnly)
+  {
+    counters.reset(new halvoe::bench::PerfCounters());
+    if (!counters->isAnyAvailable())
+    {
+      std::fprintf(stderr, "hardware counters unavailable (%s), running without them\n", std::strerror(counters->getLastError()));
+      counters.reset();
+    }
+    else if (counters->getLastError() != 0)
+    {
+      std::fprintf(stderr, "some hardware counters unavailable (%s), shown as -\n", std::strerror(counters->getLastError()));
+    }
+  }
+
+  std::vector<Result> results;
+  size_t regressionCount = 0;
+
+  if (!options.isListOnly)
+  {
+    std::printf("%-40s %12s %10s %10s", "benchmark", "ns/item", "MAD", "MB/s");
+    if (counters != nullptr) { std::printf(" %9s %9s %5s %9s %9s %9s", "cycles", "instr", "IPC", "br-miss", "L1D-miss", "LLC-miss"); }
+    if (options.baselinePath != nullptr) { std::printf(" %12s %8s  %s", "baseline", "delta", "verdict"); }
+    std::printf("\n");
+  }
+
+  for (const halvoe::bench::Benchmark& benchmark : halvoe::bench::getBenchmarks())
+  {
+    if (options.filter != nullptr && std::strstr(benchmark.name, options.filter) == nullptr) { continue; }
+    if (options.isListOnly) { std::printf("%s\n", benchmark.name); continue; }
+
+    const Result result = measure(benchmark, options, counters.get());
+    results.push_back(result);
+
+    std::printf("%-40s %12.3f %10.3f", result.name.c_str(), result.medianNs, result.madNs);
+    if (result.megabytesPerSecond > 0.0) { std::printf(" %10.1f", result.megabytesPerSecond); }
+    else { std::printf(" %10s", "-"); }
+    if (counters != nullptr) { printCounters(result.counters); }
+
+    if (options.baselinePath != nullptr)
+    {
+      const auto found = baselines.find(result.name);
+      if (found == baselines.end()) { std::printf(" %12s %8s  new", "-", "-"); }
+      else
+      {
+        const Baseline& baseline = found->second;
+        const double deltaPercent = (result.medianNs / baseline.medianNs - 1.0) * 100.0;
+        const double noiseNs = 3.0 * 1.4826 * std::max(result.madNs, baseline.madNs);
+        const bool isRegression = deltaPercent > options.thresholdPercent && result.medianNs - baseline.medianNs > noiseNs;
+        const bool isImprovement = deltaPercent < -options.thresholdPercent && baseline.medianNs - result.medianNs > noiseNs;
+        if (isRegression) { ++regressionCount; }
+        std::printf(" %12.3f %+7.1f%%  %s", baseline.medianNs, deltaPercent, isRegression ? "REGRESSED" : isImprovement ? "improved" : "ok");
+      }
+    }
+
+    std::printf("\n");
+    std::fflush(stdout);
+  }
+
+  if (options.updatePath != nullptr && !writeBaselines(options.updatePath, results))
+  {
+    std::fprintf(stderr, "cannot write baseline file %s\n", options.updatePath);
+    return 2;
+  }
+
+  if (regressionCount > 0)
+  {
+    std::printf("%zu benchmark(s) regressed by more than %.1f%%\n", regressionCount, options.thresholdPercent);
+    return 1;
+  }
+
+  return 0;
+}
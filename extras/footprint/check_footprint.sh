@@ -0,0 +1,95 @@
+#!/bin/sh
+# Collects the size of every halvoe symbol of the footprint object (nm -C -S --size-sort) and its text,
+# data and bss totals (size), and compares them against a baseline file of "bytes<TAB>name" lines:
+#
+#   ./check_footprint.sh report OBJECT               print the sizes
+#   ./check_footprint.sh check OBJECT BASELINE       fail if a symbol or a total is larger than in BASELINE
+#   ./check_footprint.sh baseline OBJECT BASELINE    write the sizes as new baseline
+#
+# NM and SIZE select the binutils of the target (default arm-none-eabi-). Symbols emitted several times
+# under one name (complete and base object constructors) are summed. A symbol missing from the baseline
+# is reported as new; it grows the totals, so the check fails until the baseline is refreshed.
+# Refresh the baseline only together with the change that justifies the growth.
+
+set -e
+
+NM=${NM:-arm-none-eabi-nm}
+SIZE=${SIZE:-arm-none-eabi-size}
+MODE=$1
+OBJECT=$2
+BASELINE=$3
+
+case $MODE in
+  report) ;;
+  check|baseline)
+    if [ -z "$BASELINE" ]; then
+      echo "usage: $0 $MODE OBJECT BASELINE" >&2
+      exit 2
+    fi
+    if [ "$MODE" = check ] && [ ! -f "$BASELINE" ]; then
+      echo "check_footprint: no baseline $BASELINE, create it with make baseline" >&2
+      exit 1
+    fi
+    ;;
+  *)
+    echo "usage: $0 report|check|baseline OBJECT [BASELINE]" >&2
+    exit 2
+    ;;
+esac
+
+SIZES=$(dirname "$OBJECT")/footprint.txt
+{
+  $SIZE "$OBJECT" | awk 'NR == 2 { printf "%d\t[text]\n%d\t[data]\n%d\t[bss]\n", $1, $2, $3 }'
+  $NM -C -S --size-sort -t d "$OBJECT" | awk '
+    {
+      name = $0
+      sub(/^[^ ]+ +[^ ]+ +[^ ]+ +/, "", name)
+      if (name !~ /halvoe::/) { next }
+      if (!(name in sizes)) { names[++count] = name }
+      sizes[name] += $2
+    }
+    END { for (index_ = 1; index_ <= count; index_++) { printf "%d\t%s\n", sizes[names[index_]], names[index_] } }'
+} > "$SIZES"
+if ! grep -q "halvoe::" "$SIZES"; then
+  echo "check_footprint: no halvoe symbols in $OBJECT" >&2
+  exit 1
+fi
+
+case $MODE in
+  report)
+    cat "$SIZES"
+    ;;
+  baseline)
+    {
+      echo "# Bytes per halvoe symbol of footprint.cpp and the totals of the object, see check_footprint.sh."
+      cat "$SIZES"
+    } > "$BASELINE"
+    echo "check_footprint: wrote $(wc -l < "$SIZES") sizes to $BASELINE"
+    ;;
+  check)
+    awk -F '\t' -v baselinePath="$BASELINE" '
+      FILENAME == baselinePath { if ($0 !~ /^#/) { baselines[$2] = $1 }; next }
+      {
+        seen[$2] = 1
+        if (!($2 in baselines)) {
+          printf "check_footprint: %6d bytes (new)           %s\n", $1, $2
+        } else if ($1 > baselines[$2]) {
+          printf "check_footprint: %6d bytes (baseline %6d) %s  GREW\n", $1, baselines[$2], $2
+          failed = 1
+        } else if ($1 < baselines[$2]) {
+          printf "check_footprint: %6d bytes (baseline %6d) %s  shrank\n", $1, baselines[$2], $2
+        } else if ($2 ~ /^\[/) {
+          printf "check_footprint: %6d bytes (baseline %6d) %s  ok\n", $1, baselines[$2], $2
+        } else {
+          unchanged++
+        }
+      }
+      END {
+        for (name in baselines) {
+          if (!(name in seen)) { printf "check_footprint:        (baseline %6d) %s  gone\n", baselines[name], name }
+        }
+        printf "check_footprint: %d symbols unchanged\n", unchanged
+        exit failed
+      }' "$BASELINE" "$SIZES"
+    ;;
+esac
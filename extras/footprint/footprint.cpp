@@ -0,0 +1,51 @@
+#include <cstdint>
+
+#include "BasicSerializer.hpp"
+
+// **** **** **** ****
+// NOTE: Representative Serializer/Deserializer instantiations for the footprint gate (check_footprint.sh).
+//       Explicit instantiations emit every function as its own symbol, so nm reports the size of each one
+//       instead of whatever the optimiser left after inlining into a caller. The set covers the value,
+//       enum, string and array paths with the default size_t cursor and with a uint16_t cursor.
+//       Add an instantiation here only together with a refreshed baseline.
+// **** **** **** ****
+
+namespace footprint
+{
+  enum class Mode : uint8_t
+  {
+    idle = 0,
+    running,
+    stopped
+  };
+}
+
+#define HALVOE_FOOTPRINT_INSTANTIATE(in_bufferSize, in_cursorType) \
+  template class halvoe::Serializer<in_bufferSize, in_cursorType>; \
+  template halvoe::SerializerReference<uint16_t> halvoe::Serializer<in_bufferSize, in_cursorType>::skip<uint16_t>(); \
+  template bool halvoe::Serializer<in_bufferSize, in_cursorType>::write<uint8_t>(uint8_t); \
+  template bool halvoe::Serializer<in_bufferSize, in_cursorType>::write<uint32_t>(uint32_t); \
+  template bool halvoe::Serializer<in_bufferSize, in_cursorType>::write<int64_t>(int64_t); \
+  template bool halvoe::Serializer<in_bufferSize, in_cursorType>::write<float>(float); \
+  template bool halvoe::Serializer<in_bufferSize, in_cursorType>::write<double>(double); \
+  template bool halvoe::Serializer<in_bufferSize, in_cursorType>::write<bool>(bool); \
+  template bool halvoe::Serializer<in_bufferSize, in_cursorType>::writeEnum<footprint::Mode>(footprint::Mode); \
+  template bool halvoe::Serializer<in_bufferSize, in_cursorType>::write<uint8_t>(const char*, uint8_t); \
+  template bool halvoe::Serializer<in_bufferSize, in_cursorType>::write<uint16_t>(const char*, uint16_t); \
+  template bool halvoe::Serializer<in_bufferSize, in_cursorType>::writeArray<float>(const float*, size_t); \
+  template class halvoe::Deserializer<in_bufferSize, in_cursorType>; \
+  template bool halvoe::Deserializer<in_bufferSize, in_cursorType>::skip<uint16_t>(); \
+  template uint8_t halvoe::Deserializer<in_bufferSize, in_cursorType>::read<uint8_t>(); \
+  template uint32_t halvoe::Deserializer<in_bufferSize, in_cursorType>::read<uint32_t>(); \
+  template int64_t halvoe::Deserializer<in_bufferSize, in_cursorType>::read<int64_t>(); \
+  template float halvoe::Deserializer<in_bufferSize, in_cursorType>::read<float>(); \
+  template double halvoe::Deserializer<in_bufferSize, in_cursorType>::read<double>(); \
+  template bool halvoe::Deserializer<in_bufferSize, in_cursorType>::read<bool>(); \
+  template footprint::Mode halvoe::Deserializer<in_bufferSize, in_cursorType>::readEnum<footprint::Mode>(); \
+  template const halvoe::DeserializerReference<uint32_t> halvoe::Deserializer<in_bufferSize, in_cursorType>::view<uint32_t>(); \
+  template const char* halvoe::Deserializer<in_bufferSize, in_cursorType>::view<uint8_t>(uint8_t&); \
+  template std::unique_ptr<const char[]> halvoe::Deserializer<in_bufferSize, in_cursorType>::read<uint8_t>(uint8_t, uint8_t&); \
+  template bool halvoe::Deserializer<in_bufferSize, in_cursorType>::readArray<float>(float*, size_t);
+
+HALVOE_FOOTPRINT_INSTANTIATE(256, size_t)
+HALVOE_FOOTPRINT_INSTANTIATE(1024, uint16_t)
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstdio>
+
+// **** **** **** ****
+// NOTE: A minimal host test helper: HALVOE_CHECK records a failed condition with its location and
+//       continues, so one run reports every failure. main() returns finishTest(), which is non-zero,
+//       if any check failed.
+// **** **** **** ****
+
+namespace halvoe
+{
+  namespace test
+  {
+    struct Counters
+    {
+      size_t checkCount = 0;
+      size_t failureCount = 0;
+    };
+
+    inline Counters& getCounters()
+    {
+      static Counters counters;
+      return counters;
+    }
+
+    inline bool check(bool in_condition, const char* in_expression, const char* in_file, int in_line)
+    {
+      Counters& counters = getCounters();
+      counters.checkCount = counters.checkCount + 1;
+      if (in_condition) { return true; }
+
+      counters.failureCount = counters.failureCount + 1;
+      std::printf("%s:%d: check failed: %s\n", in_file, in_line, in_expression);
+      return false;
+    }
+
+    inline int finishTest(const char* in_name)
+    {
+      const Counters& counters = getCounters();
+      std::printf("%s: %zu checks, %zu failed\n", in_name, counters.checkCount, counters.failureCount);
+      return counters.failureCount == 0 ? 0 : 1;
+    }
+  }
+}
+
+#define HALVOE_CHECK(in_condition) ::halvoe::test::check(static_cast<bool>(in_condition), #in_condition, __FILE__, __LINE__)
@@ -0,0 +1,103 @@
+#!/bin/sh
+# Compiles codegen.cpp at -O2, disassembles it with objdump and checks every codegen_* function
+# against the limits below: no calls (also no tail calls into other functions), at most the given
+# number of instructions (padding nops excluded) and compares. The limits are for x86-64.
+#
+#   ./check_codegen.sh          without type tags
+#   ./check_codegen.sh tags     with -DHALVOE_SERIALIZER_TYPE_TAGS (one more compare for the tag on reads)
+#
+# Raise a limit only together with the change that justifies it.
+
+set -e
+
+CXX=${CXX:-g++}
+MODE=${1:-plain}
+BUILD_DIR=build
+OBJECT=$BUILD_DIR/codegen_$MODE.o
+
+case $MODE in
+  plain)
+    DEFINES=
+    LIMITS="
+      codegen_write_uint32 10 1
+      codegen_write_double 10 1
+      codegen_writeEnum 10 1
+      codegen_skip_write_uint16 13 1
+      codegen_read_uint32 11 1
+      codegen_read_float 11 1
+      codegen_readEnum 11 1
+      codegen_skip_uint32 10 1"
+    ;;
+  tags)
+    DEFINES=-DHALVOE_SERIALIZER_TYPE_TAGS
+    LIMITS="
+      codegen_write_uint32 15 1
+      codegen_write_double 15 1
+      codegen_writeEnum 15 1
+      codegen_skip_write_uint16 18 1
+      codegen_read_uint32 24 2
+      codegen_read_float 24 2
+      codegen_readEnum 24 2
+      codegen_skip_uint32 21 2"
+    ;;
+  *)
+    echo "usage: $0 [plain|tags]" >&2
+    exit 2
+    ;;
+esac
+
+if [ "$(uname -m)" != "x86_64" ]; then
+  echo "check_codegen: limits are for x86-64, skipped on $(uname -m)"
+  exit 0
+fi
+
+mkdir -p $BUILD_DIR
+$CXX -std=c++17 -O2 $DEFINES -I../../BasicSerializer/src -c codegen.cpp -o $OBJECT
+
+objdump -d --no-show-raw-insn -M intel $OBJECT | awk -v limits="$LIMITS" -v mode="$MODE" '
+  BEGIN {
+    count = split(limits, fields, " ")
+    functionCount = 0
+    for (index_ = 1; index_ + 2 <= count; index_ += 3) {
+      functions[++functionCount] = fields[index_]
+      maxInstructions[fields[index_]] = fields[index_ + 1]
+      maxCompares[fields[index_]] = fields[index_ + 2]
+    }
+  }
+  /^[0-9a-f]+ <.*>:$/ {
+    name = $2
+    gsub(/[<>:]/, "", name)
+    next
+  }
+  name != "" && /^ +[0-9a-f]+:\t/ {
+    split($0, columns, "\t")
+    instruction = columns[2]
+    if (instruction ~ /nop/ || instruction ~ /^xchg +ax,ax/) { next }
+    mnemonic = instruction
+    while (mnemonic ~ /^(data16|cs|ds|rex|rep|repz|bnd|notrack) /) { sub(/^[a-z0-9]+ +/, "", mnemonic) }
+    sub(/ .*/, "", mnemonic)
+
+    instructions[name]++
+    if (mnemonic == "cmp") { compares[name]++ }
+    if (mnemonic == "call") { calls[name]++ }
+    if (mnemonic == "jmp" && instruction ~ /</ && instruction !~ ("<" name "[+>]")) { calls[name]++ }
+  }
+  END {
+    failed = 0
+    for (index_ = 1; index_ <= functionCount; index_++) {
+      function_ = functions[index_]
+      if (!(function_ in instructions)) {
+        printf "check_codegen %s: %s not found\n", mode, function_
+        failed = 1
+        continue
+      }
+      verdict = "ok"
+      if (calls[function_] > 0 || instructions[function_] > maxInstructions[function_] || compares[function_] > maxCompares[function_]) {
+        verdict = "FAILED"
+        failed = 1
+      }
+      printf "check_codegen %s: %-28s %3d instructions (max %d), %d compares (max %d), %d calls  %s\n", mode, function_,
+             instructions[function_], maxInstructions[function_], compares[function_] + 0, maxCompares[function_], calls[function_] + 0, verdict
+    }
+    exit failed
+  }'
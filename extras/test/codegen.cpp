@@ -0,0 +1,61 @@
+#include "BasicSerializer.hpp"
+
+// **** **** **** ****
+// NOTE: Not a test on its own: check_codegen.sh compiles this file at -O2, disassembles the functions
+//       below and checks their instruction counts against the limits in the script. Every function
+//       wraps one hot path, so a refactor that adds calls or checks to it fails the check.
+// **** **** **** ****
+
+using namespace halvoe;
+
+namespace
+{
+  enum class Mode : uint8_t
+  {
+    idle = 0,
+    running
+  };
+}
+
+extern "C"
+{
+  bool codegen_write_uint32(Serializer<256>& io_serializer, uint32_t in_value)
+  {
+    return io_serializer.write<uint32_t>(in_value);
+  }
+
+  bool codegen_write_double(Serializer<256>& io_serializer, double in_value)
+  {
+    return io_serializer.write<double>(in_value);
+  }
+
+  bool codegen_writeEnum(Serializer<256>& io_serializer, Mode in_value)
+  {
+    return io_serializer.writeEnum(in_value);
+  }
+
+  bool codegen_skip_write_uint16(Serializer<256>& io_serializer, uint16_t in_value)
+  {
+    return io_serializer.skip<uint16_t>().write(in_value);
+  }
+
+  uint32_t codegen_read_uint32(Deserializer<256>& io_deserializer)
+  {
+    return io_deserializer.read<uint32_t>();
+  }
+
+  float codegen_read_float(Deserializer<256>& io_deserializer)
+  {
+    return io_deserializer.read<float>();
+  }
+
+  Mode codegen_readEnum(Deserializer<256>& io_deserializer)
+  {
+    return io_deserializer.readEnum<Mode>();
+  }
+
+  bool codegen_skip_uint32(Deserializer<256>& io_deserializer)
+  {
+    return io_deserializer.skip<uint32_t>();
+  }
+}
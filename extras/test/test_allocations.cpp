@@ -0,0 +1,286 @@
+#include <array>
+#include <cstdlib>
+#include <new>
+
+#include "BasicSerializer.hpp"
+#include "ChaCha20Poly1305.hpp"
+#include "JsonConverter.hpp"
+#include "JsonWriter.hpp"
+#include "RingDeserializer.hpp"
+#include "Schema.hpp"
+#include "SegmentedBuffer.hpp"
+#include "SerializationCache.hpp"
+#include "SharedBuffer.hpp"
+#include "SipHash.hpp"
+#include "Test.hpp"
+
+// **** **** **** ****
+// NOTE: Counts heap allocations around the hot paths by replacing operator new/delete and, with glibc,
+//       interposing malloc/calloc/realloc. Every path must allocate 0 times, except the unique_ptr based
+//       Deserializer::read for strings, which is documented to allocate exactly once per call.
+// **** **** **** ****
+
+namespace
+{
+  size_t g_allocationCount = 0;
+
+  void countAllocation()
+  {
+    g_allocationCount = g_allocationCount + 1;
+  }
+}
+
+#if defined(__GLIBC__)
+extern "C"
+{
+  void* __libc_malloc(size_t in_size);
+  void* __libc_calloc(size_t in_count, size_t in_size);
+  void* __libc_realloc(void* io_pointer, size_t in_size);
+  void __libc_free(void* in_pointer);
+
+  void* malloc(size_t in_size)
+  {
+    countAllocation();
+    return __libc_malloc(in_size);
+  }
+
+  void* calloc(size_t in_count, size_t in_size)
+  {
+    countAllocation();
+    return __libc_calloc(in_count, in_size);
+  }
+
+  void* realloc(void* io_pointer, size_t in_size)
+  {
+    countAllocation();
+    return __libc_realloc(io_pointer, in_size);
+  }
+
+  void free(void* in_pointer)
+  {
+    __libc_free(in_pointer);
+  }
+}
+
+#define HALVOE_RAW_MALLOC __libc_malloc
+#define HALVOE_RAW_FREE __libc_free
+#else
+#define HALVOE_RAW_MALLOC std::malloc
+#define HALVOE_RAW_FREE std::free
+#endif
+
+void* operator new(size_t in_size)
+{
+  countAllocation();
+  void* pointer = HALVOE_RAW_MALLOC(in_size == 0 ? 1 : in_size);
+  if (pointer == nullptr) { throw std::bad_alloc(); }
+  return pointer;
+}
+
+void* operator new[](size_t in_size)
+{
+  return operator new(in_size);
+}
+
+void* operator new(size_t in_size, const std::nothrow_t&) noexcept
+{
+  countAllocation();
+  return HALVOE_RAW_MALLOC(in_size == 0 ? 1 : in_size);
+}
+
+void* operator new[](size_t in_size, const std::nothrow_t& in_nothrow) noexcept
+{
+  return operator new(in_size, in_nothrow);
+}
+
+void operator delete(void* in_pointer) noexcept { HALVOE_RAW_FREE(in_pointer); }
+void operator delete[](void* in_pointer) noexcept { HALVOE_RAW_FREE(in_pointer); }
+void operator delete(void* in_pointer, size_t) noexcept { HALVOE_RAW_FREE(in_pointer); }
+void operator delete[](void* in_pointer, size_t) noexcept { HALVOE_RAW_FREE(in_pointer); }
+void operator delete(void* in_pointer, const std::nothrow_t&) noexcept { HALVOE_RAW_FREE(in_pointer); }
+void operator delete[](void* in_pointer, const std::nothrow_t&) noexcept { HALVOE_RAW_FREE(in_pointer); }
+
+using namespace halvoe;
+
+namespace
+{
+  // Keeps the compiler from eliding a new/delete pair, whose result is otherwise unused.
+  void escape(const void* in_pointer)
+  {
+    asm volatile("" : : "g"(in_pointer) : "memory");
+  }
+
+  template<typename Function>
+  void checkAllocations(const char* in_name, size_t in_expectedCount, Function&& in_function)
+  {
+    const size_t begin = g_allocationCount;
+    in_function();
+    const size_t count = g_allocationCount - begin;
+    if (!HALVOE_CHECK(count == in_expectedCount)) { std::printf("  %s: %zu allocations, expected %zu\n", in_name, count, in_expectedCount); }
+  }
+
+  enum class Mode : uint8_t
+  {
+    idle = 0,
+    running
+  };
+
+  struct Message
+  {
+    uint16_t id = 0;
+    float value = 0.0f;
+  };
+
+  using MessageSchema = Schema<Message, SchemaField<Message, uint16_t, &Message::id, 1>, SchemaField<Message, float, &Message::value, 1>>;
+
+  std::array<uint8_t, 256> g_buffer{};
+
+  void writeMessage(Serializer<256>& out_serializer)
+  {
+    const uint16_t values[4] = { 1, 2, 3, 4 };
+    out_serializer.write<uint32_t>(42);
+    out_serializer.write<double>(1.5);
+    out_serializer.writeEnum(Mode::running);
+    out_serializer.write("hello", static_cast<uint8_t>(5));
+    out_serializer.writeArray(values, 4);
+  }
+}
+
+int main()
+{
+  checkAllocations("Serializer::write/writeEnum/writeArray/skip", 0, []
+  {
+    Serializer<256> serializer(g_buffer);
+    writeMessage(serializer);
+    serializer.skip<uint16_t>().write(7);
+    escape(g_buffer.data());
+  });
+
+  checkAllocations("SizingSerializer", 0, []
+  {
+    SizingSerializer serializer;
+    serializer.write<uint32_t>(42);
+    serializer.write("hello", static_cast<uint8_t>(5));
+    escape(&serializer);
+  });
+
+  checkAllocations("Deserializer::read/readEnum/view/readArray", 0, []
+  {
+    Deserializer<256> deserializer(g_buffer);
+    uint16_t values[4];
+    uint8_t size = 0;
+    escape(&values);
+    HALVOE_CHECK(deserializer.read<uint32_t>() == 42);
+    HALVOE_CHECK(deserializer.read<double>() == 1.5);
+    HALVOE_CHECK(deserializer.readEnum<Mode>() == Mode::running);
+    HALVOE_CHECK(deserializer.view(size) != nullptr && size == 5);
+    HALVOE_CHECK(deserializer.readArray(values, 4) && values[3] == 4);
+  });
+
+  // The unique_ptr based string read allocates exactly once per call, on the failure path too.
+  checkAllocations("Deserializer::read string (unique_ptr)", 1, []
+  {
+    Deserializer<256> deserializer(g_buffer);
+    deserializer.skip<uint32_t>();
+    deserializer.skip<double>();
+    deserializer.readEnum<Mode>();
+    uint8_t size = 0;
+    const std::unique_ptr<const char[]> string = deserializer.read(static_cast<uint8_t>(16), size);
+    escape(string.get());
+  });
+
+  checkAllocations("Deserializer::read string failure (unique_ptr)", 1, []
+  {
+    Deserializer<256> deserializer(g_buffer);
+    const std::unique_ptr<const char[]> string = deserializer.read(static_cast<uint8_t>(16));
+    escape(string.get());
+  });
+
+  checkAllocations("Schema serialize/deserialize", 0, []
+  {
+    std::array<uint8_t, 32> buffer;
+    Serializer<32> serializer(buffer);
+    const Message in{ 7, 2.5f };
+    HALVOE_CHECK(MessageSchema::serialize(in, serializer));
+    Deserializer<32> deserializer(buffer);
+    Message out;
+    HALVOE_CHECK(MessageSchema::deserialize(deserializer, out) && out.id == 7);
+  });
+
+  static SharedBufferPool<256, 2> pool;
+  checkAllocations("SharedBufferPool acquire/finalise/release", 0, []
+  {
+    uint8_t* data = pool.acquire();
+    Serializer<256> serializer(data);
+    writeMessage(serializer);
+    SharedBuffer buffer = pool.finalise(serializer);
+    SharedBuffer copy = buffer;
+    HALVOE_CHECK(copy.getSize() == serializer.getBytesWritten());
+  });
+
+  static SerializationCache<2> cache;
+  static const Message object;
+  cache.getOrSerialize(pool, &object, 1, [](Serializer<256>& out_serializer) { writeMessage(out_serializer); return true; });
+  checkAllocations("SerializationCache hit", 0, []
+  {
+    const SharedBuffer buffer = cache.getOrSerialize(pool, &object, 1, [](Serializer<256>&) { return false; });
+    HALVOE_CHECK(!buffer.isNull());
+  });
+
+  checkAllocations("SipHash tag append/verify", 0, []
+  {
+    const SipHashKey key{};
+    Serializer<256> serializer(g_buffer);
+    writeMessage(serializer);
+    const size_t frameSize = appendSipHashTag(serializer, key);
+    size_t size = 0;
+    HALVOE_CHECK(frameSize > 0 && verifySipHashTag(g_buffer.data(), frameSize, key, size));
+  });
+
+  checkAllocations("ChaCha20-Poly1305 seal/open", 0, []
+  {
+    const ChaChaKey key{};
+    const ChaChaNonce nonce{};
+    Serializer<256> serializer(g_buffer);
+    writeMessage(serializer);
+    const size_t frameSize = sealChaCha20Poly1305(serializer, key, nonce);
+    size_t size = 0;
+    HALVOE_CHECK(frameSize > 0 && openChaCha20Poly1305(g_buffer.data(), frameSize, key, nonce, size));
+  });
+
+  static BlockPool<16, 8> blockPool;
+  checkAllocations("SegmentedSerializer/SegmentedDeserializer", 0, []
+  {
+    SegmentedSerializer<16, 8> serializer(blockPool);
+    serializer.write<uint32_t>(42);
+    serializer.write("a string across blocks", static_cast<uint8_t>(22));
+    BufferSegment segments[8];
+    const size_t segmentCount = serializer.getSegments(segments, 8);
+    SegmentedDeserializer deserializer(segments, segmentCount);
+    char string[32];
+    uint8_t size = 0;
+    HALVOE_CHECK(deserializer.read<uint32_t>() == 42 && deserializer.read(string, sizeof(string), size) && size == 22);
+  });
+
+  checkAllocations("RingDeserializer", 0, []
+  {
+    RingDeserializer deserializer(g_buffer.data(), g_buffer.size(), 32, 0);
+    HALVOE_CHECK(deserializer.read<uint32_t>() == 42);
+  });
+
+  checkAllocations("JsonConverter/writeJson", 0, []
+  {
+    static const FieldDescriptor fields[] = { { "id", FieldType::uint16 }, { "name", FieldType::string8 } };
+    const char json[] = "{\"id\": 7, \"name\": \"a\\u00e9\"}";
+    std::array<uint8_t, 32> buffer;
+    Serializer<32> serializer(buffer);
+    JsonConverter converter(fields, 2);
+    HALVOE_CHECK(converter.convert(json, sizeof(json) - 1, serializer) > 0);
+    Deserializer<32> deserializer(buffer);
+    std::array<char, 64> text;
+    JsonWriter<64> writer(text);
+    HALVOE_CHECK(writeJson(deserializer, fields, 2, writer));
+  });
+
+  return test::finishTest("test_allocations");
+}
@@ -0,0 +1,356 @@
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+#include "Cbor.hpp"
+#include "Test.hpp"
+
+// **** **** **** ****
+// NOTE: Checks CborSerializer and CborDeserializer against the examples of RFC 8949, Appendix A (integers,
+//       floats in preferred serialization, simple values, strings, tags, definite and indefinite arrays and
+//       maps), the half precision conversion for every 16 bit pattern, and the fast and deterministic modes.
+// **** **** **** ****
+
+using namespace halvoe;
+
+namespace
+{
+  constexpr size_t c_bufferSize = 64;
+
+  std::array<uint8_t, c_bufferSize> g_expected;
+  std::array<uint8_t, c_bufferSize> g_buffer;
+
+  size_t fromHex(const char* in_hex)
+  {
+    const size_t size = std::strlen(in_hex) / 2;
+    for (size_t index = 0; index < size; ++index)
+    {
+      unsigned int value = 0;
+      std::sscanf(in_hex + 2 * index, "%2x", &value);
+      g_expected[index] = static_cast<uint8_t>(value);
+    }
+    return size;
+  }
+
+  template<CborEncoding tc_encoding = CborEncoding::preferred, typename WriteFunction>
+  bool encodesTo(WriteFunction in_write, const char* in_hex)
+  {
+    const size_t size = fromHex(in_hex);
+    g_buffer.fill(0x55);
+    CborSerializer<c_bufferSize, tc_encoding> serializer(g_buffer);
+    return in_write(serializer) && serializer.getBytesWritten() == size && std::memcmp(g_buffer.data(), g_expected.data(), size) == 0;
+  }
+
+  template<typename Type>
+  bool numberEncodesTo(Type in_value, const char* in_hex)
+  {
+    if (!encodesTo([in_value](CborSerializer<c_bufferSize>& out_serializer) { return out_serializer.write<Type>(in_value); }, in_hex)) { return false; }
+
+    CborDeserializer<c_bufferSize> deserializer(g_buffer);
+    const Type value = deserializer.read<Type>();
+    return (value == in_value || (value != value && in_value != in_value)) && deserializer.getBytesRead() == std::strlen(in_hex) / 2;
+  }
+
+  template<typename Type>
+  bool decodesTo(const char* in_hex, Type in_value)
+  {
+    const size_t size = fromHex(in_hex);
+    CborDeserializer<c_bufferSize> deserializer(g_expected.data());
+    const Type value = deserializer.read<Type>();
+    return (value == in_value || (value != value && in_value != in_value)) && deserializer.getBytesRead() == size;
+  }
+
+  void checkIntegers()
+  {
+    HALVOE_CHECK(numberEncodesTo<uint64_t>(0, "00"));
+    HALVOE_CHECK(numberEncodesTo<uint64_t>(1, "01"));
+    HALVOE_CHECK(numberEncodesTo<uint64_t>(10, "0a"));
+    HALVOE_CHECK(numberEncodesTo<uint64_t>(23, "17"));
+    HALVOE_CHECK(numberEncodesTo<uint64_t>(24, "1818"));
+    HALVOE_CHECK(numberEncodesTo<uint64_t>(25, "1819"));
+    HALVOE_CHECK(numberEncodesTo<uint64_t>(100, "1864"));
+    HALVOE_CHECK(numberEncodesTo<uint64_t>(1000, "1903e8"));
+    HALVOE_CHECK(numberEncodesTo<uint64_t>(1000000, "1a000f4240"));
+    HALVOE_CHECK(numberEncodesTo<uint64_t>(1000000000000, "1b000000e8d4a51000"));
+    HALVOE_CHECK(numberEncodesTo<uint64_t>(18446744073709551615u, "1bffffffffffffffff"));
+    HALVOE_CHECK(numberEncodesTo<int64_t>(-1, "20"));
+    HALVOE_CHECK(numberEncodesTo<int64_t>(-10, "29"));
+    HALVOE_CHECK(numberEncodesTo<int64_t>(-100, "3863"));
+    HALVOE_CHECK(numberEncodesTo<int64_t>(-1000, "3903e7"));
+    HALVOE_CHECK(numberEncodesTo<int64_t>(INT64_MIN, "3b7fffffffffffffff"));
+    HALVOE_CHECK(numberEncodesTo<int8_t>(-128, "387f"));
+    HALVOE_CHECK(numberEncodesTo<uint16_t>(65535, "19ffff"));
+
+    // -18446744073709551616 only fits into a floating point value.
+    HALVOE_CHECK(decodesTo<double>("3bffffffffffffffff", -18446744073709551616.0));
+
+    // Out of range and mismatched reads fail without advancing.
+    fromHex("3bffffffffffffffff1903e8f5");
+    CborDeserializer<13> deserializer(g_expected.data());
+    HALVOE_CHECK(deserializer.read<int64_t>() == INT64_MAX && deserializer.getBytesRead() == 0);
+    HALVOE_CHECK(deserializer.read<uint64_t>() == UINT64_MAX && deserializer.getBytesRead() == 0);
+    HALVOE_CHECK(deserializer.skip() && deserializer.getBytesRead() == 9);
+    HALVOE_CHECK(deserializer.read<uint8_t>() == UINT8_MAX && deserializer.getBytesRead() == 9);
+    HALVOE_CHECK(deserializer.read<int8_t>() == INT8_MAX && deserializer.getBytesRead() == 9);
+    HALVOE_CHECK(deserializer.read<bool>() == true && deserializer.getBytesRead() == 9); // true is also the max() of bool
+    HALVOE_CHECK(deserializer.read<uint16_t>() == 1000);
+    HALVOE_CHECK(deserializer.read<uint8_t>() == UINT8_MAX && deserializer.read<bool>() == true && deserializer.getBytesLeft() == 0);
+  }
+
+  void checkFloats()
+  {
+    const double infinity = std::numeric_limits<double>::infinity();
+    const double nan = std::numeric_limits<double>::quiet_NaN();
+
+    HALVOE_CHECK(numberEncodesTo(0.0, "f90000"));
+    HALVOE_CHECK(numberEncodesTo(-0.0, "f98000"));
+    HALVOE_CHECK(numberEncodesTo(1.0, "f93c00"));
+    HALVOE_CHECK(numberEncodesTo(1.1, "fb3ff199999999999a"));
+    HALVOE_CHECK(numberEncodesTo(1.5, "f93e00"));
+    HALVOE_CHECK(numberEncodesTo(65504.0, "f97bff"));
+    HALVOE_CHECK(numberEncodesTo(100000.0, "fa47c35000"));
+    HALVOE_CHECK(numberEncodesTo(3.4028234663852886e+38, "fa7f7fffff"));
+    HALVOE_CHECK(numberEncodesTo(1.0e+300, "fb7e37e43c8800759c"));
+    HALVOE_CHECK(numberEncodesTo(5.960464477539063e-8, "f90001"));
+    HALVOE_CHECK(numberEncodesTo(0.00006103515625, "f90400"));
+    HALVOE_CHECK(numberEncodesTo(-4.0, "f9c400"));
+    HALVOE_CHECK(numberEncodesTo(-4.1, "fbc010666666666666"));
+    HALVOE_CHECK(numberEncodesTo(infinity, "f97c00"));
+    HALVOE_CHECK(numberEncodesTo(nan, "f97e00"));
+    HALVOE_CHECK(numberEncodesTo(-infinity, "f9fc00"));
+    HALVOE_CHECK(numberEncodesTo(1.5f, "f93e00"));
+    HALVOE_CHECK(numberEncodesTo(100000.0f, "fa47c35000"));
+
+    // The longer encodings of the same values decode as well.
+    HALVOE_CHECK(decodesTo("fa7f800000", infinity));
+    HALVOE_CHECK(decodesTo("fa7fc00000", nan));
+    HALVOE_CHECK(decodesTo("faff800000", -infinity));
+    HALVOE_CHECK(decodesTo("fb7ff0000000000000", infinity));
+    HALVOE_CHECK(decodesTo("fb7ff8000000000000", nan));
+    HALVOE_CHECK(decodesTo("fbfff0000000000000", -infinity));
+    HALVOE_CHECK(decodesTo("f97bff", 65504.0f));
+
+    // Integers are accepted where a floating point value is read.
+    HALVOE_CHECK(decodesTo("3903e7", -1000.0));
+    HALVOE_CHECK(decodesTo("1b000000e8d4a51000", 1000000000000.0f));
+  }
+
+  void checkHalfPrecision()
+  {
+    // Every half precision value converts to float and back to the same bits; NaNs become the canonical NaN.
+    size_t mismatchCount = 0;
+    for (uint32_t bits = 0; bits <= 0xffff; ++bits)
+    {
+      const uint16_t half = static_cast<uint16_t>(bits);
+      const double value = cbor::fromHalf(half);
+      const bool isNan = (half & 0x7c00) == 0x7c00 && (half & 0x03ff) != 0;
+      uint16_t roundTrip = 0;
+      if (!cbor::toHalf(static_cast<float>(value), roundTrip)) { ++mismatchCount; continue; }
+      if (isNan ? (value == value || roundTrip != ((half & 0x8000) | 0x7e00)) : roundTrip != half) { ++mismatchCount; }
+    }
+    HALVOE_CHECK(mismatchCount == 0);
+
+    // Values between halves, or out of the half range, stay single precision.
+    uint16_t half = 0;
+    HALVOE_CHECK(!cbor::toHalf(1.0f + 1.0f / 2048.0f, half));
+    HALVOE_CHECK(!cbor::toHalf(65520.0f, half));
+    HALVOE_CHECK(!cbor::toHalf(std::ldexp(1.0f, -25), half));
+    HALVOE_CHECK(!cbor::toHalf(std::ldexp(3.0f, -25), half));
+    HALVOE_CHECK(cbor::toHalf(std::ldexp(3.0f, -24), half) && half == 0x0003);
+    HALVOE_CHECK(cbor::toHalf(std::ldexp(1.0f, -14), half) && half == 0x0400);
+    HALVOE_CHECK(cbor::toHalf(std::ldexp(1023.0f, -24), half) && half == 0x03ff);
+  }
+
+  void checkSimpleValuesAndStrings()
+  {
+    HALVOE_CHECK(numberEncodesTo(false, "f4"));
+    HALVOE_CHECK(numberEncodesTo(true, "f5"));
+    HALVOE_CHECK(encodesTo([](CborSerializer<c_bufferSize>& out_serializer) { return out_serializer.writeNull(); }, "f6"));
+    HALVOE_CHECK(encodesTo([](CborSerializer<c_bufferSize>& out_serializer) { return out_serializer.writeUndefined(); }, "f7"));
+
+    HALVOE_CHECK(encodesTo([](CborSerializer<c_bufferSize>& out_serializer) { return out_serializer.write("", static_cast<uint8_t>(0)); }, "60"));
+    HALVOE_CHECK(encodesTo([](CborSerializer<c_bufferSize>& out_serializer) { return out_serializer.write("a", static_cast<uint8_t>(1)); }, "6161"));
+    HALVOE_CHECK(encodesTo([](CborSerializer<c_bufferSize>& out_serializer) { return out_serializer.write("IETF", static_cast<uint8_t>(4)); }, "6449455446"));
+    HALVOE_CHECK(encodesTo([](CborSerializer<c_bufferSize>& out_serializer) { return out_serializer.write("\"\\", static_cast<uint8_t>(2)); }, "62225c"));
+    HALVOE_CHECK(encodesTo([](CborSerializer<c_bufferSize>& out_serializer) { return out_serializer.write("\xc3\xbc", static_cast<uint8_t>(2)); }, "62c3bc"));
+    HALVOE_CHECK(encodesTo([](CborSerializer<c_bufferSize>& out_serializer) { return out_serializer.write("\xe6\xb0\xb4", static_cast<uint8_t>(3)); }, "63e6b0b4"));
+    HALVOE_CHECK(encodesTo([](CborSerializer<c_bufferSize>& out_serializer) { return out_serializer.writeBytes(nullptr, 0); }, "40"));
+    const uint8_t bytes[] = { 0x01, 0x02, 0x03, 0x04 };
+    HALVOE_CHECK(encodesTo([&bytes](CborSerializer<c_bufferSize>& out_serializer) { return out_serializer.writeBytes(bytes, 4); }, "4401020304"));
+
+    // A 24 byte string needs the one byte length.
+    const char text[] = "abcdefghijklmnopqrstuvwx";
+    HALVOE_CHECK(encodesTo([&text](CborSerializer<c_bufferSize>& out_serializer) { return out_serializer.write(text, static_cast<uint8_t>(24)); },
+                           "78186162636465666768696a6b6c6d6e6f707172737475767778"));
+
+    CborDeserializer<c_bufferSize> deserializer(g_buffer);
+    uint8_t size = 0;
+    HALVOE_CHECK(deserializer.view(size) == reinterpret_cast<const char*>(g_buffer.data() + 2) && size == 24);
+
+    fromHex("6449455446f54401020304");
+    CborDeserializer<11> reader(g_expected.data());
+    HALVOE_CHECK(reader.read<uint8_t>() == UINT8_MAX && reader.getBytesRead() == 0);
+    HALVOE_CHECK(reader.view(size) == reinterpret_cast<const char*>(g_expected.data() + 1) && size == 4);
+    HALVOE_CHECK(reader.view(size) == nullptr && reader.read<bool>() == true && reader.getBytesRead() == 6);
+    CborItem item;
+    HALVOE_CHECK(reader.view(size) == nullptr && reader.next(item) && item.type == CborType::byteString && item.argument == 4 && item.data == g_expected.data() + 7);
+
+    // A string cut off by the end of the buffer is incomplete.
+    CborDeserializer<4> truncated(g_expected.data());
+    HALVOE_CHECK(truncated.view(size) == nullptr && !truncated.next(item) && truncated.getBytesRead() == 0);
+  }
+
+  void checkTags()
+  {
+    HALVOE_CHECK(encodesTo([](CborSerializer<c_bufferSize>& out_serializer) { return out_serializer.writeTag(1) && out_serializer.write<uint32_t>(1363896240); }, "c11a514b67b0"));
+    HALVOE_CHECK(encodesTo([](CborSerializer<c_bufferSize>& out_serializer) { return out_serializer.writeTag(1) && out_serializer.write(1363896240.5); }, "c1fb41d452d9ec200000"));
+    const uint8_t bytes[] = { 0x01, 0x02, 0x03, 0x04 };
+    HALVOE_CHECK(encodesTo([&bytes](CborSerializer<c_bufferSize>& out_serializer) { return out_serializer.writeTag(23) && out_serializer.writeBytes(bytes, 4); }, "d74401020304"));
+    HALVOE_CHECK(encodesTo([](CborSerializer<c_bufferSize>& out_serializer) { return out_serializer.writeTag(32) && out_serializer.write("http://www.example.com", static_cast<uint8_t>(22)); },
+                           "d82076687474703a2f2f7777772e6578616d706c652e636f6d"));
+
+    CborDeserializer<c_bufferSize> deserializer(g_buffer);
+    CborItem item;
+    HALVOE_CHECK(deserializer.next(item) && item.type == CborType::tag && item.argument == 32);
+    HALVOE_CHECK(deserializer.next(item) && item.type == CborType::textString && item.argument == 22);
+
+    // skip() takes the tag and its content.
+    CborDeserializer<c_bufferSize> skipper(g_buffer);
+    HALVOE_CHECK(skipper.skip() && skipper.getBytesRead() == 25);
+  }
+
+  void checkContainers()
+  {
+    HALVOE_CHECK(encodesTo([](CborSerializer<c_bufferSize>& out_serializer) { return out_serializer.writeArrayHeader(0); }, "80"));
+    HALVOE_CHECK(encodesTo([](CborSerializer<c_bufferSize>& out_serializer)
+    {
+      return out_serializer.writeArrayHeader(3) && out_serializer.write(1) && out_serializer.write(2) && out_serializer.write(3);
+    }, "83010203"));
+    HALVOE_CHECK(encodesTo([](CborSerializer<c_bufferSize>& out_serializer)
+    {
+      return out_serializer.writeArrayHeader(3) && out_serializer.write(1) &&
+             out_serializer.writeArrayHeader(2) && out_serializer.write(2) && out_serializer.write(3) &&
+             out_serializer.writeArrayHeader(2) && out_serializer.write(4) && out_serializer.write(5);
+    }, "8301820203820405"));
+    HALVOE_CHECK(encodesTo([](CborSerializer<c_bufferSize>& out_serializer)
+    {
+      bool isWritten = out_serializer.writeArrayHeader(25);
+      for (int value = 1; value <= 25; ++value) { isWritten = isWritten && out_serializer.write(value); }
+      return isWritten;
+    }, "98190102030405060708090a0b0c0d0e0f101112131415161718181819"));
+    HALVOE_CHECK(encodesTo([](CborSerializer<c_bufferSize>& out_serializer) { return out_serializer.writeMapHeader(0); }, "a0"));
+    HALVOE_CHECK(encodesTo([](CborSerializer<c_bufferSize>& out_serializer)
+    {
+      return out_serializer.writeMapHeader(2) && out_serializer.write(1) && out_serializer.write(2) && out_serializer.write(3) && out_serializer.write(4);
+    }, "a201020304"));
+    HALVOE_CHECK(encodesTo([](CborSerializer<c_bufferSize>& out_serializer)
+    {
+      return out_serializer.writeMapHeader(2) && out_serializer.write("a", static_cast<uint8_t>(1)) && out_serializer.write(1) &&
+             out_serializer.write("b", static_cast<uint8_t>(1)) && out_serializer.writeArrayHeader(2) && out_serializer.write(2) && out_serializer.write(3);
+    }, "a26161016162820203"));
+
+    // Pull decoding of {"a": 1, "b": [2, 3]} item by item.
+    CborDeserializer<c_bufferSize> deserializer(g_buffer);
+    CborItem item;
+    uint8_t size = 0;
+    HALVOE_CHECK(deserializer.next(item) && item.type == CborType::map && item.argument == 2 && !item.isIndefinite);
+    HALVOE_CHECK(deserializer.view(size) != nullptr && size == 1 && deserializer.read<int>() == 1);
+    HALVOE_CHECK(deserializer.view(size) != nullptr && deserializer.next(item) && item.type == CborType::array && item.argument == 2);
+    HALVOE_CHECK(deserializer.read<int>() == 2 && deserializer.read<int>() == 3 && deserializer.getBytesRead() == 9);
+  }
+
+  void checkIndefiniteLengths()
+  {
+    const uint8_t first[] = { 0x01, 0x02 };
+    const uint8_t second[] = { 0x03, 0x04, 0x05 };
+    HALVOE_CHECK(encodesTo([&](CborSerializer<c_bufferSize>& out_serializer)
+    {
+      return out_serializer.beginIndefiniteBytes() && out_serializer.writeBytes(first, 2) && out_serializer.writeBytes(second, 3) && out_serializer.writeBreak();
+    }, "5f42010243030405ff"));
+    HALVOE_CHECK(encodesTo([](CborSerializer<c_bufferSize>& out_serializer)
+    {
+      return out_serializer.beginIndefiniteText() && out_serializer.write("strea", static_cast<uint8_t>(5)) &&
+             out_serializer.write("ming", static_cast<uint8_t>(4)) && out_serializer.writeBreak();
+    }, "7f657374726561646d696e67ff"));
+    HALVOE_CHECK(encodesTo([](CborSerializer<c_bufferSize>& out_serializer) { return out_serializer.beginIndefiniteArray() && out_serializer.writeBreak(); }, "9fff"));
+    HALVOE_CHECK(encodesTo([](CborSerializer<c_bufferSize>& out_serializer)
+    {
+      return out_serializer.beginIndefiniteArray() && out_serializer.write(1) &&
+             out_serializer.writeArrayHeader(2) && out_serializer.write(2) && out_serializer.write(3) &&
+             out_serializer.beginIndefiniteArray() && out_serializer.write(4) && out_serializer.write(5) && out_serializer.writeBreak() &&
+             out_serializer.writeBreak();
+    }, "9f018202039f0405ffff"));
+    HALVOE_CHECK(encodesTo([](CborSerializer<c_bufferSize>& out_serializer)
+    {
+      return out_serializer.beginIndefiniteMap() && out_serializer.write("a", static_cast<uint8_t>(1)) && out_serializer.write(1) &&
+             out_serializer.write("b", static_cast<uint8_t>(1)) && out_serializer.beginIndefiniteArray() && out_serializer.write(2) &&
+             out_serializer.write(3) && out_serializer.writeBreak() && out_serializer.writeBreak();
+    }, "bf61610161629f0203ffff"));
+
+    // Nested indefinite items are skipped as a whole, and a missing break is incomplete.
+    CborDeserializer<11> deserializer(g_buffer.data());
+    HALVOE_CHECK(deserializer.skip() && deserializer.getBytesLeft() == 0);
+    CborDeserializer<10> truncated(g_buffer.data());
+    HALVOE_CHECK(!truncated.skip() && truncated.getBytesRead() == 0);
+
+    CborDeserializer<11> reader(g_buffer.data());
+    CborItem item;
+    HALVOE_CHECK(reader.next(item) && item.type == CborType::map && item.isIndefinite);
+    HALVOE_CHECK(reader.skip() && reader.skip() && reader.skip() && !reader.isBreak());
+    HALVOE_CHECK(reader.skip() && reader.isBreak() && reader.next(item) && item.type == CborType::breakStop && reader.getBytesLeft() == 0);
+
+    // Indefinite integers and a lone break are malformed.
+    fromHex("1fff");
+    CborDeserializer<2> malformed(g_expected.data());
+    HALVOE_CHECK(!malformed.next(item) && !malformed.skip());
+  }
+
+  void checkEncodingModes()
+  {
+    // Fast keeps the C++ width of floats.
+    HALVOE_CHECK(encodesTo<CborEncoding::fast>([](CborSerializer<c_bufferSize, CborEncoding::fast>& out_serializer) { return out_serializer.write(1.0f); }, "fa3f800000"));
+    HALVOE_CHECK(encodesTo<CborEncoding::fast>([](CborSerializer<c_bufferSize, CborEncoding::fast>& out_serializer) { return out_serializer.write(1.0); }, "fb3ff0000000000000"));
+    HALVOE_CHECK(encodesTo<CborEncoding::fast>([](CborSerializer<c_bufferSize, CborEncoding::fast>& out_serializer) { return out_serializer.beginIndefiniteArray() && out_serializer.writeBreak(); }, "9fff"));
+
+    // Deterministic shortens floats like preferred, and rejects every indefinite length item without writing.
+    using DeterministicSerializer = CborSerializer<c_bufferSize, CborEncoding::deterministic>;
+    HALVOE_CHECK(encodesTo<CborEncoding::deterministic>([](DeterministicSerializer& out_serializer) { return out_serializer.write(1.0); }, "f93c00"));
+    HALVOE_CHECK(encodesTo<CborEncoding::deterministic>([](DeterministicSerializer& out_serializer) { return out_serializer.write(100000.0); }, "fa47c35000"));
+    HALVOE_CHECK(encodesTo<CborEncoding::deterministic>([](DeterministicSerializer& out_serializer) { return out_serializer.write(1000000); }, "1a000f4240"));
+    HALVOE_CHECK(encodesTo<CborEncoding::deterministic>([](DeterministicSerializer& out_serializer)
+    {
+      return out_serializer.writeMapHeader(2) && out_serializer.write(1) && out_serializer.write(2) && out_serializer.write(3) && out_serializer.write(4);
+    }, "a201020304"));
+
+    g_buffer.fill(0x55);
+    DeterministicSerializer serializer(g_buffer);
+    HALVOE_CHECK(!serializer.beginIndefiniteArray() && !serializer.beginIndefiniteMap());
+    HALVOE_CHECK(!serializer.beginIndefiniteText() && !serializer.beginIndefiniteBytes() && !serializer.writeBreak());
+    HALVOE_CHECK(serializer.getBytesWritten() == 0 && g_buffer[0] == 0x55);
+  }
+
+  void checkFullBuffer()
+  {
+    std::array<uint8_t, 3> small{};
+    CborSerializer<3> serializer(small);
+    HALVOE_CHECK(!serializer.write<uint32_t>(65536) && serializer.getBytesWritten() == 0);
+    HALVOE_CHECK(!serializer.write("abc", static_cast<uint8_t>(3)) && serializer.getBytesWritten() == 0);
+    HALVOE_CHECK(serializer.write<uint32_t>(65535) && serializer.getBytesLeft() == 0);
+    HALVOE_CHECK(!serializer.writeNull());
+  }
+}
+
+int main()
+{
+  checkIntegers();
+  checkFloats();
+  checkHalfPrecision();
+  checkSimpleValuesAndStrings();
+  checkTags();
+  checkContainers();
+  checkIndefiniteLengths();
+  checkEncodingModes();
+  checkFullBuffer();
+  return test::finishTest("test_cbor");
+}
@@ -0,0 +1,197 @@
+#include <array>
+#include <cstring>
+
+#include "ChaCha20Poly1305.hpp"
+#include "Test.hpp"
+
+// **** **** **** ****
+// NOTE: Checks ChaCha20-Poly1305 against RFC 8439: the ChaCha20 encryption vector of section 2.4.2 through
+//       the scalar path and (embedded in a longer buffer) through the four block SSE2 path, the AEAD vector
+//       of section 2.8.2 and the rejection of tampered frames, which must leave the buffer unchanged.
+// **** **** **** ****
+
+using namespace halvoe;
+
+namespace
+{
+  const char c_sunscreen[] = "Ladies and Gentlemen of the class of '99: If I could offer you only one tip for the future, sunscreen would be it.";
+  constexpr size_t c_sunscreenSize = sizeof(c_sunscreen) - 1;
+
+  // RFC 8439 2.4.2: key 00..1f, nonce 00 00 00 00 00 00 00 4a 00 00 00 00, block counter 1.
+  const uint8_t c_keyStreamCipherText[c_sunscreenSize] = {
+    0x6e, 0x2e, 0x35, 0x9a, 0x25, 0x68, 0xf9, 0x80, 0x41, 0xba, 0x07, 0x28, 0xdd, 0x0d, 0x69, 0x81,
+    0xe9, 0x7e, 0x7a, 0xec, 0x1d, 0x43, 0x60, 0xc2, 0x0a, 0x27, 0xaf, 0xcc, 0xfd, 0x9f, 0xae, 0x0b,
+    0xf9, 0x1b, 0x65, 0xc5, 0x52, 0x47, 0x33, 0xab, 0x8f, 0x59, 0x3d, 0xab, 0xcd, 0x62, 0xb3, 0x57,
+    0x16, 0x39, 0xd6, 0x24, 0xe6, 0x51, 0x52, 0xab, 0x8f, 0x53, 0x0c, 0x35, 0x9f, 0x08, 0x61, 0xd8,
+    0x07, 0xca, 0x0d, 0xbf, 0x50, 0x0d, 0x6a, 0x61, 0x56, 0xa3, 0x8e, 0x08, 0x8a, 0x22, 0xb6, 0x5e,
+    0x52, 0xbc, 0x51, 0x4d, 0x16, 0xcc, 0xf8, 0x06, 0x81, 0x8c, 0xe9, 0x1a, 0xb7, 0x79, 0x37, 0x36,
+    0x5a, 0xf9, 0x0b, 0xbf, 0x74, 0xa3, 0x5b, 0xe6, 0xb4, 0x0b, 0x8e, 0xed, 0xf2, 0x78, 0x5e, 0x42,
+    0x87, 0x4d
+  };
+
+  // RFC 8439 2.8.2: key 80..9f, nonce 07 00 00 00 40 41 42 43 44 45 46 47.
+  const uint8_t c_associatedData[] = { 0x50, 0x51, 0x52, 0x53, 0xc0, 0xc1, 0xc2, 0xc3, 0xc4, 0xc5, 0xc6, 0xc7 };
+
+  const uint8_t c_aeadCipherText[c_sunscreenSize] = {
+    0xd3, 0x1a, 0x8d, 0x34, 0x64, 0x8e, 0x60, 0xdb, 0x7b, 0x86, 0xaf, 0xbc, 0x53, 0xef, 0x7e, 0xc2,
+    0xa4, 0xad, 0xed, 0x51, 0x29, 0x6e, 0x08, 0xfe, 0xa9, 0xe2, 0xb5, 0xa7, 0x36, 0xee, 0x62, 0xd6,
+    0x3d, 0xbe, 0xa4, 0x5e, 0x8c, 0xa9, 0x67, 0x12, 0x82, 0xfa, 0xfb, 0x69, 0xda, 0x92, 0x72, 0x8b,
+    0x1a, 0x71, 0xde, 0x0a, 0x9e, 0x06, 0x0b, 0x29, 0x05, 0xd6, 0xa5, 0xb6, 0x7e, 0xcd, 0x3b, 0x36,
+    0x92, 0xdd, 0xbd, 0x7f, 0x2d, 0x77, 0x8b, 0x8c, 0x98, 0x03, 0xae, 0xe3, 0x28, 0x09, 0x1b, 0x58,
+    0xfa, 0xb3, 0x24, 0xe4, 0xfa, 0xd6, 0x75, 0x94, 0x55, 0x85, 0x80, 0x8b, 0x48, 0x31, 0xd7, 0xbc,
+    0x3f, 0xf4, 0xde, 0xf0, 0x8e, 0x4b, 0x7a, 0x9d, 0xe5, 0x76, 0xd2, 0x65, 0x86, 0xce, 0xc6, 0x4b,
+    0x61, 0x16
+  };
+
+  const uint8_t c_aeadTag[c_chaChaTagSize] = { 0x1a, 0xe1, 0x0b, 0x59, 0x4f, 0x09, 0xe2, 0x6a, 0x7e, 0x90, 0x2e, 0xcb, 0xd0, 0x60, 0x06, 0x91 };
+
+  ChaChaKey getKey(uint8_t in_first)
+  {
+    ChaChaKey key;
+    for (size_t index = 0; index < key.size(); ++index) { key[index] = static_cast<uint8_t>(in_first + index); }
+    return key;
+  }
+
+  const ChaChaNonce c_keyStreamNonce = {{ 0, 0, 0, 0, 0, 0, 0, 0x4a, 0, 0, 0, 0 }};
+  const ChaChaNonce c_aeadNonce = {{ 0x07, 0, 0, 0, 0x40, 0x41, 0x42, 0x43, 0x44, 0x45, 0x46, 0x47 }};
+
+  void checkKeyStream()
+  {
+    const ChaChaKey key = getKey(0);
+
+    // Shorter than four blocks: apply() takes the scalar path only.
+    uint8_t data[c_sunscreenSize];
+    std::memcpy(data, c_sunscreen, c_sunscreenSize);
+    chacha20::apply(key, 1, c_keyStreamNonce, data, c_sunscreenSize);
+    HALVOE_CHECK(std::memcmp(data, c_keyStreamCipherText, c_sunscreenSize) == 0);
+
+    uint32_t state[16];
+    std::memcpy(data, c_sunscreen, c_sunscreenSize);
+    chacha20::initialise(state, key, 1, c_keyStreamNonce);
+    chacha20::applyScalar(state, data, c_sunscreenSize);
+    HALVOE_CHECK(std::memcmp(data, c_keyStreamCipherText, c_sunscreenSize) == 0);
+    HALVOE_CHECK(state[12] == 3);
+
+    // The same vector at the start of five blocks: the first four go through the SSE2 path, if enabled.
+    uint8_t longData[5 * chacha20::c_blockSize] = {};
+    std::memcpy(longData, c_sunscreen, c_sunscreenSize);
+    chacha20::apply(key, 1, c_keyStreamNonce, longData, sizeof(longData));
+    HALVOE_CHECK(std::memcmp(longData, c_keyStreamCipherText, c_sunscreenSize) == 0);
+  }
+
+  // apply() (four blocks at a time plus the scalar tail) must match applyScalar() for every length.
+  void checkPathsAgree()
+  {
+    const ChaChaKey key = getKey(0x20);
+    static uint8_t expected[1100];
+    static uint8_t actual[1100];
+
+    for (size_t size = 0; size <= sizeof(expected); ++size)
+    {
+      for (size_t index = 0; index < size; ++index) { expected[index] = static_cast<uint8_t>(index * 7 + size); }
+      std::memcpy(actual, expected, size);
+
+      uint32_t state[16];
+      chacha20::initialise(state, key, 0xfffffffe, c_aeadNonce); // the block counter wraps within the first blocks
+      chacha20::applyScalar(state, expected, size);
+      chacha20::apply(key, 0xfffffffe, c_aeadNonce, actual, size);
+      if (!HALVOE_CHECK(std::memcmp(expected, actual, size) == 0)) { std::printf("  size %zu\n", size); break; }
+    }
+  }
+
+  void checkAead()
+  {
+    const ChaChaKey key = getKey(0x80);
+    uint8_t buffer[c_sunscreenSize + c_chaChaTagSize];
+    std::memcpy(buffer, c_sunscreen, c_sunscreenSize);
+
+    HALVOE_CHECK(sealChaCha20Poly1305(buffer, c_sunscreenSize, sizeof(buffer) - 1, key, c_aeadNonce, c_associatedData, sizeof(c_associatedData)) == 0);
+    HALVOE_CHECK(std::memcmp(buffer, c_sunscreen, c_sunscreenSize) == 0);
+
+    HALVOE_CHECK(sealChaCha20Poly1305(buffer, c_sunscreenSize, sizeof(buffer), key, c_aeadNonce, c_associatedData, sizeof(c_associatedData)) == sizeof(buffer));
+    HALVOE_CHECK(std::memcmp(buffer, c_aeadCipherText, c_sunscreenSize) == 0);
+    HALVOE_CHECK(std::memcmp(buffer + c_sunscreenSize, c_aeadTag, c_chaChaTagSize) == 0);
+
+    size_t size = 0;
+    HALVOE_CHECK(openChaCha20Poly1305(buffer, sizeof(buffer), key, c_aeadNonce, size, c_associatedData, sizeof(c_associatedData)));
+    HALVOE_CHECK(size == c_sunscreenSize && std::memcmp(buffer, c_sunscreen, c_sunscreenSize) == 0);
+  }
+
+  void checkTamperedFrames()
+  {
+    const ChaChaKey key = getKey(0x80);
+    uint8_t sealed[c_sunscreenSize + c_chaChaTagSize];
+    std::memcpy(sealed, c_aeadCipherText, c_sunscreenSize);
+    std::memcpy(sealed + c_sunscreenSize, c_aeadTag, c_chaChaTagSize);
+
+    // Every flipped bit of the cipher text or tag is rejected and leaves the buffer as it was.
+    size_t rejectedCount = 0;
+    for (size_t index = 0; index < sizeof(sealed); ++index)
+    {
+      for (uint8_t bit = 0; bit < 8; ++bit)
+      {
+        uint8_t tampered[sizeof(sealed)];
+        std::memcpy(tampered, sealed, sizeof(sealed));
+        tampered[index] = tampered[index] ^ static_cast<uint8_t>(1u << bit);
+        uint8_t copy[sizeof(sealed)];
+        std::memcpy(copy, tampered, sizeof(sealed));
+
+        size_t size = 0;
+        if (!openChaCha20Poly1305(tampered, sizeof(tampered), key, c_aeadNonce, size, c_associatedData, sizeof(c_associatedData)) &&
+            std::memcmp(tampered, copy, sizeof(sealed)) == 0)
+        {
+          ++rejectedCount;
+        }
+      }
+    }
+    HALVOE_CHECK(rejectedCount == sizeof(sealed) * 8);
+
+    // Other associated data, another nonce or a truncated frame are rejected as well.
+    uint8_t associatedData[sizeof(c_associatedData)];
+    std::memcpy(associatedData, c_associatedData, sizeof(associatedData));
+    associatedData[0] = associatedData[0] ^ 1;
+    ChaChaNonce nonce = c_aeadNonce;
+    nonce[11] = nonce[11] ^ 1;
+
+    size_t size = 0;
+    uint8_t copy[sizeof(sealed)];
+    std::memcpy(copy, sealed, sizeof(sealed));
+    HALVOE_CHECK(!openChaCha20Poly1305(sealed, sizeof(sealed), key, c_aeadNonce, size, associatedData, sizeof(associatedData)));
+    HALVOE_CHECK(!openChaCha20Poly1305(sealed, sizeof(sealed), key, c_aeadNonce, size));
+    HALVOE_CHECK(!openChaCha20Poly1305(sealed, sizeof(sealed), key, nonce, size, c_associatedData, sizeof(c_associatedData)));
+    HALVOE_CHECK(!openChaCha20Poly1305(sealed, sizeof(sealed) - 1, key, c_aeadNonce, size, c_associatedData, sizeof(c_associatedData)));
+    HALVOE_CHECK(!openChaCha20Poly1305(sealed, c_chaChaTagSize - 1, key, c_aeadNonce, size));
+    HALVOE_CHECK(std::memcmp(sealed, copy, sizeof(sealed)) == 0);
+  }
+
+  void checkSerializerFrame()
+  {
+    const ChaChaKey key = getKey(0x40);
+    std::array<uint8_t, 64> buffer{};
+    Serializer<64> serializer(buffer);
+    serializer.write<uint32_t>(42);
+    serializer.write<double>(2.5);
+
+    const size_t frameSize = sealChaCha20Poly1305(serializer, key, c_aeadNonce);
+    HALVOE_CHECK(frameSize == serializer.getBytesWritten() + c_chaChaTagSize);
+
+    size_t size = 0;
+    HALVOE_CHECK(openChaCha20Poly1305(buffer.data(), frameSize, key, c_aeadNonce, size) && size == serializer.getBytesWritten());
+    Deserializer<64> deserializer(buffer);
+    HALVOE_CHECK(deserializer.read<uint32_t>() == 42 && deserializer.read<double>() == 2.5);
+  }
+}
+
+int main()
+{
+#if defined(__SSE2__)
+  std::printf("test_chacha20poly1305: SSE2 path enabled\n");
+#endif
+
+  checkKeyStream();
+  checkPathsAgree();
+  checkAead();
+  checkTamperedFrames();
+  checkSerializerFrame();
+  return test::finishTest("test_chacha20poly1305");
+}
@@ -0,0 +1,94 @@
+#include <array>
+#include <cstring>
+
+#include "BasicSerializer.hpp"
+#include "MessageProfiler.hpp"
+#include "SerializationCache.hpp"
+#include "Test.hpp"
+
+// **** **** **** ****
+// NOTE: Checks a CursorType that is exactly as wide as the buffer: Serializer<255, uint8_t> and
+//       Deserializer<255, uint8_t> work up to byte 255 and reject everything past it without moving the
+//       cursor, and ProfilingSerializer and SerializationCache pass the CursorType through.
+//       Built with -DHALVOE_EXPECT_STATIC_ASSERT, this file must not compile: the Makefile's check target
+//       tests that the static_assert for a CursorType too narrow for tc_bufferSize fires.
+// **** **** **** ****
+
+using namespace halvoe;
+
+namespace
+{
+#if defined(HALVOE_EXPECT_STATIC_ASSERT)
+  std::array<uint8_t, 256> g_tooLargeBuffer;
+  Serializer<256, uint8_t> g_tooLarge(g_tooLargeBuffer);
+#endif
+
+  constexpr size_t c_bufferSize = 255;
+  // A string that leaves exactly one uint8_t field in the buffer.
+  constexpr size_t c_fillSize = c_bufferSize - 2 * (c_typeTagSize + 1);
+
+  bool fill(Serializer<c_bufferSize, uint8_t>& io_serializer)
+  {
+    char text[c_fillSize];
+    std::memset(text, 'c', sizeof(text));
+    return io_serializer.write(text, static_cast<uint8_t>(c_fillSize)) && io_serializer.getBytesLeft() == c_typeTagSize + 1;
+  }
+
+  void checkLastByte()
+  {
+    std::array<uint8_t, c_bufferSize + 1> buffer{};
+    buffer[c_bufferSize] = 0xa5; // guard behind the buffer
+    Serializer<c_bufferSize, uint8_t> serializer(buffer.data());
+    HALVOE_CHECK(fill(serializer));
+    HALVOE_CHECK(serializer.write<uint8_t>(0x42) && serializer.getBytesWritten() == c_bufferSize && serializer.getBytesLeft() == 0);
+
+    // The cursor is at std::numeric_limits<uint8_t>::max(): nothing more fits, and it does not wrap to 0.
+    HALVOE_CHECK(!serializer.write<uint8_t>(1) && !serializer.write<bool>(true) && serializer.skip<uint8_t>().isNull());
+    const uint8_t values[1] = { 1 };
+    HALVOE_CHECK(!serializer.writeArray(values, 1) && !serializer.write("", static_cast<uint8_t>(0)));
+    HALVOE_CHECK(serializer.getBytesWritten() == c_bufferSize && buffer[c_bufferSize] == 0xa5);
+
+    Deserializer<c_bufferSize, uint8_t> deserializer(buffer.data());
+    uint8_t stringSize = 0;
+    HALVOE_CHECK(deserializer.view(stringSize) != nullptr && stringSize == c_fillSize);
+    HALVOE_CHECK(deserializer.read<uint8_t>() == 0x42 && deserializer.getBytesRead() == c_bufferSize);
+    HALVOE_CHECK(!deserializer.fitsInBuffer<uint8_t>() && !deserializer.skip<uint8_t>() && !deserializer.skipBytes(1));
+    HALVOE_CHECK(deserializer.view<uint8_t>().isNull() && deserializer.getBytesRead() == c_bufferSize);
+
+    // A field one byte too large for the rest of the buffer fails as a whole.
+    Serializer<c_bufferSize, uint8_t> wideSerializer(buffer.data());
+    HALVOE_CHECK(fill(wideSerializer) && !wideSerializer.write<uint16_t>(1) && wideSerializer.getBytesWritten() == c_bufferSize - c_typeTagSize - 1);
+  }
+
+  void checkProfilingSerializer()
+  {
+    MessageProfile<> profile;
+    std::array<uint8_t, c_bufferSize> buffer{};
+    Serializer<c_bufferSize, uint8_t> serializer(buffer);
+    ProfilingSerializer<c_bufferSize, uint8_t> profiler(serializer, profile);
+    HALVOE_CHECK(profiler.write<uint32_t>(7) && profiler.getBytesWritten() == c_typeTagSize + 4);
+    HALVOE_CHECK(profile.getFieldProfile(0).count == 1);
+  }
+
+  void checkSerializationCache()
+  {
+    SharedBufferPool<64, 1> pool;
+    SerializationCache<2> cache;
+    const uint32_t object = 0x01020304;
+    const SharedBuffer buffer = cache.getOrSerialize<uint8_t>(pool, &object, 1, [&object](Serializer<64, uint8_t>& out_serializer)
+    {
+      return out_serializer.write<uint32_t>(object);
+    });
+    HALVOE_CHECK(!buffer.isNull() && buffer.getSize() == c_typeTagSize + 4);
+    Deserializer<64, uint8_t> deserializer(buffer.getBuffer());
+    HALVOE_CHECK(deserializer.read<uint32_t>() == object);
+  }
+}
+
+int main()
+{
+  checkLastByte();
+  checkProfilingSerializer();
+  checkSerializationCache();
+  return test::finishTest("test_cursor_type");
+}
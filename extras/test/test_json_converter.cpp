@@ -0,0 +1,262 @@
+#include <array>
+#include <cstring>
+#include <random>
+#include <string>
+
+#include "JsonConverter.hpp"
+#include "JsonWriter.hpp"
+#include "Test.hpp"
+
+// **** **** **** ****
+// NOTE: Checks JsonConverter: JSON -> native frame -> JSON (writeJson) round trips of random records,
+//       escape and surrogate decoding, streams of records, and rejection (with the error offset) of
+//       out of order keys, missing and extra fields, numbers that overflow their field or are no JSON
+//       numbers, bad escapes and a full serializer.
+// **** **** **** ****
+
+using namespace halvoe;
+
+namespace
+{
+  const FieldDescriptor c_fields[] = { { "flag", FieldType::boolean }, { "i8", FieldType::int8 }, { "u8", FieldType::uint8 },
+                                       { "i16", FieldType::int16 }, { "u16", FieldType::uint16 }, { "i32", FieldType::int32 },
+                                       { "u32", FieldType::uint32 }, { "i64", FieldType::int64 }, { "u64", FieldType::uint64 },
+                                       { "f32", FieldType::float32 }, { "f64", FieldType::float64 }, { "s8", FieldType::string8 },
+                                       { "s16", FieldType::string16 } };
+  constexpr size_t c_fieldCount = sizeof(c_fields) / sizeof(c_fields[0]);
+
+  const FieldDescriptor c_pairFields[] = { { "a", FieldType::uint8 }, { "b", FieldType::string8 } };
+
+  using Frame = std::array<uint8_t, 512>;
+
+  // Converts in_json and writes the frame back as JSON; returns "<failed>" if either step fails.
+  std::string roundTrip(const FieldDescriptor* in_fields, size_t in_fieldCount, const std::string& in_json)
+  {
+    Frame frame;
+    Serializer<512> serializer(frame);
+    JsonConverter converter(in_fields, in_fieldCount);
+    if (converter.convert(in_json.data(), in_json.size(), serializer) != in_json.size()) { return "<failed>"; }
+
+    std::array<char, 2048> json;
+    Deserializer<512> deserializer(frame);
+    JsonWriter<2048> writer(json);
+    if (!writeJson(deserializer, in_fields, in_fieldCount, writer)) { return "<failed>"; }
+    if (deserializer.getBytesRead() != serializer.getBytesWritten()) { return "<size mismatch>"; }
+    return std::string(writer.getBuffer(), writer.getSize());
+  }
+
+  // Returns the error offset, or in_json.size() + 1, if the conversion unexpectedly succeeds.
+  size_t getErrorOffset(const FieldDescriptor* in_fields, size_t in_fieldCount, const std::string& in_json)
+  {
+    Frame frame;
+    Serializer<512> serializer(frame);
+    JsonConverter converter(in_fields, in_fieldCount);
+    if (converter.convert(in_json.data(), in_json.size(), serializer) != 0) { return in_json.size() + 1; }
+    return converter.getErrorOffset();
+  }
+
+  std::string makeRandomString(std::mt19937& io_generator, size_t in_maxSize)
+  {
+    const char alphabet[] = "abc XYZ 019 \"\\/\b\f\n\r\t\x01\x1f\x7f\xc3\xa4";
+    std::string string(io_generator() % (in_maxSize + 1), ' ');
+    for (char& character : string) { character = alphabet[io_generator() % (sizeof(alphabet) - 1)]; }
+    return string;
+  }
+
+  // Writes a random record with JsonWriter, so the text is in the form writeJson produces.
+  std::string makeRandomRecord(std::mt19937& io_generator)
+  {
+    std::array<char, 2048> json;
+    JsonWriter<2048> writer(json);
+    std::uniform_real_distribution<double> real(-1e6, 1e6);
+    const std::string s8 = makeRandomString(io_generator, 40);
+    const std::string s16 = makeRandomString(io_generator, 200); // decoded escaped strings are limited to the scratch buffer
+
+    writer.beginObject();
+    writer.key("flag"); writer.value(io_generator() % 2 == 0);
+    writer.key("i8"); writer.value(static_cast<int8_t>(io_generator()));
+    writer.key("u8"); writer.value(static_cast<uint8_t>(io_generator()));
+    writer.key("i16"); writer.value(static_cast<int16_t>(io_generator()));
+    writer.key("u16"); writer.value(static_cast<uint16_t>(io_generator()));
+    writer.key("i32"); writer.value(static_cast<int32_t>(io_generator()));
+    writer.key("u32"); writer.value(static_cast<uint32_t>(io_generator()));
+    writer.key("i64"); writer.value(static_cast<int64_t>((uint64_t{ io_generator() } << 32) | io_generator()));
+    writer.key("u64"); writer.value((uint64_t{ io_generator() } << 32) | io_generator());
+    writer.key("f32"); writer.value(io_generator() % 2 == 0 ? static_cast<float>(real(io_generator)) : static_cast<float>(io_generator() % 100000) / 100.0f);
+    writer.key("f64"); writer.value(real(io_generator));
+    writer.key("s8"); writer.value(s8.data(), s8.size());
+    writer.key("s16"); writer.value(s16.data(), s16.size());
+    writer.endObject();
+    return writer.isComplete() ? std::string(writer.getBuffer(), writer.getSize()) : std::string();
+  }
+
+  void checkRoundTrip()
+  {
+    std::mt19937 generator(107);
+    size_t mismatchCount = 0;
+    for (size_t index = 0; index < 2000; ++index)
+    {
+      const std::string json = makeRandomRecord(generator);
+      if (json.empty() || roundTrip(c_fields, c_fieldCount, json) != json) { mismatchCount = mismatchCount + 1; }
+    }
+    HALVOE_CHECK(mismatchCount == 0);
+
+    // Whitespace, other number forms and optional escapes come back in writeJson's form.
+    const std::string json = " {\n\t\"flag\" : true ,\"i8\":-128,\"u8\":255,\"i16\":-32768,\"u16\":65535,\"i32\":-2147483648,\"u32\":4294967295,"
+                             "\"i64\":-9223372036854775808,\"u64\":18446744073709551615,\"f32\":1.5E2,\"f64\":-0.0,"
+                             "\"s8\":\"\\/\\u0041\\u00e4\\u20ac\\ud83d\\ude00\",\"s16\":\"\"}\r\n";
+    HALVOE_CHECK(roundTrip(c_fields, c_fieldCount, json) ==
+                 "{\"flag\":true,\"i8\":-128,\"u8\":255,\"i16\":-32768,\"u16\":65535,\"i32\":-2147483648,\"u32\":4294967295,"
+                 "\"i64\":-9223372036854775808,\"u64\":18446744073709551615,\"f32\":150,\"f64\":-0,"
+                 "\"s8\":\"/A\xc3\xa4\xe2\x82\xac\xf0\x9f\x98\x80\",\"s16\":\"\"}");
+  }
+
+  void checkStream()
+  {
+    const std::string stream = "{\"a\":1,\"b\":\"x\"}\n{\"a\":2,\"b\":\"y\\n\"}\n  {\"a\":3,\"b\":\"\"}";
+    JsonConverter converter(c_pairFields, 2);
+    const char* json = stream.data();
+    size_t size = stream.size();
+    uint8_t expected = 1;
+
+    while (size > 0)
+    {
+      std::array<uint8_t, 64> frame;
+      Serializer<64> serializer(frame);
+      const size_t consumed = converter.convert(json, size, serializer);
+      if (!HALVOE_CHECK(consumed > 0)) { return; }
+
+      Deserializer<64> deserializer(frame);
+      HALVOE_CHECK(deserializer.read<uint8_t>() == expected);
+      json = json + consumed;
+      size = size - consumed;
+      expected = expected + 1;
+    }
+    HALVOE_CHECK(expected == 4);
+  }
+
+  void checkRejectedStructure()
+  {
+    // Keys have to appear in schema order, every field has to be present, and no other key may follow.
+    // A wrong key fails at its closing quote.
+    HALVOE_CHECK(getErrorOffset(c_pairFields, 2, "{\"b\":\"x\",\"a\":1}") == 3);
+    HALVOE_CHECK(getErrorOffset(c_pairFields, 2, "{\"a\":1}") == 6);
+    HALVOE_CHECK(getErrorOffset(c_pairFields, 2, "{\"a\":1,\"c\":\"x\"}") == 9);
+    HALVOE_CHECK(getErrorOffset(c_pairFields, 2, "{\"a\":1,\"b\":\"x\",\"c\":2}") == 14);
+    HALVOE_CHECK(getErrorOffset(c_pairFields, 2, "{\"a\":1,\"bb\":\"x\"}") == 10);
+    HALVOE_CHECK(getErrorOffset(c_pairFields, 2, "{\"a\":1,\"b\\u0000\":\"x\"}") == 15);
+    HALVOE_CHECK(getErrorOffset(c_pairFields, 2, "{\"a\" 1,\"b\":\"x\"}") == 5);
+    HALVOE_CHECK(getErrorOffset(c_pairFields, 2, "[\"a\",1]") == 0);
+    HALVOE_CHECK(getErrorOffset(c_pairFields, 2, "{\"a\":1,\"b\":\"x\"") == 14);
+    HALVOE_CHECK(getErrorOffset(c_pairFields, 2, "") == 0);
+
+    // A value of the wrong JSON type.
+    HALVOE_CHECK(getErrorOffset(c_pairFields, 2, "{\"a\":\"1\",\"b\":\"x\"}") == 5);
+    HALVOE_CHECK(getErrorOffset(c_pairFields, 2, "{\"a\":1,\"b\":2}") == 11);
+
+    const FieldDescriptor boolField[] = { { "b", FieldType::boolean } };
+    HALVOE_CHECK(getErrorOffset(boolField, 1, "{\"b\":tru}") == 5);
+    HALVOE_CHECK(getErrorOffset(boolField, 1, "{\"b\":null}") == 5);
+  }
+
+  void checkRejectedNumbers()
+  {
+    const FieldDescriptor i8Field[] = { { "v", FieldType::int8 } };
+    const FieldDescriptor u8Field[] = { { "v", FieldType::uint8 } };
+    const FieldDescriptor u16Field[] = { { "v", FieldType::uint16 } };
+    const FieldDescriptor i64Field[] = { { "v", FieldType::int64 } };
+    const FieldDescriptor u64Field[] = { { "v", FieldType::uint64 } };
+    const FieldDescriptor f32Field[] = { { "v", FieldType::float32 } };
+    const FieldDescriptor f64Field[] = { { "v", FieldType::float64 } };
+
+    // Overflowing the field type.
+    HALVOE_CHECK(getErrorOffset(i8Field, 1, "{\"v\":128}") == 5);
+    HALVOE_CHECK(getErrorOffset(i8Field, 1, "{\"v\":-129}") == 5);
+    HALVOE_CHECK(getErrorOffset(u8Field, 1, "{\"v\":256}") == 5);
+    HALVOE_CHECK(getErrorOffset(u8Field, 1, "{\"v\":-1}") == 5);
+    HALVOE_CHECK(getErrorOffset(u16Field, 1, "{\"v\":65536}") == 5);
+    HALVOE_CHECK(getErrorOffset(i64Field, 1, "{\"v\":9223372036854775808}") == 5);
+    HALVOE_CHECK(getErrorOffset(i64Field, 1, "{\"v\":-9223372036854775809}") == 5);
+    HALVOE_CHECK(getErrorOffset(u64Field, 1, "{\"v\":18446744073709551616}") == 5);
+    HALVOE_CHECK(getErrorOffset(f32Field, 1, "{\"v\":3.5e38}") == 5);
+    HALVOE_CHECK(getErrorOffset(f64Field, 1, "{\"v\":-1e309}") == 5);
+
+    // Fractions and exponents do not fit an integer field (parsing stops before them).
+    HALVOE_CHECK(getErrorOffset(u8Field, 1, "{\"v\":1.5}") == 6);
+    HALVOE_CHECK(getErrorOffset(u8Field, 1, "{\"v\":1e2}") == 6);
+
+    // No JSON numbers.
+    HALVOE_CHECK(getErrorOffset(u8Field, 1, "{\"v\":01}") == 5);
+    HALVOE_CHECK(getErrorOffset(u8Field, 1, "{\"v\":+1}") == 5);
+    HALVOE_CHECK(getErrorOffset(f64Field, 1, "{\"v\":1.}") == 5);
+    HALVOE_CHECK(getErrorOffset(f64Field, 1, "{\"v\":.5}") == 5);
+    HALVOE_CHECK(getErrorOffset(f64Field, 1, "{\"v\":-.5}") == 5);
+    HALVOE_CHECK(getErrorOffset(f64Field, 1, "{\"v\":nan}") == 5);
+    HALVOE_CHECK(getErrorOffset(f64Field, 1, "{\"v\":inf}") == 5);
+    HALVOE_CHECK(getErrorOffset(f64Field, 1, "{\"v\":0x10}") == 6);
+    HALVOE_CHECK(getErrorOffset(f64Field, 1, "{\"v\":}") == 5);
+  }
+
+  void checkRejectedStrings()
+  {
+    const FieldDescriptor s8Field[] = { { "s", FieldType::string8 } };
+
+    // Bad escapes point at the offending char.
+    HALVOE_CHECK(getErrorOffset(s8Field, 1, "{\"s\":\"a\\x\"}") == 8);
+    HALVOE_CHECK(getErrorOffset(s8Field, 1, "{\"s\":\"a\\'\"}") == 8);
+    HALVOE_CHECK(getErrorOffset(s8Field, 1, "{\"s\":\"\\u12G4\"}") == 8);
+    HALVOE_CHECK(getErrorOffset(s8Field, 1, "{\"s\":\"\\u12\"}") == 8);
+    HALVOE_CHECK(getErrorOffset(s8Field, 1, "{\"s\":\"\\ude00\"}") == 12);
+    HALVOE_CHECK(getErrorOffset(s8Field, 1, "{\"s\":\"\\ud83d\"}") == 12);
+    HALVOE_CHECK(getErrorOffset(s8Field, 1, "{\"s\":\"\\ud83dx\"}") == 12);
+    HALVOE_CHECK(getErrorOffset(s8Field, 1, "{\"s\":\"\\ud83d\\u0041\"}") == 18);
+    HALVOE_CHECK(getErrorOffset(s8Field, 1, "{\"s\":\"\\") == 7);
+
+    // Raw control characters and unterminated strings.
+    HALVOE_CHECK(getErrorOffset(s8Field, 1, "{\"s\":\"a\nb\"}") == 7);
+    HALVOE_CHECK(getErrorOffset(s8Field, 1, "{\"s\":\"a\\nb\tc\"}") == 11);
+    HALVOE_CHECK(getErrorOffset(s8Field, 1, "{\"s\":\"abc") == 9);
+
+    // Strings without escapes are copied from the input at any length; escaped ones have to fit the scratch buffer.
+    const FieldDescriptor s16Field[] = { { "s", FieldType::string16 } };
+    const std::string unescaped = "{\"s\":\"" + std::string(400, 'x') + "\"}";
+    HALVOE_CHECK(roundTrip(s16Field, 1, unescaped) == unescaped);
+    const std::string escaped = "{\"s\":\"" + std::string(252, 'x') + "\\n\"}";
+    HALVOE_CHECK(roundTrip(s16Field, 1, escaped) == escaped);
+    HALVOE_CHECK(getErrorOffset(s16Field, 1, "{\"s\":\"" + std::string(300, 'x') + "\\n\"}") == 306);
+
+    // A string longer than its size prefix allows fails after the string.
+    const std::string longest = "{\"s\":\"" + std::string(255, 'x') + "\"}";
+    HALVOE_CHECK(roundTrip(s8Field, 1, longest) == longest);
+    HALVOE_CHECK(getErrorOffset(s8Field, 1, "{\"s\":\"" + std::string(256, 'x') + "\"}") == 263);
+  }
+
+  void checkFullSerializer()
+  {
+    const std::string json = "{\"a\":7,\"b\":\"twelve chars\"}";
+    JsonConverter converter(c_pairFields, 2);
+
+    std::array<uint8_t, 64> frame;
+    Serializer<64> serializer(frame);
+    HALVOE_CHECK(converter.convert(json.data(), json.size(), serializer) == json.size());
+    const size_t frameSize = serializer.getBytesWritten();
+
+    // One byte less than the frame needs fails at the string.
+    std::array<uint8_t, 64> padding{};
+    Serializer<64> shortSerializer(frame);
+    shortSerializer.writeArray(padding.data(), 64 - frameSize - c_typeTagSize + 1);
+    HALVOE_CHECK(converter.convert(json.data(), json.size(), shortSerializer) == 0);
+    HALVOE_CHECK(converter.getErrorOffset() == json.size() - 1);
+  }
+}
+
+int main()
+{
+  checkRoundTrip();
+  checkStream();
+  checkRejectedStructure();
+  checkRejectedNumbers();
+  checkRejectedStrings();
+  checkFullSerializer();
+  return test::finishTest("test_json_converter");
+}
@@ -0,0 +1,301 @@
+#include <array>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <random>
+#include <string>
+
+#include "JsonWriter.hpp"
+#include "Test.hpp"
+
+// **** **** **** ****
+// NOTE: Checks the text JsonWriter produces: string escapes, NaN and infinity as null, numbers (floats
+//       printed exactly and round tripping), commas in nested arrays and objects, misuse, a full buffer
+//       without a sink, and that a small buffer with a sink streams the same text as one large buffer.
+// **** **** **** ****
+
+using namespace halvoe;
+
+namespace
+{
+  template<size_t tc_bufferSize>
+  std::string getText(const JsonWriter<tc_bufferSize>& in_writer)
+  {
+    return std::string(in_writer.getBuffer(), in_writer.getSize());
+  }
+
+  template<typename Type>
+  std::string writeValue(Type in_value)
+  {
+    std::array<char, 64> json;
+    JsonWriter<64> writer(json);
+    if (!writer.value(in_value)) { return "<failed>"; }
+    return getText(writer);
+  }
+
+  std::string writeString(const char* in_string, size_t in_size)
+  {
+    std::array<char, 256> json;
+    JsonWriter<256> writer(json);
+    if (!writer.value(in_string, in_size)) { return "<failed>"; }
+    return getText(writer);
+  }
+
+  bool appendToString(void* io_context, const char* in_data, size_t in_size)
+  {
+    static_cast<std::string*>(io_context)->append(in_data, in_size);
+    return true;
+  }
+
+  bool rejectOutput(void*, const char*, size_t)
+  {
+    return false;
+  }
+
+  void checkEscapes()
+  {
+    HALVOE_CHECK(writeString("", 0) == "\"\"");
+    HALVOE_CHECK(writeString("plain text", 10) == "\"plain text\"");
+    HALVOE_CHECK(writeString("say \"hi\"", 8) == "\"say \\\"hi\\\"\"");
+    HALVOE_CHECK(writeString("back\\slash", 10) == "\"back\\\\slash\"");
+    HALVOE_CHECK(writeString("\b\f\n\r\t", 5) == "\"\\b\\f\\n\\r\\t\"");
+    HALVOE_CHECK(writeString("a/b", 3) == "\"a/b\"");
+    HALVOE_CHECK(writeString("\x7f", 1) == "\"\x7f\"");
+    HALVOE_CHECK(writeString("gr\xc3\xbc\xc3\x9f", 6) == "\"gr\xc3\xbc\xc3\x9f\""); // UTF-8 is copied as is
+
+    // Every other control character becomes \u00XX, also within runs of plain characters.
+    for (unsigned character = 0; character < 0x20; ++character)
+    {
+      const char input[3] = { 'x', static_cast<char>(character), 'y' };
+      const std::string text = writeString(input, sizeof(input));
+      switch (character)
+      {
+        case '\b': HALVOE_CHECK(text == "\"x\\by\""); break;
+        case '\f': HALVOE_CHECK(text == "\"x\\fy\""); break;
+        case '\n': HALVOE_CHECK(text == "\"x\\ny\""); break;
+        case '\r': HALVOE_CHECK(text == "\"x\\ry\""); break;
+        case '\t': HALVOE_CHECK(text == "\"x\\ty\""); break;
+        default:
+        {
+          char expected[16];
+          std::snprintf(expected, sizeof(expected), "\"x\\u%04xy\"", character);
+          HALVOE_CHECK(text == expected);
+        }
+      }
+    }
+
+    // Keys are escaped the same way.
+    std::array<char, 64> json;
+    JsonWriter<64> writer(json);
+    HALVOE_CHECK(writer.beginObject() && writer.key("a\"b\n", 4) && writer.value<int>(1) && writer.endObject());
+    HALVOE_CHECK(getText(writer) == "{\"a\\\"b\\n\":1}");
+  }
+
+  void checkNonFiniteAsNull()
+  {
+    HALVOE_CHECK(writeValue(std::numeric_limits<float>::quiet_NaN()) == "null");
+    HALVOE_CHECK(writeValue(std::numeric_limits<float>::infinity()) == "null");
+    HALVOE_CHECK(writeValue(-std::numeric_limits<float>::infinity()) == "null");
+    HALVOE_CHECK(writeValue(std::numeric_limits<double>::quiet_NaN()) == "null");
+    HALVOE_CHECK(writeValue(-std::numeric_limits<double>::quiet_NaN()) == "null");
+    HALVOE_CHECK(writeValue(std::numeric_limits<double>::infinity()) == "null");
+    HALVOE_CHECK(writeValue(-std::numeric_limits<double>::infinity()) == "null");
+
+    // A null still takes part in the comma handling.
+    std::array<char, 64> json;
+    JsonWriter<64> writer(json);
+    HALVOE_CHECK(writer.beginArray() && writer.value(1.5) && writer.value(std::nan("")) && writer.nullValue() && writer.value(2.0f) && writer.endArray());
+    HALVOE_CHECK(getText(writer) == "[1.5,null,null,2]");
+  }
+
+  void checkNumbers()
+  {
+    HALVOE_CHECK(writeValue(true) == "true" && writeValue(false) == "false");
+    HALVOE_CHECK(writeValue<int8_t>(-128) == "-128" && writeValue<uint8_t>(255) == "255");
+    HALVOE_CHECK(writeValue<int64_t>(std::numeric_limits<int64_t>::min()) == "-9223372036854775808");
+    HALVOE_CHECK(writeValue<uint64_t>(std::numeric_limits<uint64_t>::max()) == "18446744073709551615");
+
+    HALVOE_CHECK(writeValue(12.25f) == "12.25");
+    HALVOE_CHECK(writeValue(-0.5f) == "-0.5");
+    HALVOE_CHECK(writeValue(0.001f) == "0.001");
+    HALVOE_CHECK(writeValue(-0.0f) == "-0" && writeValue(0.0f) == "0");
+    HALVOE_CHECK(writeValue(16777216.0f) == "16777216");
+    HALVOE_CHECK(writeValue(0.1f) == "0.1");
+    HALVOE_CHECK(writeValue(0.1) == "0.1");
+    HALVOE_CHECK(writeValue(3.4028235e38f) == "3.4028235e+38");
+    HALVOE_CHECK(writeValue(1e-45f) == "1e-45");
+
+    // Every float reads back to the same bits, whether it takes the exact decimal or the to_chars path.
+    std::mt19937 generator(106);
+    size_t mismatchCount = 0;
+    for (size_t index = 0; index < 200000; ++index)
+    {
+      float value;
+      const uint32_t bits = generator();
+      std::memcpy(&value, &bits, sizeof(value));
+      if (index % 2 == 0) { value = static_cast<float>(static_cast<int32_t>(bits) % 2000000) / 1000.0f; } // on the exact decimal path
+
+      const std::string text = writeValue(value);
+      if (!std::isfinite(value)) { mismatchCount = mismatchCount + (text == "null" ? 0 : 1); continue; }
+
+      const float parsed = std::strtof(text.c_str(), nullptr);
+      if (std::memcmp(&parsed, &value, sizeof(value)) != 0) { mismatchCount = mismatchCount + 1; }
+    }
+    HALVOE_CHECK(mismatchCount == 0);
+  }
+
+  void checkNesting()
+  {
+    std::array<char, 128> json;
+    JsonWriter<128> writer(json);
+    HALVOE_CHECK(writer.beginArray());
+    HALVOE_CHECK(writer.beginArray() && writer.value<int>(1) && writer.value<int>(2) && writer.endArray());
+    HALVOE_CHECK(writer.beginArray() && writer.endArray());
+    HALVOE_CHECK(writer.beginArray() && writer.beginArray() && writer.value<int>(3) && writer.endArray() && writer.endArray());
+    HALVOE_CHECK(writer.beginObject() && writer.key("a") && writer.beginArray() && writer.value(true) && writer.nullValue() && writer.endArray());
+    HALVOE_CHECK(writer.key("b") && writer.beginObject() && writer.endObject() && writer.key("c") && writer.value("x", 1) && writer.endObject());
+    HALVOE_CHECK(writer.value<int>(4) && !writer.isComplete() && writer.endArray() && writer.isComplete());
+    HALVOE_CHECK(getText(writer) == "[[1,2],[],[[3]],{\"a\":[true,null],\"b\":{},\"c\":\"x\"},4]");
+
+    // After reset(), the next top level value starts without a comma.
+    writer.reset();
+    HALVOE_CHECK(writer.value<int>(5) && writer.isComplete());
+    HALVOE_CHECK(getText(writer) == "[[1,2],[],[[3]],{\"a\":[true,null],\"b\":{},\"c\":\"x\"},4]5");
+
+    // The deepest nesting is c_maxDepth - 1 containers.
+    JsonWriter<128> deepWriter(json);
+    size_t depth = 0;
+    while (deepWriter.beginArray()) { depth = depth + 1; }
+    HALVOE_CHECK(depth == 31 && deepWriter.hasFailed());
+  }
+
+  void checkMisuse()
+  {
+    std::array<char, 64> json;
+
+    JsonWriter<64> closeWithoutOpen(json);
+    HALVOE_CHECK(!closeWithoutOpen.endArray() && closeWithoutOpen.hasFailed());
+
+    JsonWriter<64> closeAfterKey(json);
+    HALVOE_CHECK(closeAfterKey.beginObject() && closeAfterKey.key("a") && !closeAfterKey.endObject());
+
+    JsonWriter<64> keyAfterKey(json);
+    HALVOE_CHECK(keyAfterKey.beginObject() && keyAfterKey.key("a") && !keyAfterKey.key("b"));
+
+    JsonWriter<64> incomplete(json);
+    HALVOE_CHECK(incomplete.beginObject() && !incomplete.isComplete());
+  }
+
+  void checkFullBuffer()
+  {
+    // Without a sink, output that does not fit fails the writer and every later call.
+    std::array<char, 8> json;
+    JsonWriter<8> writer(json);
+    HALVOE_CHECK(writer.beginArray() && writer.value<int>(123456) && !writer.value<int>(7) && writer.hasFailed());
+    HALVOE_CHECK(!writer.nullValue() && !writer.endArray());
+
+    JsonWriter<8> stringWriter(json);
+    HALVOE_CHECK(stringWriter.value("123456", 6) && stringWriter.getSize() == 8);
+    JsonWriter<8> longStringWriter(json);
+    HALVOE_CHECK(!longStringWriter.value("1234567", 7) && longStringWriter.hasFailed());
+
+    // A number near the end of the buffer takes the copy path and still fits exactly.
+    std::array<char, 40> numberJson;
+    JsonWriter<40> numberWriter(numberJson);
+    HALVOE_CHECK(numberWriter.value("1234567890123456", 16) && numberWriter.value<int64_t>(-1234567890123456789) && numberWriter.getSize() == 39);
+    HALVOE_CHECK(!numberWriter.value<int>(10) && numberWriter.hasFailed());
+
+    // A failing sink fails the writer.
+    JsonWriter<8> rejectedWriter(json, rejectOutput, nullptr);
+    HALVOE_CHECK(rejectedWriter.value("123456", 6) && !rejectedWriter.value<int>(1) && rejectedWriter.hasFailed());
+  }
+
+  template<typename WriterType>
+  std::string streamDocument(WriterType& io_writer, const std::string& in_output)
+  {
+    const char strings[][24] = { "short", "with \"quotes\" and \\", "\x01\x02 control \x1f", "" };
+    io_writer.beginObject();
+    for (size_t index = 0; index < 20; ++index)
+    {
+      io_writer.key(strings[index % 4]);
+      io_writer.beginArray();
+      io_writer.value(strings[(index + 1) % 4], std::strlen(strings[(index + 1) % 4]));
+      io_writer.template value<int64_t>(-1234567890123456789 + static_cast<int64_t>(index));
+      io_writer.value(static_cast<float>(index) * 0.1f);
+      io_writer.value(1.0 / (static_cast<double>(index) + 3.0));
+      io_writer.value(index % 2 == 0);
+      io_writer.endArray();
+    }
+    io_writer.endObject();
+    io_writer.flush();
+    return io_writer.isComplete() ? in_output : "<failed>";
+  }
+
+  template<size_t tc_bufferSize>
+  std::string streamThrough()
+  {
+    std::string output;
+    std::array<char, tc_bufferSize> json;
+    JsonWriter<tc_bufferSize> writer(json, appendToString, &output);
+    return streamDocument(writer, output);
+  }
+
+  void checkSink()
+  {
+    std::array<char, 4096> json;
+    JsonWriter<4096> writer(json);
+    streamDocument(writer, std::string());
+    HALVOE_CHECK(writer.isComplete() && writer.getSize() > 1000);
+    const std::string expected = getText(writer);
+
+    HALVOE_CHECK(streamThrough<1>() == expected);
+    HALVOE_CHECK(streamThrough<5>() == expected);
+    HALVOE_CHECK(streamThrough<7>() == expected);
+    HALVOE_CHECK(streamThrough<31>() == expected);
+    HALVOE_CHECK(streamThrough<33>() == expected);
+    HALVOE_CHECK(streamThrough<64>() == expected);
+    HALVOE_CHECK(streamThrough<4096>() == expected);
+  }
+
+  void checkWriteJson()
+  {
+    const FieldDescriptor fields[] = { { "id", FieldType::uint16 }, { "speed", FieldType::float32 }, { "on", FieldType::boolean },
+                                       { "name", FieldType::string8 }, { "t", FieldType::int64 }, { "ratio", FieldType::float64 } };
+
+    std::array<uint8_t, 64> buffer;
+    Serializer<64> serializer(buffer);
+    serializer.write<uint16_t>(513);
+    serializer.write(12.25f);
+    serializer.write(false);
+    serializer.write("tab\there", static_cast<uint8_t>(8));
+    serializer.write<int64_t>(1700000000123);
+    serializer.write(std::numeric_limits<double>::infinity());
+
+    std::array<char, 128> json;
+    Deserializer<64> deserializer(buffer);
+    JsonWriter<128> writer(json);
+    HALVOE_CHECK(writeJson(deserializer, fields, 6, writer) && writer.isComplete());
+    HALVOE_CHECK(getText(writer) == "{\"id\":513,\"speed\":12.25,\"on\":false,\"name\":\"tab\\there\",\"t\":1700000000123,\"ratio\":null}");
+
+    // Fields past the end of the buffer fail.
+    const FieldDescriptor longFields[] = { { "a", FieldType::float64 }, { "b", FieldType::float64 }, { "c", FieldType::float64 }, { "d", FieldType::float64 },
+                                           { "e", FieldType::float64 }, { "f", FieldType::float64 }, { "g", FieldType::float64 }, { "h", FieldType::float64 } };
+    Deserializer<64> longDeserializer(buffer);
+    JsonWriter<128> longWriter(json);
+    HALVOE_CHECK(!writeJson(longDeserializer, longFields, 8, longWriter));
+  }
+}
+
+int main()
+{
+  checkEscapes();
+  checkNonFiniteAsNull();
+  checkNumbers();
+  checkNesting();
+  checkMisuse();
+  checkFullBuffer();
+  checkSink();
+  checkWriteJson();
+  return test::finishTest("test_json_writer");
+}
@@ -0,0 +1,146 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "LatencyHistogram.hpp"
+#include "Test.hpp"
+
+// **** **** **** ****
+// NOTE: Checks LatencyHistogram percentiles against the exact percentiles of 100k random samples
+//       (uniform, log-uniform over the full uint32_t range, and a long tail): every reported value is
+//       at least the exact one and within the relative error of 2^-(tc_precisionBits - 1), and values
+//       below 2^tc_precisionBits are exact. Also checks StageLatencyRecorder with a fake clock that wraps.
+// **** **** **** ****
+
+using namespace halvoe;
+
+namespace
+{
+  constexpr size_t c_sampleCount = 100000;
+  const double c_percentiles[] = { 0.001, 0.1, 1.0, 10.0, 25.0, 50.0, 75.0, 90.0, 99.0, 99.9, 99.99, 100.0 };
+
+  // The smallest sample that in_percentile percent of all samples are less than or equal to.
+  uint32_t getExactPercentile(const std::vector<uint32_t>& in_sorted, double in_percentile)
+  {
+    const double rank = in_percentile / 100.0 * static_cast<double>(in_sorted.size());
+    size_t target = static_cast<size_t>(std::ceil(rank));
+    if (target == 0) { target = 1; }
+    return in_sorted[target - 1];
+  }
+
+  template<size_t tc_precisionBits>
+  bool isWithinPrecision(uint32_t in_exact, uint32_t in_reported)
+  {
+    if (in_exact < (uint32_t{ 1 } << tc_precisionBits)) { return in_reported == in_exact; }
+
+    const double maxError = std::ldexp(static_cast<double>(in_exact), -static_cast<int>(tc_precisionBits - 1));
+    return in_reported >= in_exact && static_cast<double>(in_reported - in_exact) <= maxError;
+  }
+
+  template<size_t tc_precisionBits, typename Distribution>
+  void checkPercentiles(std::mt19937& io_generator, Distribution in_distribution)
+  {
+    LatencyHistogram<tc_precisionBits> histogram;
+    std::vector<uint32_t> samples(c_sampleCount);
+    for (uint32_t& sample : samples)
+    {
+      sample = in_distribution(io_generator);
+      histogram.record(sample);
+    }
+    std::sort(samples.begin(), samples.end());
+
+    HALVOE_CHECK(histogram.getCount() == c_sampleCount);
+    HALVOE_CHECK(histogram.getMax() == samples.back());
+    for (double percentile : c_percentiles)
+    {
+      const uint32_t exact = getExactPercentile(samples, percentile);
+      const uint32_t reported = histogram.getValueAtPercentile(percentile);
+      if (!HALVOE_CHECK(isWithinPrecision<tc_precisionBits>(exact, reported)))
+      {
+        std::printf("  precision %zu, p%g: exact %u, reported %u\n", tc_precisionBits, percentile, exact, reported);
+      }
+    }
+    HALVOE_CHECK(histogram.getValueAtPercentile(100.0) == samples.back());
+  }
+
+  template<size_t tc_precisionBits>
+  void checkDistributions(std::mt19937& io_generator)
+  {
+    checkPercentiles<tc_precisionBits>(io_generator, [](std::mt19937& io_random) { return static_cast<uint32_t>(io_random() % 20000); });
+    checkPercentiles<tc_precisionBits>(io_generator, [](std::mt19937& io_random) { return static_cast<uint32_t>(io_random() >> (io_random() % 32)); });
+    checkPercentiles<tc_precisionBits>(io_generator, [](std::mt19937& io_random)
+    {
+      // Mostly around 1000 ticks, with a rare tail up to 10^9.
+      std::exponential_distribution<double> tail(0.5);
+      const double value = 1000.0 * std::exp(tail(io_random) * (io_random() % 1000 == 0 ? 6.0 : 0.2));
+      return static_cast<uint32_t>(std::min(value, 4e9));
+    });
+  }
+
+  void checkEdgeCases()
+  {
+    LatencyHistogram<5> histogram;
+    HALVOE_CHECK(histogram.getValueAtPercentile(50.0) == 0 && histogram.getCount() == 0 && histogram.getMax() == 0);
+    HALVOE_CHECK(LatencyHistogram<5>::getBucketCount() == (32 - 5 + 2) * 16);
+
+    // The extremes of the value range.
+    histogram.record(0);
+    histogram.record(0xffffffff);
+    HALVOE_CHECK(histogram.getValueAtPercentile(50.0) == 0);
+    HALVOE_CHECK(histogram.getValueAtPercentile(50.1) == 0xffffffff && histogram.getMax() == 0xffffffff);
+
+    // A single value is reported exactly (clamped to the maximum) at every percentile.
+    histogram.reset();
+    HALVOE_CHECK(histogram.getCount() == 0 && histogram.getValueAtPercentile(99.0) == 0);
+    histogram.record(123457);
+    HALVOE_CHECK(histogram.getValueAtPercentile(0.0) == 123457 && histogram.getValueAtPercentile(100.0) == 123457);
+  }
+
+  uint32_t g_time = 0;
+
+  uint32_t getFakeTime()
+  {
+    return g_time;
+  }
+
+  void checkStageRecorder()
+  {
+    StageLatencyRecorder<5> recorder(getFakeTime);
+    g_time = 0xffffff00; // the clock wraps during the messages
+    for (uint32_t message = 0; message < 100; ++message)
+    {
+      recorder.begin();
+      g_time = g_time + 10;
+      recorder.mark(LatencyStage::serialize);
+      g_time = g_time + 20 + message;
+      recorder.mark(LatencyStage::checksum);
+      g_time = g_time + 5;
+      recorder.end();
+    }
+
+    const LatencyReport serialize = recorder.getReport(LatencyStage::serialize);
+    HALVOE_CHECK(serialize.count == 100 && serialize.p50 == 10 && serialize.max == 10);
+    const LatencyReport checksum = recorder.getReport(LatencyStage::checksum);
+    HALVOE_CHECK(checksum.count == 100 && isWithinPrecision<5>(69, checksum.p50) && isWithinPrecision<5>(118, checksum.p99) && checksum.max == 119);
+    HALVOE_CHECK(recorder.getReport(LatencyStage::frame).count == 0 && recorder.getReport(LatencyStage::enqueue).max == 0);
+    const LatencyReport total = recorder.getReport(LatencyStage::total);
+    HALVOE_CHECK(total.count == 100 && isWithinPrecision<5>(84, total.p50) && total.max == 134);
+
+    recorder.reset();
+    HALVOE_CHECK(recorder.getReport(LatencyStage::total).count == 0);
+  }
+}
+
+int main()
+{
+  std::mt19937 generator(114);
+  checkDistributions<2>(generator);
+  checkDistributions<5>(generator);
+  checkDistributions<8>(generator);
+  checkDistributions<16>(generator);
+  checkEdgeCases();
+  checkStageRecorder();
+  return test::finishTest("test_latency_histogram");
+}
@@ -0,0 +1,235 @@
+#include <array>
+#include <cstring>
+#include <initializer_list>
+
+#include "MessagePack.hpp"
+#include "Test.hpp"
+
+// **** **** **** ****
+// NOTE: Checks MessagePackSerializer and MessagePackDeserializer against the byte layouts of the MessagePack
+//       spec at every format boundary (fixint/uint8/16/32/64, negative fixint/int8/16/32, fixstr/str8/16,
+//       fixarray/array16/32, fixmap/map16, bin8/16, float32/64), plus range checks and truncated input.
+// **** **** **** ****
+
+using namespace halvoe;
+
+namespace
+{
+  constexpr size_t c_bufferSize = 512;
+
+  std::array<uint8_t, c_bufferSize> g_buffer;
+
+  // Runs in_write on a fresh serializer and compares the first bytes written with in_expected;
+  // in_payloadSize bytes (e.g. string contents) are expected after them.
+  template<typename WriteFunction>
+  bool encodesTo(WriteFunction in_write, std::initializer_list<uint8_t> in_expected, size_t in_payloadSize = 0)
+  {
+    g_buffer.fill(0x55);
+    MessagePackSerializer<c_bufferSize> serializer(g_buffer);
+    if (!in_write(serializer)) { return false; }
+
+    return serializer.getBytesWritten() == in_expected.size() + in_payloadSize &&
+           std::memcmp(g_buffer.data(), in_expected.begin(), in_expected.size()) == 0;
+  }
+
+  template<typename Type>
+  bool integerEncodesTo(Type in_value, std::initializer_list<uint8_t> in_expected)
+  {
+    const bool isEncoded = encodesTo([in_value](MessagePackSerializer<c_bufferSize>& out_serializer) { return out_serializer.write<Type>(in_value); }, in_expected);
+    MessagePackDeserializer<c_bufferSize> deserializer(g_buffer);
+    return isEncoded && deserializer.read<Type>() == in_value && deserializer.getBytesRead() == in_expected.size();
+  }
+
+  void checkIntegers()
+  {
+    HALVOE_CHECK(integerEncodesTo<uint64_t>(0, { 0x00 }));
+    HALVOE_CHECK(integerEncodesTo<uint64_t>(127, { 0x7f }));
+    HALVOE_CHECK(integerEncodesTo<uint64_t>(128, { 0xcc, 0x80 }));
+    HALVOE_CHECK(integerEncodesTo<uint64_t>(255, { 0xcc, 0xff }));
+    HALVOE_CHECK(integerEncodesTo<uint64_t>(256, { 0xcd, 0x01, 0x00 }));
+    HALVOE_CHECK(integerEncodesTo<uint64_t>(65535, { 0xcd, 0xff, 0xff }));
+    HALVOE_CHECK(integerEncodesTo<uint64_t>(65536, { 0xce, 0x00, 0x01, 0x00, 0x00 }));
+    HALVOE_CHECK(integerEncodesTo<uint64_t>(4294967295u, { 0xce, 0xff, 0xff, 0xff, 0xff }));
+    HALVOE_CHECK(integerEncodesTo<uint64_t>(4294967296u, { 0xcf, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00 }));
+    HALVOE_CHECK(integerEncodesTo<uint64_t>(UINT64_MAX, { 0xcf, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff }));
+
+    HALVOE_CHECK(integerEncodesTo<int64_t>(-1, { 0xff }));
+    HALVOE_CHECK(integerEncodesTo<int64_t>(-32, { 0xe0 }));
+    HALVOE_CHECK(integerEncodesTo<int64_t>(-33, { 0xd0, 0xdf }));
+    HALVOE_CHECK(integerEncodesTo<int64_t>(-128, { 0xd0, 0x80 }));
+    HALVOE_CHECK(integerEncodesTo<int64_t>(-129, { 0xd1, 0xff, 0x7f }));
+    HALVOE_CHECK(integerEncodesTo<int64_t>(-32768, { 0xd1, 0x80, 0x00 }));
+    HALVOE_CHECK(integerEncodesTo<int64_t>(-32769, { 0xd2, 0xff, 0xff, 0x7f, 0xff }));
+    HALVOE_CHECK(integerEncodesTo<int64_t>(INT32_MIN, { 0xd2, 0x80, 0x00, 0x00, 0x00 }));
+    HALVOE_CHECK(integerEncodesTo<int64_t>(-2147483649ll, { 0xd3, 0xff, 0xff, 0xff, 0xff, 0x7f, 0xff, 0xff, 0xff }));
+    HALVOE_CHECK(integerEncodesTo<int64_t>(INT64_MIN, { 0xd3, 0x80, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 }));
+
+    // The format depends on the value, not on the C++ type.
+    HALVOE_CHECK(integerEncodesTo<int8_t>(100, { 0x64 }));
+    HALVOE_CHECK(integerEncodesTo<int16_t>(200, { 0xcc, 0xc8 }));
+    HALVOE_CHECK(integerEncodesTo<uint32_t>(1, { 0x01 }));
+    HALVOE_CHECK(integerEncodesTo<int32_t>(INT32_MAX, { 0xce, 0x7f, 0xff, 0xff, 0xff }));
+  }
+
+  void checkIntegerRanges()
+  {
+    // Values that do not fit into the requested type fail and do not advance.
+    const uint8_t uint16Value[] = { 0xcd, 0x01, 0x00 };
+    MessagePackDeserializer<sizeof(uint16Value)> tooWide(uint16Value);
+    HALVOE_CHECK(tooWide.read<uint8_t>() == UINT8_MAX && tooWide.getBytesRead() == 0);
+    HALVOE_CHECK(tooWide.read<int8_t>() == INT8_MAX && tooWide.getBytesRead() == 0);
+    HALVOE_CHECK(tooWide.read<int16_t>() == 256 && tooWide.getBytesRead() == 3);
+
+    const uint8_t negativeValue[] = { 0xd1, 0xff, 0x7f };
+    MessagePackDeserializer<sizeof(negativeValue)> negative(negativeValue);
+    HALVOE_CHECK(negative.read<uint32_t>() == UINT32_MAX && negative.getBytesRead() == 0);
+    HALVOE_CHECK(negative.read<int8_t>() == INT8_MAX && negative.getBytesRead() == 0);
+    HALVOE_CHECK(negative.read<int16_t>() == -129);
+
+    // Signed formats may carry non-negative values.
+    const uint8_t signedPositive[] = { 0xd0, 0x05 };
+    MessagePackDeserializer<sizeof(signedPositive)> positive(signedPositive);
+    HALVOE_CHECK(positive.read<uint8_t>() == 5);
+
+    // Integers are accepted where a floating point value is read, booleans and nil are not integers.
+    const uint8_t mixed[] = { 0xd0, 0x80, 0xc3, 0xc0 };
+    MessagePackDeserializer<sizeof(mixed)> deserializer(mixed);
+    HALVOE_CHECK(deserializer.read<double>() == -128.0);
+    HALVOE_CHECK(deserializer.read<int32_t>() == INT32_MAX && deserializer.getBytesRead() == 2);
+    HALVOE_CHECK(deserializer.read<bool>() == true);
+    HALVOE_CHECK(!deserializer.skip<uint8_t>() && deserializer.isNil() && deserializer.readNil());
+    HALVOE_CHECK(!deserializer.readNil() && deserializer.getBytesLeft() == 0);
+  }
+
+  void checkScalars()
+  {
+    HALVOE_CHECK(encodesTo([](MessagePackSerializer<c_bufferSize>& out_serializer) { return out_serializer.write(false); }, { 0xc2 }));
+    HALVOE_CHECK(encodesTo([](MessagePackSerializer<c_bufferSize>& out_serializer) { return out_serializer.write(true); }, { 0xc3 }));
+    HALVOE_CHECK(encodesTo([](MessagePackSerializer<c_bufferSize>& out_serializer) { return out_serializer.writeNil(); }, { 0xc0 }));
+    HALVOE_CHECK(encodesTo([](MessagePackSerializer<c_bufferSize>& out_serializer) { return out_serializer.write(1.5f); }, { 0xca, 0x3f, 0xc0, 0x00, 0x00 }));
+    HALVOE_CHECK(encodesTo([](MessagePackSerializer<c_bufferSize>& out_serializer) { return out_serializer.write(-0.1); },
+                           { 0xcb, 0xbf, 0xb9, 0x99, 0x99, 0x99, 0x99, 0x99, 0x9a }));
+
+    const uint8_t floats[] = { 0xca, 0x3f, 0xc0, 0x00, 0x00, 0xcb, 0xbf, 0xb9, 0x99, 0x99, 0x99, 0x99, 0x99, 0x9a };
+    MessagePackDeserializer<sizeof(floats)> deserializer(floats);
+    HALVOE_CHECK(deserializer.read<double>() == 1.5);
+    HALVOE_CHECK(deserializer.read<bool>() == true && deserializer.getBytesRead() == 5); // true is the max() of bool
+    HALVOE_CHECK(deserializer.read<double>() == -0.1 && deserializer.getBytesLeft() == 0);
+  }
+
+  bool stringEncodesTo(size_t in_size, std::initializer_list<uint8_t> in_header)
+  {
+    static char text[300];
+    std::memset(text, 'x', sizeof(text));
+    const bool isEncoded = encodesTo([in_size](MessagePackSerializer<c_bufferSize>& out_serializer) { return out_serializer.write(text, static_cast<uint16_t>(in_size)); },
+                                     in_header, in_size);
+    if (!isEncoded || std::memcmp(g_buffer.data() + in_header.size(), text, in_size) != 0) { return false; }
+
+    MessagePackDeserializer<c_bufferSize> deserializer(g_buffer);
+    uint16_t size = 0;
+    const char* view = deserializer.view(size);
+    return view == reinterpret_cast<const char*>(g_buffer.data() + in_header.size()) && size == in_size;
+  }
+
+  void checkStrings()
+  {
+    HALVOE_CHECK(stringEncodesTo(0, { 0xa0 }));
+    HALVOE_CHECK(stringEncodesTo(1, { 0xa1 }));
+    HALVOE_CHECK(stringEncodesTo(31, { 0xbf }));
+    HALVOE_CHECK(stringEncodesTo(32, { 0xd9, 0x20 }));
+    HALVOE_CHECK(stringEncodesTo(255, { 0xd9, 0xff }));
+    HALVOE_CHECK(stringEncodesTo(256, { 0xda, 0x01, 0x00 }));
+
+    // A string longer than SizeType can hold is not viewed, and the cursor stays.
+    stringEncodesTo(256, { 0xda, 0x01, 0x00 });
+    MessagePackDeserializer<c_bufferSize> deserializer(g_buffer);
+    uint8_t size = 0;
+    HALVOE_CHECK(deserializer.view(size) == nullptr && deserializer.getBytesRead() == 0);
+
+    // A string whose contents are cut off by the end of the buffer is not viewed either.
+    const uint8_t truncated[] = { 0xa3, 'a', 'b' };
+    MessagePackDeserializer<sizeof(truncated)> truncatedReader(truncated);
+    HALVOE_CHECK(truncatedReader.view(size) == nullptr && truncatedReader.getBytesRead() == 0);
+
+    // Binaries have no fix format.
+    const uint8_t bytes[300] = {};
+    HALVOE_CHECK(encodesTo([&bytes](MessagePackSerializer<c_bufferSize>& out_serializer) { return out_serializer.writeBinary(bytes, 0); }, { 0xc4, 0x00 }));
+    HALVOE_CHECK(encodesTo([&bytes](MessagePackSerializer<c_bufferSize>& out_serializer) { return out_serializer.writeBinary(bytes, 255); }, { 0xc4, 0xff }, 255));
+    HALVOE_CHECK(encodesTo([&bytes](MessagePackSerializer<c_bufferSize>& out_serializer) { return out_serializer.writeBinary(bytes, 256); }, { 0xc5, 0x01, 0x00 }, 256));
+
+    MessagePackDeserializer<c_bufferSize> binaryReader(g_buffer);
+    size_t binarySize = 0;
+    HALVOE_CHECK(binaryReader.viewBinary(binarySize) == g_buffer.data() + 3 && binarySize == 256);
+  }
+
+  bool arrayEncodesTo(uint32_t in_count, std::initializer_list<uint8_t> in_expected)
+  {
+    const bool isEncoded = encodesTo([in_count](MessagePackSerializer<c_bufferSize>& out_serializer) { return out_serializer.writeArrayHeader(in_count); }, in_expected);
+    MessagePackDeserializer<c_bufferSize> deserializer(g_buffer);
+    uint32_t count = 0;
+    return isEncoded && deserializer.readArrayHeader(count) && count == in_count && deserializer.getBytesRead() == in_expected.size();
+  }
+
+  bool mapEncodesTo(uint32_t in_count, std::initializer_list<uint8_t> in_expected)
+  {
+    const bool isEncoded = encodesTo([in_count](MessagePackSerializer<c_bufferSize>& out_serializer) { return out_serializer.writeMapHeader(in_count); }, in_expected);
+    MessagePackDeserializer<c_bufferSize> deserializer(g_buffer);
+    uint32_t count = 0;
+    return isEncoded && deserializer.readMapHeader(count) && count == in_count && deserializer.getBytesRead() == in_expected.size();
+  }
+
+  void checkContainers()
+  {
+    HALVOE_CHECK(arrayEncodesTo(0, { 0x90 }));
+    HALVOE_CHECK(arrayEncodesTo(15, { 0x9f }));
+    HALVOE_CHECK(arrayEncodesTo(16, { 0xdc, 0x00, 0x10 }));
+    HALVOE_CHECK(arrayEncodesTo(65535, { 0xdc, 0xff, 0xff }));
+    HALVOE_CHECK(arrayEncodesTo(65536, { 0xdd, 0x00, 0x01, 0x00, 0x00 }));
+
+    HALVOE_CHECK(mapEncodesTo(0, { 0x80 }));
+    HALVOE_CHECK(mapEncodesTo(15, { 0x8f }));
+    HALVOE_CHECK(mapEncodesTo(16, { 0xde, 0x00, 0x10 }));
+    HALVOE_CHECK(mapEncodesTo(65536, { 0xdf, 0x00, 0x01, 0x00, 0x00 }));
+
+    // An array header is no map header and no string.
+    const uint8_t array[] = { 0x92, 0x01, 0xa1, 'a' };
+    MessagePackDeserializer<sizeof(array)> deserializer(array);
+    uint32_t count = 0;
+    uint8_t size = 0;
+    HALVOE_CHECK(!deserializer.readMapHeader(count) && deserializer.view(size) == nullptr && deserializer.getBytesRead() == 0);
+    HALVOE_CHECK(deserializer.readArrayHeader(count) && count == 2);
+    HALVOE_CHECK(deserializer.read<uint8_t>() == 1);
+    HALVOE_CHECK(deserializer.view(size) == reinterpret_cast<const char*>(array + 3) && size == 1);
+  }
+
+  void checkTruncation()
+  {
+    // Every prefix of a value that needs more bytes fails and leaves the cursor where it was.
+    const uint8_t values[] = { 0xcf, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00 };
+    MessagePackDeserializer<8> shortReader(values);
+    HALVOE_CHECK(shortReader.read<uint64_t>() == UINT64_MAX && shortReader.getBytesRead() == 0);
+    MessagePackDeserializer<0> emptyReader(values);
+    HALVOE_CHECK(!emptyReader.skip<uint8_t>() && !emptyReader.isNil());
+    uint32_t count = 0;
+    MessagePackDeserializer<2> arrayReader(values);
+    HALVOE_CHECK(!arrayReader.readArrayHeader(count) && arrayReader.getBytesRead() == 0);
+
+    // A full serializer writes nothing of a value that does not fit.
+    std::array<uint8_t, 2> small{};
+    MessagePackSerializer<2> serializer(small);
+    HALVOE_CHECK(!serializer.write<uint16_t>(256) && serializer.getBytesWritten() == 0);
+    HALVOE_CHECK(serializer.write<uint16_t>(255) && serializer.getBytesWritten() == 2);
+    HALVOE_CHECK(!serializer.writeNil() && !serializer.write("", static_cast<uint8_t>(0)));
+  }
+}
+
+int main()
+{
+  checkIntegers();
+  checkIntegerRanges();
+  checkScalars();
+  checkStrings();
+  checkContainers();
+  checkTruncation();
+  return test::finishTest("test_message_pack");
+}
@@ -0,0 +1,154 @@
+#include <array>
+#include <cstring>
+
+#include "MessageProfiler.hpp"
+#include "Test.hpp"
+
+// **** **** **** ****
+// NOTE: Profiles 100 messages of a known layout through ProfilingSerializer and checks every field's
+//       byte counts (native, varint, narrowed, bit-packed, entropy-coded; computed by hand from the
+//       values), the bit width counts and the symbol tables, padding from skip(), and that failed,
+//       dropped and surplus symbol writes are handled as documented.
+// **** **** **** ****
+
+using namespace halvoe;
+
+namespace
+{
+  enum class Mode : uint8_t
+  {
+    idle = 0,
+    run = 1,
+    fault = 7
+  };
+
+  constexpr uint32_t c_messageCount = 100;
+
+  bool writeMessage(ProfilingSerializer<512>& io_serializer, uint32_t in_index)
+  {
+    const Mode modes[4] = { Mode::idle, Mode::idle, Mode::run, Mode::fault };
+    const uint8_t bytes[3] = { 1, 2, 255 };
+    char text[200];
+    std::memset(text, 'x', sizeof(text));
+    const bool isEven = in_index % 2 == 0;
+
+    return io_serializer.write<uint32_t>(in_index + 1) &&                                // field 0: 1..100
+           io_serializer.write<int16_t>(isEven ? -3 : 5) &&                              // field 1: zigzag 5 and 10
+           io_serializer.writeEnum(modes[in_index % 4]) &&                               // field 2: idle 50%, run 25%, fault 25%
+           io_serializer.write(isEven) &&                                                // field 3: true first, 50/50
+           io_serializer.write(isEven ? 0.5f : 3.14159f) &&                              // field 4: half exact / float only
+           io_serializer.write(text, static_cast<uint8_t>(isEven ? 200 : 3)) &&          // field 5: 200 or 3 chars
+           io_serializer.writeArray(bytes, 3) &&                                         // field 6: 3 values per message
+           !io_serializer.skip<uint16_t>().isNull();                                     // padding, no field
+  }
+
+  bool isProfile(const FieldProfile& in_profile, FieldKind in_kind, uint32_t in_count, uint8_t in_maxBits, uint64_t in_nativeBytes,
+                 uint64_t in_varintBytes, uint64_t in_narrowedBytes, uint64_t in_bitPackedBytes, uint64_t in_entropyCodedBytes)
+  {
+    return in_profile.kind == in_kind && in_profile.count == in_count && in_profile.maxBits == in_maxBits && in_profile.nativeBytes == in_nativeBytes &&
+           in_profile.varintBytes == in_varintBytes && in_profile.narrowedBytes == in_narrowedBytes &&
+           in_profile.bitPackedBytes == in_bitPackedBytes && in_profile.entropyCodedBytes == in_entropyCodedBytes;
+  }
+
+  bool hasSymbol(const MessageProfile<>& in_profile, size_t in_field, size_t in_symbolIndex, uint64_t in_symbol, uint32_t in_count)
+  {
+    uint64_t symbol = 0;
+    uint32_t count = 0;
+    return in_profile.getSymbol(in_field, in_symbolIndex, symbol, count) && symbol == in_symbol && count == in_count;
+  }
+
+  void checkKnownMessage()
+  {
+    MessageProfile<> profile;
+    for (uint32_t index = 0; index < c_messageCount; ++index)
+    {
+      std::array<uint8_t, 512> buffer;
+      Serializer<512> serializer(buffer);
+      ProfilingSerializer<512> profiler(serializer, profile);
+      HALVOE_CHECK(writeMessage(profiler, index));
+      HALVOE_CHECK(profiler.getBytesWritten() == serializer.getBytesWritten());
+    }
+
+    HALVOE_CHECK(profile.getMessageCount() == c_messageCount && profile.getDroppedFieldCount() == 0);
+    HALVOE_CHECK(profile.getPaddingBytes() == c_messageCount * (c_typeTagSize + 2));
+
+    // Widths 1..7 (37 values of 64..100), varint and narrowed 1 byte, 7 bits packed,
+    // width class entropy 693.6 bits.
+    HALVOE_CHECK(isProfile(profile.getFieldProfile(0), FieldKind::integer, 100, 7, 100 * (c_typeTagSize + 4), 100, 100, 88, 87));
+    HALVOE_CHECK(profile.getBitWidthCount(0, 1) == 1 && profile.getBitWidthCount(0, 6) == 32 && profile.getBitWidthCount(0, 7) == 37);
+    HALVOE_CHECK(profile.getBitWidthCount(0, 8) == 0 && profile.getSymbolCount(0) == 0);
+
+    // Widths 3 and 4: 50 * (1 + 2) + 50 * (1 + 3) = 350 bits.
+    HALVOE_CHECK(isProfile(profile.getFieldProfile(1), FieldKind::integer, 100, 4, 100 * (c_typeTagSize + 2), 100, 100, 50, 44));
+
+    // Symbols 0, 1, 7 at 50%, 25%, 25%: 150 bits; 3 bits packed.
+    HALVOE_CHECK(isProfile(profile.getFieldProfile(2), FieldKind::enumeration, 100, 3, 100 * (c_typeTagSize + 1), 100, 100, 38, 19));
+    HALVOE_CHECK(profile.getSymbolCount(2) == 3);
+    HALVOE_CHECK(hasSymbol(profile, 2, 0, 0, 50) && hasSymbol(profile, 2, 1, 1, 25) && hasSymbol(profile, 2, 2, 7, 25));
+
+    HALVOE_CHECK(isProfile(profile.getFieldProfile(3), FieldKind::boolean, 100, 1, 100 * (c_typeTagSize + 1), 100, 100, 13, 13));
+    HALVOE_CHECK(profile.getSymbolCount(3) == 2 && hasSymbol(profile, 3, 0, 1, 50) && hasSymbol(profile, 3, 1, 0, 50));
+
+    // 3.14159f is no half, so floats stay at 4 bytes.
+    HALVOE_CHECK(isProfile(profile.getFieldProfile(4), FieldKind::floatingPoint, 100, 32, 100 * (c_typeTagSize + 4), 400, 400, 400, 400));
+
+    // The string contents (10150 bytes) are part of every encoding; only the size prefix is re-encoded.
+    // Sizes 3 and 200: varint 1 or 2 bytes, widths 2 and 8 (500 bits of width classes).
+    HALVOE_CHECK(isProfile(profile.getFieldProfile(5), FieldKind::string, 100, 8, 100 * (c_typeTagSize + 1) + 10150, 150 + 10150, 100 + 10150,
+                           100 + 10150, 63 + 10150));
+
+    // 300 elements 1, 2, 255: varint 1, 1, 2 bytes; widths 1, 2 and 8.
+    HALVOE_CHECK(isProfile(profile.getFieldProfile(6), FieldKind::array, 300, 8, 100 * (c_typeTagSize + 3), 400, 300, 300, 160));
+
+    HALVOE_CHECK(profile.getFieldProfile(7).kind == FieldKind::none && profile.getFieldProfile(7).count == 0);
+    HALVOE_CHECK(profile.getFieldProfile(99).kind == FieldKind::none);
+
+    uint64_t symbol = 0;
+    uint32_t count = 0;
+    HALVOE_CHECK(!profile.getSymbol(2, 3, symbol, count) && !profile.getSymbol(99, 0, symbol, count));
+
+    profile.reset();
+    HALVOE_CHECK(profile.getMessageCount() == 0 && profile.getPaddingBytes() == 0 && profile.getFieldProfile(0).count == 0);
+  }
+
+  void checkFailedAndDroppedWrites()
+  {
+    // A failed write is not a field: the next successful write is still field 0.
+    MessageProfile<2> profile;
+    std::array<uint8_t, 16> buffer;
+    Serializer<16> serializer(buffer);
+    ProfilingSerializer<16, size_t, 2> profiler(serializer, profile);
+    const char text[20] = {};
+    HALVOE_CHECK(!profiler.write(text, static_cast<uint8_t>(sizeof(text))));
+    HALVOE_CHECK(profiler.write<uint8_t>(1) && profiler.write<uint8_t>(2) && profiler.write<uint8_t>(3));
+    HALVOE_CHECK(profile.getFieldProfile(0).kind == FieldKind::integer && profile.getFieldProfile(0).count == 1);
+
+    // Writes past tc_maxFieldCount are forwarded, but dropped from the profile.
+    HALVOE_CHECK(profile.getDroppedFieldCount() == 1 && serializer.getBytesWritten() == 3 * (c_typeTagSize + 1));
+  }
+
+  void checkSurplusSymbols()
+  {
+    // More distinct enum values than tc_maxSymbolCount fall back to the width class estimate.
+    MessageProfile<4, 4> profile;
+    for (uint8_t value = 0; value < 8; ++value)
+    {
+      std::array<uint8_t, 16> buffer;
+      Serializer<16, uint8_t> serializer(buffer);
+      ProfilingSerializer<16, uint8_t, 4, 4> profiler(serializer, profile);
+      HALVOE_CHECK(profiler.writeEnum(static_cast<Mode>(value)));
+    }
+
+    HALVOE_CHECK(profile.getSymbolCount(0) == 4);
+    // Widths 0, 1, 2, 2, 3, 3, 3, 3: 1 * 3 + 1 * 3 + 2 * 2 + 4 * 1 class bits and 2 * 1 + 4 * 2 raw bits = 24 bits.
+    HALVOE_CHECK(profile.getFieldProfile(0).entropyCodedBytes == 3);
+  }
+}
+
+int main()
+{
+  checkKnownMessage();
+  checkFailedAndDroppedWrites();
+  checkSurplusSymbols();
+  return test::finishTest("test_message_profiler");
+}
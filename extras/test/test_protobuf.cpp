@@ -0,0 +1,253 @@
+#include <array>
+#include <cstring>
+#include <initializer_list>
+#include <limits>
+
+#include "Protobuf.hpp"
+#include "Test.hpp"
+
+// **** **** **** ****
+// NOTE: Checks ProtobufSerializer and ProtobufDeserializer against the examples of the protobuf encoding guide
+//       (150 as varint, "testing", packed [3, 270, 86942]) and the varint, zigzag, tag and fixed width edge values,
+//       plus malformed input: truncated and overlong varints, bad tags and wire types, and packed fields that are
+//       truncated, overrun their length or hold too many values.
+// **** **** **** ****
+
+using namespace halvoe;
+
+namespace
+{
+  constexpr size_t c_bufferSize = 64;
+
+  std::array<uint8_t, c_bufferSize> g_buffer;
+
+  template<typename WriteFunction>
+  bool encodesTo(WriteFunction in_write, std::initializer_list<uint8_t> in_expected)
+  {
+    g_buffer.fill(0x55);
+    ProtobufSerializer<c_bufferSize> serializer(g_buffer);
+    return in_write(serializer) && serializer.getBytesWritten() == in_expected.size() &&
+           std::memcmp(g_buffer.data(), in_expected.begin(), in_expected.size()) == 0;
+  }
+
+  // Encodes in_value as field 1 with write<Type>() and reads it back.
+  template<typename Type>
+  bool varintEncodesTo(Type in_value, std::initializer_list<uint8_t> in_expected)
+  {
+    if (!encodesTo([in_value](ProtobufSerializer<c_bufferSize>& out_serializer) { return out_serializer.write<Type>(1, in_value); }, in_expected)) { return false; }
+
+    ProtobufDeserializer<c_bufferSize> deserializer(g_buffer);
+    uint32_t fieldNumber = 0;
+    ProtobufWireType wireType = ProtobufWireType::fixed32;
+    return deserializer.readTag(fieldNumber, wireType) && fieldNumber == 1 && wireType == ProtobufWireType::varint &&
+           deserializer.read<Type>() == in_value && deserializer.getBytesRead() == in_expected.size();
+  }
+
+  template<typename Type>
+  bool zigZagEncodesTo(Type in_value, std::initializer_list<uint8_t> in_expected)
+  {
+    if (!encodesTo([in_value](ProtobufSerializer<c_bufferSize>& out_serializer) { return out_serializer.writeSigned<Type>(1, in_value); }, in_expected)) { return false; }
+
+    ProtobufDeserializer<c_bufferSize> deserializer(g_buffer);
+    uint32_t fieldNumber = 0;
+    ProtobufWireType wireType = ProtobufWireType::fixed32;
+    return deserializer.readTag(fieldNumber, wireType) && deserializer.readSigned<Type>() == in_value && deserializer.getBytesRead() == in_expected.size();
+  }
+
+  void checkVarints()
+  {
+    HALVOE_CHECK(varintEncodesTo<uint32_t>(0, { 0x08, 0x00 }));
+    HALVOE_CHECK(varintEncodesTo<uint32_t>(1, { 0x08, 0x01 }));
+    HALVOE_CHECK(varintEncodesTo<uint32_t>(127, { 0x08, 0x7f }));
+    HALVOE_CHECK(varintEncodesTo<uint32_t>(128, { 0x08, 0x80, 0x01 }));
+    HALVOE_CHECK(varintEncodesTo<uint32_t>(150, { 0x08, 0x96, 0x01 }));
+    HALVOE_CHECK(varintEncodesTo<uint32_t>(16383, { 0x08, 0xff, 0x7f }));
+    HALVOE_CHECK(varintEncodesTo<uint32_t>(16384, { 0x08, 0x80, 0x80, 0x01 }));
+    HALVOE_CHECK(varintEncodesTo<uint32_t>(UINT32_MAX, { 0x08, 0xff, 0xff, 0xff, 0xff, 0x0f }));
+    HALVOE_CHECK(varintEncodesTo<uint64_t>(uint64_t{ 1 } << 63, { 0x08, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x01 }));
+    HALVOE_CHECK(varintEncodesTo<uint64_t>(UINT64_MAX, { 0x08, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0x01 }));
+    HALVOE_CHECK(varintEncodesTo<bool>(true, { 0x08, 0x01 }));
+    HALVOE_CHECK(varintEncodesTo<bool>(false, { 0x08, 0x00 }));
+
+    // Negative int32 and int64 values take ten bytes, as protoc writes them.
+    HALVOE_CHECK(varintEncodesTo<int32_t>(-1, { 0x08, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0x01 }));
+    HALVOE_CHECK(varintEncodesTo<int32_t>(INT32_MIN, { 0x08, 0x80, 0x80, 0x80, 0x80, 0xf8, 0xff, 0xff, 0xff, 0xff, 0x01 }));
+    HALVOE_CHECK(varintEncodesTo<int64_t>(INT64_MIN, { 0x08, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x01 }));
+    HALVOE_CHECK(varintEncodesTo<int32_t>(INT32_MAX, { 0x08, 0xff, 0xff, 0xff, 0xff, 0x07 }));
+
+    for (uint32_t shift = 0; shift < 64; ++shift)
+    {
+      const uint64_t value = uint64_t{ 1 } << shift;
+      HALVOE_CHECK(protobuf::getVarintSize(value) == shift / 7 + 1);
+      HALVOE_CHECK(protobuf::getVarintSize(value - 1) == (shift == 0 ? 1 : (shift - 1) / 7 + 1));
+    }
+  }
+
+  void checkZigZag()
+  {
+    HALVOE_CHECK(protobuf::encodeZigZag(0) == 0 && protobuf::encodeZigZag(-1) == 1 && protobuf::encodeZigZag(1) == 2 && protobuf::encodeZigZag(-2) == 3);
+    HALVOE_CHECK(protobuf::encodeZigZag(INT32_MAX) == 4294967294u && protobuf::encodeZigZag(INT32_MIN) == 4294967295u);
+    HALVOE_CHECK(protobuf::encodeZigZag(INT64_MAX) == UINT64_MAX - 1 && protobuf::encodeZigZag(INT64_MIN) == UINT64_MAX);
+    HALVOE_CHECK(protobuf::decodeZigZag(UINT64_MAX - 1) == INT64_MAX && protobuf::decodeZigZag(UINT64_MAX) == INT64_MIN);
+
+    HALVOE_CHECK(zigZagEncodesTo<int32_t>(0, { 0x08, 0x00 }));
+    HALVOE_CHECK(zigZagEncodesTo<int32_t>(-1, { 0x08, 0x01 }));
+    HALVOE_CHECK(zigZagEncodesTo<int32_t>(1, { 0x08, 0x02 }));
+    HALVOE_CHECK(zigZagEncodesTo<int32_t>(-64, { 0x08, 0x7f }));
+    HALVOE_CHECK(zigZagEncodesTo<int32_t>(64, { 0x08, 0x80, 0x01 }));
+    HALVOE_CHECK(zigZagEncodesTo<int32_t>(INT32_MAX, { 0x08, 0xfe, 0xff, 0xff, 0xff, 0x0f }));
+    HALVOE_CHECK(zigZagEncodesTo<int32_t>(INT32_MIN, { 0x08, 0xff, 0xff, 0xff, 0xff, 0x0f }));
+    HALVOE_CHECK(zigZagEncodesTo<int64_t>(INT64_MIN, { 0x08, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0x01 }));
+    HALVOE_CHECK(zigZagEncodesTo<int8_t>(-128, { 0x08, 0xff, 0x01 }));
+  }
+
+  void checkTagsAndFixedValues()
+  {
+    HALVOE_CHECK(encodesTo([](ProtobufSerializer<c_bufferSize>& out_serializer) { return out_serializer.write<uint8_t>(15, 1); }, { 0x78, 0x01 }));
+    HALVOE_CHECK(encodesTo([](ProtobufSerializer<c_bufferSize>& out_serializer) { return out_serializer.write<uint8_t>(16, 1); }, { 0x80, 0x01, 0x01 }));
+    HALVOE_CHECK(encodesTo([](ProtobufSerializer<c_bufferSize>& out_serializer) { return out_serializer.write<uint8_t>(536870911, 1); }, { 0xf8, 0xff, 0xff, 0xff, 0x0f, 0x01 }));
+    HALVOE_CHECK(encodesTo([](ProtobufSerializer<c_bufferSize>& out_serializer) { return out_serializer.write(2, "testing", static_cast<uint8_t>(7)); },
+                           { 0x12, 0x07, 0x74, 0x65, 0x73, 0x74, 0x69, 0x6e, 0x67 }));
+    HALVOE_CHECK(encodesTo([](ProtobufSerializer<c_bufferSize>& out_serializer) { return out_serializer.writeBytes(3, nullptr, 0); }, { 0x1a, 0x00 }));
+    HALVOE_CHECK(encodesTo([](ProtobufSerializer<c_bufferSize>& out_serializer) { return out_serializer.writeFixed(1, 1.0f); }, { 0x0d, 0x00, 0x00, 0x80, 0x3f }));
+    HALVOE_CHECK(encodesTo([](ProtobufSerializer<c_bufferSize>& out_serializer) { return out_serializer.writeFixed<int32_t>(1, -2); }, { 0x0d, 0xfe, 0xff, 0xff, 0xff }));
+    HALVOE_CHECK(encodesTo([](ProtobufSerializer<c_bufferSize>& out_serializer) { return out_serializer.writeFixed(1, 1.0); },
+                           { 0x09, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xf0, 0x3f }));
+    HALVOE_CHECK(encodesTo([](ProtobufSerializer<c_bufferSize>& out_serializer) { return out_serializer.writeFixed<uint64_t>(2, 0x0102030405060708); },
+                           { 0x11, 0x08, 0x07, 0x06, 0x05, 0x04, 0x03, 0x02, 0x01 }));
+
+    ProtobufDeserializer<c_bufferSize> deserializer(g_buffer);
+    uint32_t fieldNumber = 0;
+    ProtobufWireType wireType = ProtobufWireType::varint;
+    HALVOE_CHECK(deserializer.readTag(fieldNumber, wireType) && fieldNumber == 2 && wireType == ProtobufWireType::fixed64);
+    HALVOE_CHECK(deserializer.readFixed<uint64_t>() == 0x0102030405060708 && deserializer.getBytesRead() == 9);
+
+    // Truncated fixed values fail and return max().
+    ProtobufDeserializer<8> truncated(g_buffer.data());
+    HALVOE_CHECK(truncated.readTag(fieldNumber, wireType) && truncated.readFixed<uint64_t>() == UINT64_MAX && truncated.getBytesRead() == 1);
+    HALVOE_CHECK(!truncated.skip(ProtobufWireType::fixed64) && truncated.skip(ProtobufWireType::fixed32) && truncated.getBytesRead() == 5);
+  }
+
+  void checkMalformedInput()
+  {
+    uint32_t fieldNumber = 0;
+    ProtobufWireType wireType = ProtobufWireType::varint;
+
+    // Field number 0 and the group wire types 3 and 4 (and 6, 7) are rejected without advancing.
+    const uint8_t badTags[] = { 0x00, 0x0b, 0x0c, 0x0e, 0x0f, 0x80, 0x00 };
+    for (size_t index = 0; index < 5; ++index)
+    {
+      ProtobufDeserializer<1> deserializer(badTags + index);
+      HALVOE_CHECK(!deserializer.readTag(fieldNumber, wireType) && deserializer.getBytesRead() == 0);
+    }
+    ProtobufDeserializer<2> zeroField(badTags + 5);
+    HALVOE_CHECK(!zeroField.readTag(fieldNumber, wireType));
+
+    // A varint without its last byte, and one longer than ten bytes, are malformed.
+    const uint8_t overlong[] = { 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0x01 };
+    ProtobufDeserializer<sizeof(overlong)> overlongReader(overlong);
+    HALVOE_CHECK(overlongReader.read<uint64_t>() == UINT64_MAX && overlongReader.getBytesRead() == 0);
+    HALVOE_CHECK(!overlongReader.skip(ProtobufWireType::varint) && overlongReader.getBytesRead() == 0);
+    ProtobufDeserializer<3> truncatedReader(overlong);
+    HALVOE_CHECK(truncatedReader.read<uint32_t>() == UINT32_MAX && truncatedReader.readSigned<int32_t>() == INT32_MAX && truncatedReader.getBytesRead() == 0);
+
+    // A string whose length runs past the end of the buffer is not viewed.
+    const uint8_t string[] = { 0x05, 'a', 'b', 'c' };
+    ProtobufDeserializer<sizeof(string)> stringReader(string);
+    uint8_t size = 0;
+    size_t bytesSize = 0;
+    HALVOE_CHECK(stringReader.view(size) == nullptr && stringReader.viewBytes(bytesSize) == nullptr && stringReader.getBytesRead() == 0);
+    HALVOE_CHECK(!stringReader.skip(ProtobufWireType::lengthDelimited) && stringReader.getBytesRead() == 0);
+  }
+
+  void checkPacked()
+  {
+    const uint32_t values[] = { 3, 270, 86942 };
+    HALVOE_CHECK(encodesTo([&values](ProtobufSerializer<c_bufferSize>& out_serializer) { return out_serializer.writePacked(4, values, 3); },
+                           { 0x22, 0x06, 0x03, 0x8e, 0x02, 0x9e, 0xa7, 0x05 }));
+
+    uint32_t fieldNumber = 0;
+    ProtobufWireType wireType = ProtobufWireType::varint;
+    uint32_t read[4] = {};
+    size_t count = 0;
+    ProtobufDeserializer<c_bufferSize> deserializer(g_buffer);
+    HALVOE_CHECK(deserializer.readTag(fieldNumber, wireType) && fieldNumber == 4 && wireType == ProtobufWireType::lengthDelimited);
+    HALVOE_CHECK(deserializer.readPacked(read, 4, count) && count == 3 && read[0] == 3 && read[1] == 270 && read[2] == 86942);
+    HALVOE_CHECK(deserializer.getBytesRead() == 8);
+
+    // Fewer slots than values fail without advancing.
+    ProtobufDeserializer<c_bufferSize> tooMany(g_buffer);
+    tooMany.readTag(fieldNumber, wireType);
+    HALVOE_CHECK(!tooMany.readPacked(read, 2, count) && tooMany.getBytesRead() == 1);
+    HALVOE_CHECK(tooMany.readPacked(read, 3, count) && count == 3);
+
+    // The length runs past the end of the buffer.
+    const uint8_t cutOff[] = { 0x06, 0x03, 0x8e, 0x02, 0x9e, 0xa7 };
+    ProtobufDeserializer<sizeof(cutOff)> cutOffReader(cutOff);
+    HALVOE_CHECK(!cutOffReader.readPacked(read, 4, count) && cutOffReader.getBytesRead() == 0);
+
+    // The last varint continues past the field length, into the next field.
+    const uint8_t overrun[] = { 0x02, 0x03, 0x8e, 0x02 };
+    ProtobufDeserializer<sizeof(overrun)> overrunReader(overrun);
+    HALVOE_CHECK(!overrunReader.readPacked(read, 4, count) && overrunReader.getBytesRead() == 0);
+
+    // A varint inside the field that is never terminated.
+    const uint8_t unterminated[] = { 0x02, 0x03, 0x8e };
+    ProtobufDeserializer<sizeof(unterminated)> unterminatedReader(unterminated);
+    HALVOE_CHECK(!unterminatedReader.readPacked(read, 4, count) && unterminatedReader.getBytesRead() == 0);
+
+    // An empty packed field reads 0 values.
+    const uint8_t empty[] = { 0x00 };
+    ProtobufDeserializer<sizeof(empty)> emptyReader(empty);
+    count = 7;
+    HALVOE_CHECK(emptyReader.readPacked(read, 4, count) && count == 0 && emptyReader.getBytesRead() == 1);
+
+    // Packed zigzag and fixed values.
+    const int32_t signedValues[] = { 0, -1, 1, INT32_MIN };
+    HALVOE_CHECK(encodesTo([&signedValues](ProtobufSerializer<c_bufferSize>& out_serializer) { return out_serializer.writePackedSigned(5, signedValues, 4); },
+                           { 0x2a, 0x08, 0x00, 0x01, 0x02, 0xff, 0xff, 0xff, 0xff, 0x0f }));
+    int32_t signedRead[4] = {};
+    ProtobufDeserializer<c_bufferSize> signedReader(g_buffer);
+    signedReader.readTag(fieldNumber, wireType);
+    HALVOE_CHECK(signedReader.readPackedSigned(signedRead, 4, count) && count == 4 && std::memcmp(signedRead, signedValues, sizeof(signedValues)) == 0);
+
+    const float floats[] = { 1.0f, -2.0f };
+    HALVOE_CHECK(encodesTo([&floats](ProtobufSerializer<c_bufferSize>& out_serializer) { return out_serializer.writePackedFixed(6, floats, 2); },
+                           { 0x32, 0x08, 0x00, 0x00, 0x80, 0x3f, 0x00, 0x00, 0x00, 0xc0 }));
+    float floatRead[2] = {};
+    ProtobufDeserializer<c_bufferSize> fixedReader(g_buffer);
+    fixedReader.readTag(fieldNumber, wireType);
+    HALVOE_CHECK(fixedReader.readPackedFixed(floatRead, 2, count) && count == 2 && floatRead[0] == 1.0f && floatRead[1] == -2.0f);
+
+    // A fixed field whose length is no multiple of the value size, or that holds too many values, fails.
+    const uint8_t ragged[] = { 0x05, 0x00, 0x00, 0x80, 0x3f, 0x00 };
+    ProtobufDeserializer<sizeof(ragged)> raggedReader(ragged);
+    HALVOE_CHECK(!raggedReader.readPackedFixed(floatRead, 2, count) && raggedReader.getBytesRead() == 0);
+    ProtobufDeserializer<c_bufferSize> smallReader(g_buffer);
+    smallReader.readTag(fieldNumber, wireType);
+    HALVOE_CHECK(!smallReader.readPackedFixed(floatRead, 1, count) && smallReader.getBytesRead() == 1);
+  }
+
+  void checkFullBuffer()
+  {
+    std::array<uint8_t, 3> small{};
+    ProtobufSerializer<3> serializer(small);
+    HALVOE_CHECK(!serializer.write<uint32_t>(1, 16384) && serializer.getBytesWritten() == 0);
+    HALVOE_CHECK(!serializer.write(1, "ab", static_cast<uint8_t>(2)) && serializer.getBytesWritten() == 0);
+    HALVOE_CHECK(!serializer.writeFixed(1, 1.0f) && serializer.getBytesWritten() == 0);
+    const uint32_t values[] = { 1, 128 };
+    HALVOE_CHECK(!serializer.writePacked(1, values, 2) && serializer.getBytesWritten() == 0);
+    HALVOE_CHECK(serializer.write<uint32_t>(1, 16383) && serializer.getBytesLeft() == 0);
+  }
+}
+
+int main()
+{
+  checkVarints();
+  checkZigZag();
+  checkTagsAndFixedValues();
+  checkMalformedInput();
+  checkPacked();
+  checkFullBuffer();
+  return test::finishTest("test_protobuf");
+}
@@ -0,0 +1,170 @@
+#include <array>
+
+#include "Schema.hpp"
+#include "Test.hpp"
+
+// **** **** **** ****
+// NOTE: Checks Schema evolution between two versions of a message: old -> new fills the missing trailing
+//       fields with their defaults, new -> old skips the unknown trailing fields, trailing defaults are
+//       omitted by the sender, and inconsistent or truncated headers are rejected. A value written after
+//       each message is read back, to check that the receiver stops exactly at the end of the message.
+// **** **** **** ****
+
+using namespace halvoe;
+
+namespace
+{
+  enum class Mode : uint8_t
+  {
+    idle = 0,
+    cruise = 2,
+    dive = 5
+  };
+
+  struct CommandV1
+  {
+    uint16_t id = 0;
+    float speed = 1.5f;
+  };
+
+  struct CommandV2
+  {
+    uint16_t id = 0;
+    float speed = 1.5f;
+    Mode mode = Mode::cruise;
+    int64_t deadline = -1;
+  };
+
+  using SchemaV1 = Schema<CommandV1, SchemaField<CommandV1, uint16_t, &CommandV1::id, 1>, SchemaField<CommandV1, float, &CommandV1::speed, 1>>;
+  using SchemaV2 = Schema<CommandV2, SchemaField<CommandV2, uint16_t, &CommandV2::id, 1>, SchemaField<CommandV2, float, &CommandV2::speed, 1>,
+                          SchemaField<CommandV2, Mode, &CommandV2::mode, 2>, SchemaField<CommandV2, int64_t, &CommandV2::deadline, 2>>;
+
+  constexpr uint32_t c_trailer = 0xa5c3e1f0;
+  constexpr size_t c_headerSize = 2 * c_typeTagSize + sizeof(uint8_t) + sizeof(uint16_t);
+
+  using Buffer = std::array<uint8_t, 64>;
+
+  void checkVersions()
+  {
+    HALVOE_CHECK(SchemaV1::c_version == 1 && SchemaV2::c_version == 2);
+    HALVOE_CHECK(SchemaV2::getFieldCount() == 4 && SchemaV2::getFieldCount(1) == 2 && SchemaV2::getFieldCount(0) == 0 && SchemaV2::getFieldCount(9) == 4);
+    HALVOE_CHECK(SchemaV2::getDefaults().mode == Mode::cruise && SchemaV2::getDefaults().deadline == -1);
+  }
+
+  void checkOldToNew()
+  {
+    Buffer buffer{};
+    Serializer<64> serializer(buffer);
+    HALVOE_CHECK(SchemaV1::serialize(CommandV1{ 7, -2.25f }, serializer) && serializer.write<uint32_t>(c_trailer));
+
+    Deserializer<64> deserializer(buffer);
+    CommandV2 command{ 1, 1.0f, Mode::dive, 99 };
+    HALVOE_CHECK(SchemaV2::deserialize(deserializer, command));
+    HALVOE_CHECK(command.id == 7 && command.speed == -2.25f && command.mode == Mode::cruise && command.deadline == -1);
+    HALVOE_CHECK(deserializer.read<uint32_t>() == c_trailer);
+  }
+
+  void checkNewToOld()
+  {
+    Buffer buffer{};
+    Serializer<64> serializer(buffer);
+    HALVOE_CHECK(SchemaV2::serialize(CommandV2{ 9, 4.0f, Mode::dive, 1700000000123 }, serializer) && serializer.write<uint32_t>(c_trailer));
+    HALVOE_CHECK(serializer.getBytesWritten() == c_headerSize + 4 * c_typeTagSize + 2 + 4 + 1 + 8 + c_typeTagSize + 4);
+
+    Deserializer<64> deserializer(buffer);
+    CommandV1 command;
+    HALVOE_CHECK(SchemaV1::deserialize(deserializer, command));
+    HALVOE_CHECK(command.id == 9 && command.speed == 4.0f);
+    HALVOE_CHECK(deserializer.read<uint32_t>() == c_trailer);
+
+    // Only the new field is set: the old receiver skips both new fields.
+    Buffer modeBuffer{};
+    Serializer<64> modeSerializer(modeBuffer);
+    HALVOE_CHECK(SchemaV2::serialize(CommandV2{ 0, 1.5f, Mode::idle, -1 }, modeSerializer) && modeSerializer.write<uint32_t>(c_trailer));
+    Deserializer<64> modeDeserializer(modeBuffer);
+    HALVOE_CHECK(SchemaV1::deserialize(modeDeserializer, command) && command.id == 0 && command.speed == 1.5f);
+    HALVOE_CHECK(modeDeserializer.read<uint32_t>() == c_trailer);
+
+    // The same message is read in full by a receiver on the new version.
+    Deserializer<64> newDeserializer(buffer);
+    CommandV2 newCommand;
+    HALVOE_CHECK(SchemaV2::deserialize(newDeserializer, newCommand));
+    HALVOE_CHECK(newCommand.id == 9 && newCommand.speed == 4.0f && newCommand.mode == Mode::dive && newCommand.deadline == 1700000000123);
+    HALVOE_CHECK(newDeserializer.read<uint32_t>() == c_trailer);
+  }
+
+  void checkOmittedDefaults()
+  {
+    // A message equal to the defaults is only its header.
+    Buffer buffer{};
+    Serializer<64> serializer(buffer);
+    HALVOE_CHECK(SchemaV2::serialize(CommandV2{}, serializer) && serializer.getBytesWritten() == c_headerSize);
+
+    // Trailing defaults are dropped, an inner default is kept.
+    Serializer<64> innerSerializer(buffer);
+    HALVOE_CHECK(SchemaV2::serialize(CommandV2{ 0, 1.5f, Mode::dive, -1 }, innerSerializer));
+    HALVOE_CHECK(innerSerializer.getBytesWritten() == c_headerSize + 3 * c_typeTagSize + 2 + 4 + 1);
+    Deserializer<64> deserializer(buffer);
+    CommandV2 command{ 5, 5.0f, Mode::idle, 5 };
+    HALVOE_CHECK(SchemaV2::deserialize(deserializer, command));
+    HALVOE_CHECK(command.id == 0 && command.speed == 1.5f && command.mode == Mode::dive && command.deadline == -1);
+
+    // Serializing for version 1 drops the new fields, even if they are set.
+    Serializer<64> oldSerializer(buffer);
+    HALVOE_CHECK(SchemaV2::serialize(CommandV2{ 3, 1.5f, Mode::dive, 42 }, oldSerializer, 1));
+    HALVOE_CHECK(oldSerializer.getBytesWritten() == c_headerSize + c_typeTagSize + 2);
+    Deserializer<64> oldDeserializer(buffer);
+    HALVOE_CHECK(SchemaV2::deserialize(oldDeserializer, command) && command.id == 3 && command.mode == Mode::cruise && command.deadline == -1);
+  }
+
+  void checkRejected()
+  {
+    Buffer buffer{};
+    Serializer<64> serializer(buffer);
+    HALVOE_CHECK(SchemaV2::serialize(CommandV2{ 9, 4.0f, Mode::dive, 7 }, serializer));
+    const size_t messageSize = serializer.getBytesWritten();
+    const size_t sizeOffset = 2 * c_typeTagSize + sizeof(uint8_t);
+
+    // A size that does not match the field count of a known version.
+    Buffer wrongSize = buffer;
+    wrongSize[sizeOffset] = static_cast<uint8_t>(wrongSize[sizeOffset] + 1);
+    Deserializer<64> wrongSizeDeserializer(wrongSize);
+    CommandV2 command;
+    HALVOE_CHECK(!SchemaV2::deserialize(wrongSizeDeserializer, command));
+
+    // A newer message, whose size is too small for the fields the receiver knows.
+    Buffer tooSmall = buffer;
+    tooSmall[sizeOffset] = static_cast<uint8_t>(SchemaV1::getFieldCount() * c_typeTagSize + 2 + 4 - 1);
+    Deserializer<64> tooSmallDeserializer(tooSmall);
+    CommandV1 oldCommand;
+    HALVOE_CHECK(!SchemaV1::deserialize(tooSmallDeserializer, oldCommand));
+
+    // A newer message, whose size exceeds the buffer.
+    Buffer tooLarge = buffer;
+    tooLarge[sizeOffset] = 0xff;
+    Deserializer<64> tooLargeDeserializer(tooLarge);
+    HALVOE_CHECK(!SchemaV1::deserialize(tooLargeDeserializer, oldCommand));
+
+    // A message cut off at the end of the receive buffer, and a buffer too small for the header.
+    HALVOE_CHECK(messageSize > 16);
+    Deserializer<16> truncatedDeserializer(buffer.data());
+    HALVOE_CHECK(!SchemaV2::deserialize(truncatedDeserializer, command));
+    Deserializer<c_headerSize - 1> headerDeserializer(buffer.data());
+    HALVOE_CHECK(!SchemaV2::deserialize(headerDeserializer, command));
+
+    // A message sent into a buffer too small for it fails.
+    std::array<uint8_t, 16> smallBuffer{};
+    Serializer<16> smallSerializer(smallBuffer);
+    HALVOE_CHECK(!SchemaV2::serialize(CommandV2{ 9, 4.0f, Mode::dive, 7 }, smallSerializer));
+  }
+}
+
+int main()
+{
+  checkVersions();
+  checkOldToNew();
+  checkNewToOld();
+  checkOmittedDefaults();
+  checkRejected();
+  return test::finishTest("test_schema");
+}
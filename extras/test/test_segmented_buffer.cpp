@@ -0,0 +1,452 @@
+#include <array>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "RingDeserializer.hpp"
+#include "SegmentedBuffer.hpp"
+#include "Test.hpp"
+
+// **** **** **** ****
+// NOTE: Checks that SegmentedSerializer writes the same bytes as Serializer for random messages with
+//       block sizes 1, 3, 7, 64 and 256, and that a write the pool runs out of blocks for partway gives
+//       the blocks back and leaves the message as it was. SegmentedDeserializer reads the flat bytes back
+//       split into random segments (with empty ones) of at most 1, 3, 7, 64 and 256 bytes, through all
+//       of its string reads, and stops without consuming anything at a field cut off by the end.
+//       RingDeserializer reads a frame at every start position of a ring, with a string that view() returns
+//       split across the wrap, and getTail() follows the reads; invalid head/tail/capacity read as empty.
+// **** **** **** ****
+
+using namespace halvoe;
+
+namespace
+{
+  enum class Color : uint16_t
+  {
+    red = 1,
+    green = 300,
+    blue = 65000
+  };
+
+  enum class Kind : uint8_t
+  {
+    u8,
+    i16,
+    u32,
+    i64,
+    f32,
+    f64,
+    boolean,
+    color,
+    string,
+    array
+  };
+
+  // One field of a random message; value holds the bits of the arithmetic kinds.
+  struct Field
+  {
+    Kind kind = Kind::u8;
+    uint64_t value = 0;
+    std::string text;
+    std::vector<uint16_t> elements;
+  };
+
+  using Message = std::vector<Field>;
+
+  constexpr size_t c_maxMessageSize = 4096;
+  constexpr size_t c_maxFieldCount = 16;
+  constexpr size_t c_maxStringSize = 200;
+
+  Message makeMessage(std::mt19937& io_generator)
+  {
+    Message message(1 + io_generator() % c_maxFieldCount);
+    for (Field& field : message)
+    {
+      field.kind = static_cast<Kind>(io_generator() % 10);
+      field.value = (uint64_t{ io_generator() } << 32) | io_generator();
+      field.text.resize(io_generator() % (c_maxStringSize + 1));
+      for (char& character : field.text) { character = static_cast<char>(io_generator()); }
+      field.elements.resize(1 + io_generator() % 40);
+      for (uint16_t& element : field.elements) { element = static_cast<uint16_t>(io_generator()); }
+    }
+    return message;
+  }
+
+  float getFloat(uint64_t in_bits)
+  {
+    const uint32_t bits = static_cast<uint32_t>(in_bits);
+    float value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+  }
+
+  double getDouble(uint64_t in_bits)
+  {
+    double value;
+    std::memcpy(&value, &in_bits, sizeof(value));
+    return value;
+  }
+
+  Color getColor(uint64_t in_value)
+  {
+    const Color colors[3] = { Color::red, Color::green, Color::blue };
+    return colors[in_value % 3];
+  }
+
+  template<typename SerializerType>
+  bool writeField(SerializerType& io_serializer, const Field& in_field)
+  {
+    switch (in_field.kind)
+    {
+      case Kind::u8: return io_serializer.template write<uint8_t>(static_cast<uint8_t>(in_field.value));
+      case Kind::i16: return io_serializer.template write<int16_t>(static_cast<int16_t>(in_field.value));
+      case Kind::u32: return io_serializer.template write<uint32_t>(static_cast<uint32_t>(in_field.value));
+      case Kind::i64: return io_serializer.template write<int64_t>(static_cast<int64_t>(in_field.value));
+      case Kind::f32: return io_serializer.write(getFloat(in_field.value));
+      case Kind::f64: return io_serializer.write(getDouble(in_field.value));
+      case Kind::boolean: return io_serializer.write(in_field.value % 2 == 0);
+      case Kind::color: return io_serializer.writeEnum(getColor(in_field.value));
+      case Kind::string: return io_serializer.write(in_field.text.data(), static_cast<uint16_t>(in_field.text.size()));
+      case Kind::array: return io_serializer.writeArray(in_field.elements.data(), in_field.elements.size());
+    }
+    return false;
+  }
+
+  // Serializes in_message into out_bytes with the flat Serializer.
+  bool serialize(const Message& in_message, std::vector<uint8_t>& out_bytes)
+  {
+    std::array<uint8_t, c_maxMessageSize> buffer;
+    Serializer<c_maxMessageSize> serializer(buffer);
+    for (const Field& field : in_message)
+    {
+      if (!writeField(serializer, field)) { return false; }
+    }
+    out_bytes.assign(buffer.begin(), buffer.begin() + static_cast<std::ptrdiff_t>(serializer.getBytesWritten()));
+    return true;
+  }
+
+  std::vector<uint8_t> flatten(const BufferSegment* in_segments, size_t in_segmentCount)
+  {
+    std::vector<uint8_t> bytes;
+    for (size_t index = 0; index < in_segmentCount; ++index)
+    {
+      bytes.insert(bytes.end(), in_segments[index].data, in_segments[index].data + in_segments[index].size);
+    }
+    return bytes;
+  }
+
+  template<size_t tc_blockSize>
+  void checkSerializer(std::mt19937& io_generator)
+  {
+    constexpr size_t c_blockCount = c_maxMessageSize / tc_blockSize + 1;
+    static BlockPool<tc_blockSize, c_blockCount> pool;
+    size_t mismatchCount = 0;
+
+    for (size_t trial = 0; trial < 100; ++trial)
+    {
+      const Message message = makeMessage(io_generator);
+      std::vector<uint8_t> expected;
+      SegmentedSerializer<tc_blockSize, c_blockCount> serializer(pool);
+      bool isWritten = serialize(message, expected);
+      for (const Field& field : message) { isWritten = isWritten && writeField(serializer, field); }
+
+      // Every block but the last is full.
+      std::vector<BufferSegment> segments(c_blockCount);
+      const size_t segmentCount = serializer.getSegments(segments.data(), segments.size());
+      bool areBlocksFull = segmentCount == (expected.size() + tc_blockSize - 1) / tc_blockSize && segmentCount == serializer.getSegmentCount();
+      for (size_t index = 0; index + 1 < segmentCount; ++index) { areBlocksFull = areBlocksFull && segments[index].size == tc_blockSize; }
+
+      if (!isWritten || !areBlocksFull || serializer.getBytesWritten() != expected.size() || flatten(segments.data(), segmentCount) != expected ||
+          (segmentCount > 0 && serializer.getSegments(segments.data(), segmentCount - 1) != 0))
+      {
+        mismatchCount = mismatchCount + 1;
+      }
+    }
+
+    if (!HALVOE_CHECK(mismatchCount == 0)) { std::printf("  block size %zu: %zu mismatches\n", tc_blockSize, mismatchCount); }
+    HALVOE_CHECK(pool.getBlocksInUse() == 0);
+  }
+
+  // Splits in_bytes into segments of random sizes up to in_maxSegmentSize, empty ones included.
+  std::vector<BufferSegment> split(std::mt19937& io_generator, const std::vector<uint8_t>& in_bytes, size_t in_maxSegmentSize)
+  {
+    std::vector<BufferSegment> segments;
+    size_t offset = 0;
+    while (offset < in_bytes.size())
+    {
+      size_t size = io_generator() % (in_maxSegmentSize + 1);
+      if (size > in_bytes.size() - offset) { size = in_bytes.size() - offset; }
+      segments.push_back(BufferSegment{ in_bytes.data() + offset, size });
+      offset = offset + size;
+    }
+    segments.push_back(BufferSegment{ in_bytes.data() + offset, 0 });
+    return segments;
+  }
+
+  // Reads a string through one of view(SizeType&), view(BufferSegment*, ...) and read(char*, ...),
+  // each first with a failing call that must not consume anything.
+  bool readString(SegmentedDeserializer& io_deserializer, const std::string& in_expected, std::mt19937& io_generator)
+  {
+    const size_t bytesRead = io_deserializer.getBytesRead();
+    uint16_t size = 0;
+    std::string text;
+    switch (io_generator() % 3)
+    {
+      case 0:
+      {
+        const char* view = io_deserializer.view(size);
+        if (view == nullptr)
+        {
+          // Spread over several segments.
+          char copy[c_maxStringSize + 1];
+          if (io_deserializer.getBytesRead() != bytesRead || !io_deserializer.read(copy, sizeof(copy), size)) { return false; }
+          text.assign(copy, size);
+        }
+        else { text.assign(view, size); }
+        break;
+      }
+      case 1:
+      {
+        BufferSegment spans[c_maxStringSize];
+        size_t spanCount = 0;
+        if (in_expected.empty()) { return io_deserializer.view(spans, 0, spanCount, size) && spanCount == 0 && size == 0; }
+        if (io_deserializer.view(spans, 0, spanCount, size) || io_deserializer.getBytesRead() != bytesRead) { return false; }
+        if (!io_deserializer.view(spans, c_maxStringSize, spanCount, size)) { return false; }
+        const std::vector<uint8_t> bytes = flatten(spans, spanCount);
+        text.assign(bytes.begin(), bytes.end());
+        break;
+      }
+      default:
+      {
+        char copy[c_maxStringSize + 1];
+        if (io_deserializer.read(copy, in_expected.size(), size)) { return false; } // no room for the '\0'
+        if (io_deserializer.getBytesRead() != bytesRead || !io_deserializer.read(copy, sizeof(copy), size) || copy[size] != '\0') { return false; }
+        text.assign(copy, size);
+        break;
+      }
+    }
+    return size == in_expected.size() && text == in_expected;
+  }
+
+  bool readField(SegmentedDeserializer& io_deserializer, const Field& in_field, std::mt19937& io_generator)
+  {
+    switch (in_field.kind)
+    {
+      case Kind::u8: return io_deserializer.read<uint8_t>() == static_cast<uint8_t>(in_field.value);
+      case Kind::i16: return io_deserializer.read<int16_t>() == static_cast<int16_t>(in_field.value);
+      case Kind::u32: return io_deserializer.read<uint32_t>() == static_cast<uint32_t>(in_field.value);
+      case Kind::i64: return io_deserializer.read<int64_t>() == static_cast<int64_t>(in_field.value);
+      case Kind::f32:
+      {
+        const float value = io_deserializer.read<float>();
+        const float expected = getFloat(in_field.value);
+        return std::memcmp(&value, &expected, sizeof(value)) == 0;
+      }
+      case Kind::f64:
+      {
+        const double value = io_deserializer.read<double>();
+        const double expected = getDouble(in_field.value);
+        return std::memcmp(&value, &expected, sizeof(value)) == 0;
+      }
+      case Kind::boolean: return io_deserializer.read<bool>() == (in_field.value % 2 == 0);
+      case Kind::color: return io_deserializer.readEnum<Color>() == getColor(in_field.value);
+      case Kind::string: return readString(io_deserializer, in_field.text, io_generator);
+      case Kind::array:
+      {
+        std::vector<uint16_t> elements(in_field.elements.size());
+        return io_deserializer.readArray(elements.data(), elements.size()) && elements == in_field.elements;
+      }
+    }
+    return false;
+  }
+
+  void checkDeserializer(std::mt19937& io_generator)
+  {
+    const size_t maxSegmentSizes[] = { 1, 3, 7, 64, 256 };
+    size_t mismatchCount = 0;
+    size_t truncatedMismatchCount = 0;
+
+    for (size_t trial = 0; trial < 200; ++trial)
+    {
+      const Message message = makeMessage(io_generator);
+      std::vector<uint8_t> bytes;
+      HALVOE_CHECK(serialize(message, bytes));
+      for (size_t maxSegmentSize : maxSegmentSizes)
+      {
+        const std::vector<BufferSegment> segments = split(io_generator, bytes, maxSegmentSize);
+        SegmentedDeserializer deserializer(segments.data(), segments.size());
+        bool isRead = deserializer.getSize() == bytes.size();
+        for (const Field& field : message) { isRead = isRead && readField(deserializer, field, io_generator); }
+        if (!isRead || deserializer.getBytesRead() != bytes.size() || deserializer.getBytesLeft() != 0 || deserializer.skip<uint8_t>())
+        {
+          mismatchCount = mismatchCount + 1;
+        }
+      }
+
+      // Without its last byte, the last field fails and the position stays at its start.
+      std::vector<uint8_t> leadingBytes;
+      HALVOE_CHECK(serialize(Message(message.begin(), message.end() - 1), leadingBytes));
+      const std::vector<uint8_t> truncated(bytes.begin(), bytes.end() - 1);
+      const std::vector<BufferSegment> segments = split(io_generator, truncated, maxSegmentSizes[io_generator() % 5]);
+      SegmentedDeserializer deserializer(segments.data(), segments.size());
+      bool isRead = true;
+      for (size_t index = 0; index + 1 < message.size(); ++index) { isRead = isRead && readField(deserializer, message[index], io_generator); }
+      // A failed read<bool>() returns true, so only the position tells whether the last field was read.
+      readField(deserializer, message.back(), io_generator);
+      if (!isRead || deserializer.getBytesRead() != leadingBytes.size())
+      {
+        truncatedMismatchCount = truncatedMismatchCount + 1;
+      }
+    }
+
+    HALVOE_CHECK(mismatchCount == 0);
+    HALVOE_CHECK(truncatedMismatchCount == 0);
+
+    SegmentedDeserializer empty(nullptr, 0);
+    HALVOE_CHECK(empty.getSize() == 0 && empty.getBytesLeft() == 0 && !empty.skip<uint8_t>() && empty.read<uint16_t>() == 0xffff);
+  }
+
+  void checkRing()
+  {
+    constexpr size_t c_capacity = 64;
+    constexpr size_t c_stringSize = 20;
+    const char text[] = "abcdefghijklmnopqrst";
+
+    std::array<uint8_t, 64> frame;
+    Serializer<64> serializer(frame);
+    HALVOE_CHECK(serializer.write<uint16_t>(0xbeef) && serializer.write(text, static_cast<uint8_t>(c_stringSize)) && serializer.write<uint32_t>(0xc0ffee));
+    const size_t frameSize = serializer.getBytesWritten();
+    const size_t stringOffset = 2 * c_typeTagSize + sizeof(uint16_t) + sizeof(uint8_t);
+
+    size_t wrappedStringCount = 0;
+    size_t mismatchCount = 0;
+    for (size_t tail = 0; tail < c_capacity; ++tail)
+    {
+      std::array<uint8_t, c_capacity> ring{};
+      for (size_t index = 0; index < frameSize; ++index) { ring[(tail + index) % c_capacity] = frame[index]; }
+      const size_t head = (tail + frameSize) % c_capacity;
+
+      RingDeserializer deserializer(ring.data(), c_capacity, head, tail);
+      bool isRead = deserializer.getBytesLeft() == frameSize && deserializer.getTail() == tail;
+      isRead = isRead && deserializer.read<uint16_t>() == 0xbeef && deserializer.getTail() == (tail + c_typeTagSize + 2) % c_capacity;
+
+      // The string wraps, if it starts before the end of the ring and ends behind it.
+      BufferSegment first;
+      BufferSegment second;
+      uint8_t size = 0;
+      const size_t stringStart = tail + stringOffset;
+      const size_t wrappedSize = stringStart < c_capacity && stringStart + c_stringSize > c_capacity ? stringStart + c_stringSize - c_capacity : 0;
+      isRead = isRead && deserializer.view(first, second, size) && size == c_stringSize && first.data == ring.data() + stringStart % c_capacity &&
+               first.size == c_stringSize - wrappedSize && second.size == wrappedSize && (wrappedSize == 0 || second.data == ring.data());
+      if (isRead)
+      {
+        std::string string(reinterpret_cast<const char*>(first.data), first.size);
+        if (second.size > 0) { string.append(reinterpret_cast<const char*>(second.data), second.size); }
+        isRead = string == text;
+      }
+      if (wrappedSize > 0) { wrappedStringCount = wrappedStringCount + 1; }
+
+      isRead = isRead && deserializer.read<uint32_t>() == 0xc0ffee && deserializer.getTail() == head && deserializer.getBytesLeft() == 0;
+      isRead = isRead && !deserializer.skip<uint8_t>() && deserializer.getTail() == head;
+      if (!isRead) { mismatchCount = mismatchCount + 1; }
+    }
+
+    HALVOE_CHECK(mismatchCount == 0);
+    HALVOE_CHECK(wrappedStringCount == c_stringSize - 1);
+
+    // A frame whose string is not completely received yet: view() fails and the tail stays before it.
+    std::array<uint8_t, c_capacity> ring{};
+    const size_t tail = c_capacity - stringOffset - 4;
+    for (size_t index = 0; index < frameSize; ++index) { ring[(tail + index) % c_capacity] = frame[index]; }
+    RingDeserializer partial(ring.data(), c_capacity, (tail + stringOffset + 10) % c_capacity, tail);
+    BufferSegment first;
+    BufferSegment second;
+    uint8_t size = 0;
+    HALVOE_CHECK(partial.read<uint16_t>() == 0xbeef);
+    const size_t stringTail = partial.getTail();
+    HALVOE_CHECK(!partial.view(first, second, size) && partial.getTail() == stringTail);
+    char string[c_stringSize + 1];
+    HALVOE_CHECK(!partial.read(string, sizeof(string), size) && partial.getTail() == stringTail);
+  }
+
+  void checkInvalidRing()
+  {
+    std::array<uint8_t, 16> ring{};
+
+    // head == tail: nothing to read.
+    RingDeserializer empty(ring.data(), ring.size(), 5, 5);
+    HALVOE_CHECK(empty.getBytesLeft() == 0 && empty.getTail() == 5 && !empty.fitsInBuffer(1));
+
+    // Indices outside the ring and a ring without capacity read as empty, with a tail of 0.
+    const size_t invalid[][3] = { { 16, 16, 0 }, { 16, 0, 16 }, { 16, 99, 3 }, { 16, 3, 99 }, { 0, 0, 0 }, { 0, 1, 0 } };
+    for (const size_t* indices : invalid)
+    {
+      RingDeserializer deserializer(ring.data(), indices[0], indices[1], indices[2]);
+      HALVOE_CHECK(deserializer.getBytesLeft() == 0 && deserializer.getTail() == 0 && !deserializer.skip<uint8_t>() && deserializer.getBytesRead() == 0);
+    }
+    RingDeserializer null(nullptr, 0, 0, 0);
+    HALVOE_CHECK(null.getBytesLeft() == 0 && null.getTail() == 0 && null.read<uint8_t>() == 0xff);
+
+    // The largest valid ring: head one behind the tail.
+    RingDeserializer full(ring.data(), ring.size(), 15, 0);
+    HALVOE_CHECK(full.getBytesLeft() == 15 && full.fitsInBuffer(15) && !full.fitsInBuffer(16));
+    RingDeserializer fullWrapped(ring.data(), ring.size(), 4, 5);
+    HALVOE_CHECK(fullWrapped.getBytesLeft() == 15 && fullWrapped.getTail() == 5);
+  }
+
+  void checkReserveRollback()
+  {
+    BlockPool<8, 4> pool;
+    SegmentedSerializer<8, 4> serializer(pool);
+    char text[40];
+    std::memset(text, 't', sizeof(text));
+
+    // Larger than the whole pool: the chain stays empty.
+    HALVOE_CHECK(!serializer.write(text, static_cast<uint8_t>(40)));
+    HALVOE_CHECK(pool.getBlocksInUse() == 0 && serializer.getBytesWritten() == 0 && serializer.getSegmentCount() == 0);
+
+    // 12 bytes (14 with tags) in two blocks; a 20 char string or 30 element array needs three more, but only two are left.
+    HALVOE_CHECK(serializer.write<uint32_t>(0x01020304) && serializer.write<uint64_t>(0x05060708090a0b0c));
+    const size_t bytesWritten = serializer.getBytesWritten();
+    HALVOE_CHECK(pool.getBlocksInUse() == 2);
+    HALVOE_CHECK(!serializer.write(text, static_cast<uint8_t>(20)) && !serializer.writeArray(text, 30));
+    HALVOE_CHECK(pool.getBlocksInUse() == 2 && serializer.getBytesWritten() == bytesWritten && serializer.getSegmentCount() == 2);
+
+    // Another serializer can take the blocks that were given back, and this one grows again once they are free.
+    {
+      SegmentedSerializer<8, 4> other(pool);
+      HALVOE_CHECK(other.writeArray(text, 15) && pool.getBlocksInUse() == 4);
+      HALVOE_CHECK(!serializer.write<uint64_t>(1) && serializer.getBytesWritten() == bytesWritten);
+    }
+    HALVOE_CHECK(serializer.write(text, static_cast<uint8_t>(10)));
+    HALVOE_CHECK(pool.getBlocksInUse() == (serializer.getBytesWritten() + 7) / 8);
+
+    // The failed writes left no trace in the bytes.
+    std::array<uint8_t, 64> buffer;
+    Serializer<64> expected(buffer);
+    HALVOE_CHECK(expected.write<uint32_t>(0x01020304) && expected.write<uint64_t>(0x05060708090a0b0c) && expected.write(text, static_cast<uint8_t>(10)));
+    BufferSegment segments[4];
+    const size_t segmentCount = serializer.getSegments(segments, 4);
+    HALVOE_CHECK(flatten(segments, segmentCount) == std::vector<uint8_t>(buffer.begin(), buffer.begin() + static_cast<std::ptrdiff_t>(expected.getBytesWritten())));
+
+    serializer.reset();
+    HALVOE_CHECK(pool.getBlocksInUse() == 0 && serializer.getBytesWritten() == 0);
+  }
+}
+
+int main()
+{
+  std::mt19937 generator(120);
+  checkSerializer<1>(generator);
+  checkSerializer<3>(generator);
+  checkSerializer<7>(generator);
+  checkSerializer<64>(generator);
+  checkSerializer<256>(generator);
+  checkReserveRollback();
+  checkDeserializer(generator);
+  checkRing();
+  checkInvalidRing();
+  return test::finishTest("test_segmented_buffer");
+}
@@ -0,0 +1,131 @@
+#include "SerializationCache.hpp"
+#include "Test.hpp"
+
+// **** **** **** ****
+// NOTE: Checks the eviction of SerializationCache::getOrSerialize when its SharedBufferPool is exhausted:
+//       only entries no client holds are evicted, least recently used first, and the cache keeps all of
+//       its entries when clients hold every buffer of the pool.
+// **** **** **** ****
+
+using namespace halvoe;
+
+namespace
+{
+  struct Config
+  {
+    uint32_t value = 0;
+  };
+
+  struct Serialize
+  {
+    const Config& config;
+    size_t& callCount;
+
+    bool operator()(Serializer<32>& out_serializer) const
+    {
+      callCount = callCount + 1;
+      return out_serializer.write<uint32_t>(config.value);
+    }
+  };
+
+  uint32_t readValue(const SharedBuffer& in_buffer)
+  {
+    Deserializer<32> deserializer(in_buffer.getBuffer());
+    return deserializer.read<uint32_t>();
+  }
+
+  // Clients hold both buffers of the pool: a third object cannot be cached, and nothing is evicted.
+  void checkAllBuffersHeld()
+  {
+    SharedBufferPool<32, 2> pool;
+    SerializationCache<4> cache;
+    const Config first{ 1 };
+    const Config second{ 2 };
+    const Config third{ 3 };
+    size_t callCount = 0;
+
+    const SharedBuffer firstClient = cache.getOrSerialize(pool, &first, 1, Serialize{ first, callCount });
+    const SharedBuffer secondClient = cache.getOrSerialize(pool, &second, 1, Serialize{ second, callCount });
+    HALVOE_CHECK(!firstClient.isNull() && !secondClient.isNull() && pool.getBuffersInUse() == 2);
+
+    const SharedBuffer thirdClient = cache.getOrSerialize(pool, &third, 1, Serialize{ third, callCount });
+    HALVOE_CHECK(thirdClient.isNull());
+    HALVOE_CHECK(callCount == 2);
+    HALVOE_CHECK(cache.getEntryCount() == 2);
+    HALVOE_CHECK(firstClient.getReferenceCount() == 2 && secondClient.getReferenceCount() == 2);
+
+    const SharedBuffer firstHit = cache.find(&first, 1);
+    const SharedBuffer secondHit = cache.find(&second, 1);
+    HALVOE_CHECK(!firstHit.isNull() && !secondHit.isNull());
+    if (firstHit.isNull() || secondHit.isNull()) { return; }
+    HALVOE_CHECK(firstHit.getBuffer() == firstClient.getBuffer() && secondHit.getBuffer() == secondClient.getBuffer());
+    HALVOE_CHECK(readValue(firstHit) == 1 && readValue(secondHit) == 2);
+  }
+
+  // Once a client lets go, that entry (and only that one) makes room for the next object.
+  void checkIdleEntryEvicted()
+  {
+    SharedBufferPool<32, 2> pool;
+    SerializationCache<4> cache;
+    const Config first{ 1 };
+    const Config second{ 2 };
+    const Config third{ 3 };
+    size_t callCount = 0;
+
+    // The older entry is held, the newer one is idle: the idle one goes, although it is more recently used.
+    const SharedBuffer firstClient = cache.getOrSerialize(pool, &first, 1, Serialize{ first, callCount });
+    cache.getOrSerialize(pool, &second, 1, Serialize{ second, callCount });
+
+    const SharedBuffer thirdClient = cache.getOrSerialize(pool, &third, 1, Serialize{ third, callCount });
+    HALVOE_CHECK(!thirdClient.isNull() && readValue(thirdClient) == 3);
+    HALVOE_CHECK(cache.getEntryCount() == 2);
+    HALVOE_CHECK(!cache.find(&first, 1).isNull());
+    HALVOE_CHECK(cache.find(&second, 1).isNull());
+  }
+
+  void checkLeastRecentlyUsedIdleEvicted()
+  {
+    SharedBufferPool<32, 3> pool;
+    SerializationCache<4> cache;
+    const Config configs[4] = { { 1 }, { 2 }, { 3 }, { 4 } };
+    size_t callCount = 0;
+
+    for (size_t index = 0; index < 3; ++index) { cache.getOrSerialize(pool, &configs[index], 1, Serialize{ configs[index], callCount }); }
+    cache.find(&configs[0], 1); // configs[1] is now the least recently used entry
+
+    HALVOE_CHECK(!cache.getOrSerialize(pool, &configs[3], 1, Serialize{ configs[3], callCount }).isNull());
+    HALVOE_CHECK(cache.getEntryCount() == 3);
+    HALVOE_CHECK(!cache.find(&configs[0], 1).isNull());
+    HALVOE_CHECK(cache.find(&configs[1], 1).isNull());
+    HALVOE_CHECK(!cache.find(&configs[2], 1).isNull());
+    HALVOE_CHECK(!cache.find(&configs[3], 1).isNull());
+  }
+
+  void checkFailedSerialization()
+  {
+    SharedBufferPool<32, 1> pool;
+    SerializationCache<2> cache;
+    const Config config{ 7 };
+
+    HALVOE_CHECK(cache.getOrSerialize(pool, &config, 1, [](Serializer<32>&) { return false; }).isNull());
+    HALVOE_CHECK(pool.getBuffersInUse() == 0 && cache.getEntryCount() == 0);
+
+    size_t callCount = 0;
+    HALVOE_CHECK(!cache.getOrSerialize(pool, &config, 1, Serialize{ config, callCount }).isNull());
+    HALVOE_CHECK(!cache.getOrSerialize(pool, &config, 1, Serialize{ config, callCount }).isNull());
+    HALVOE_CHECK(callCount == 1 && cache.getHitCount() == 1);
+
+    // A new version misses, drops the stale entry and serializes into the buffer that frees.
+    const SharedBuffer updated = cache.getOrSerialize(pool, &config, 2, Serialize{ config, callCount });
+    HALVOE_CHECK(!updated.isNull() && callCount == 2 && cache.getEntryCount() == 1);
+  }
+}
+
+int main()
+{
+  checkAllBuffersHeld();
+  checkIdleEntryEvicted();
+  checkLeastRecentlyUsedIdleEvicted();
+  checkFailedSerialization();
+  return test::finishTest("test_serialization_cache");
+}
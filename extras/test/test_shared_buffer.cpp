@@ -0,0 +1,155 @@
+#include <utility>
+
+#include "SharedBuffer.hpp"
+#include "Test.hpp"
+
+// **** **** **** ****
+// NOTE: Checks SharedBufferPool and SharedBuffer: acquire until the pool is exhausted, release and
+//       finalise, the reference count of copies and moves, and that a buffer goes back to the pool
+//       exactly when the last SharedBuffer of it is dropped.
+// **** **** **** ****
+
+using namespace halvoe;
+
+namespace
+{
+  SharedBuffer writeFrame(SharedBufferPool<16, 3>& io_pool, uint32_t in_value)
+  {
+    uint8_t* data = io_pool.acquire();
+    if (data == nullptr) { return SharedBuffer(); }
+
+    Serializer<16> serializer(data);
+    serializer.write<uint32_t>(in_value);
+    return io_pool.finalise(serializer);
+  }
+
+  void checkAcquireUntilExhausted()
+  {
+    SharedBufferPool<16, 3> pool;
+    HALVOE_CHECK(pool.getBufferSize() == 16 && pool.getBufferCount() == 3 && pool.getBuffersInUse() == 0);
+
+    uint8_t* buffers[3] = {};
+    for (size_t index = 0; index < 3; ++index)
+    {
+      buffers[index] = pool.acquire();
+      HALVOE_CHECK(buffers[index] != nullptr && pool.getBuffersInUse() == index + 1);
+    }
+    HALVOE_CHECK(buffers[0] != buffers[1] && buffers[1] != buffers[2] && buffers[0] != buffers[2]);
+    HALVOE_CHECK(pool.acquire() == nullptr);
+
+    // An unfinalised buffer goes back with release(), and is the next one acquired.
+    HALVOE_CHECK(pool.release(buffers[1]));
+    HALVOE_CHECK(pool.getBuffersInUse() == 2);
+    HALVOE_CHECK(pool.acquire() == buffers[1]);
+    HALVOE_CHECK(pool.acquire() == nullptr);
+
+    // Foreign pointers are rejected.
+    uint8_t foreign[16] = {};
+    HALVOE_CHECK(!pool.release(foreign));
+    Serializer<16> foreignSerializer(foreign);
+    HALVOE_CHECK(pool.finalise(foreignSerializer).isNull());
+
+    for (uint8_t* buffer : buffers) { HALVOE_CHECK(pool.release(buffer)); }
+    HALVOE_CHECK(pool.getBuffersInUse() == 0);
+  }
+
+  void checkFinalise()
+  {
+    SharedBufferPool<16, 3> pool;
+    uint8_t* data = pool.acquire();
+    Serializer<16> serializer(data);
+    serializer.write<uint32_t>(0x01020304);
+    serializer.write<uint16_t>(0x0506);
+
+    const SharedBuffer buffer = pool.finalise(serializer);
+    HALVOE_CHECK(!buffer.isNull());
+    HALVOE_CHECK(buffer.getBuffer() == data && buffer.getSize() == serializer.getBytesWritten());
+    HALVOE_CHECK(buffer.getReferenceCount() == 1);
+
+    // A finalised buffer cannot be finalised or released a second time while it is shared.
+    HALVOE_CHECK(pool.finalise(serializer).isNull());
+    HALVOE_CHECK(!pool.release(data));
+
+    Deserializer<16> deserializer(buffer.getBuffer());
+    HALVOE_CHECK(deserializer.read<uint32_t>() == 0x01020304 && deserializer.read<uint16_t>() == 0x0506);
+
+    const SharedBuffer empty;
+    HALVOE_CHECK(empty.isNull() && empty.getBuffer() == nullptr && empty.getSize() == 0 && empty.getReferenceCount() == 0);
+  }
+
+  void checkReferenceCounts()
+  {
+    SharedBufferPool<16, 3> pool;
+    SharedBuffer first = writeFrame(pool, 7);
+    HALVOE_CHECK(first.getReferenceCount() == 1 && pool.getBuffersInUse() == 1);
+
+    {
+      const SharedBuffer copy(first);
+      HALVOE_CHECK(copy.getBuffer() == first.getBuffer() && first.getReferenceCount() == 2);
+
+      SharedBuffer assigned;
+      assigned = copy;
+      HALVOE_CHECK(first.getReferenceCount() == 3);
+
+      SharedBuffer moved(std::move(assigned));
+      HALVOE_CHECK(assigned.isNull() && moved.getBuffer() == first.getBuffer() && first.getReferenceCount() == 3);
+
+      SharedBuffer moveAssigned;
+      moveAssigned = std::move(moved);
+      HALVOE_CHECK(moved.isNull() && first.getReferenceCount() == 3);
+
+      moveAssigned = moveAssigned;
+      HALVOE_CHECK(!moveAssigned.isNull() && first.getReferenceCount() == 3);
+    }
+    HALVOE_CHECK(first.getReferenceCount() == 1 && pool.getBuffersInUse() == 1);
+
+    // Assigning another frame drops the reference to the old one.
+    SharedBuffer second = writeFrame(pool, 8);
+    SharedBuffer holder(first);
+    HALVOE_CHECK(pool.getBuffersInUse() == 2);
+    holder = second;
+    HALVOE_CHECK(first.getReferenceCount() == 1 && second.getReferenceCount() == 2);
+
+    first.reset();
+    HALVOE_CHECK(first.isNull() && pool.getBuffersInUse() == 1);
+    first.reset();
+    HALVOE_CHECK(pool.getBuffersInUse() == 1);
+  }
+
+  void checkReleaseOnLastDrop()
+  {
+    SharedBufferPool<16, 3> pool;
+    SharedBuffer frames[3] = { writeFrame(pool, 1), writeFrame(pool, 2), writeFrame(pool, 3) };
+    HALVOE_CHECK(pool.getBuffersInUse() == 3);
+    HALVOE_CHECK(writeFrame(pool, 4).isNull());
+
+    const uint8_t* const middle = frames[1].getBuffer();
+    SharedBuffer client(frames[1]);
+    frames[1].reset();
+    HALVOE_CHECK(pool.getBuffersInUse() == 3);
+    HALVOE_CHECK(pool.acquire() == nullptr);
+
+    client.reset();
+    HALVOE_CHECK(pool.getBuffersInUse() == 2);
+
+    // The freed buffer is reused, and the others keep their bytes.
+    const SharedBuffer reused = writeFrame(pool, 5);
+    HALVOE_CHECK(reused.getBuffer() == middle);
+    Deserializer<16> firstReader(frames[0].getBuffer());
+    Deserializer<16> reusedReader(reused.getBuffer());
+    Deserializer<16> lastReader(frames[2].getBuffer());
+    HALVOE_CHECK(firstReader.read<uint32_t>() == 1 && reusedReader.read<uint32_t>() == 5 && lastReader.read<uint32_t>() == 3);
+
+    for (SharedBuffer& frame : frames) { frame = SharedBuffer(); }
+    HALVOE_CHECK(pool.getBuffersInUse() == 1);
+  }
+}
+
+int main()
+{
+  checkAcquireUntilExhausted();
+  checkFinalise();
+  checkReferenceCounts();
+  checkReleaseOnLastDrop();
+  return test::finishTest("test_shared_buffer");
+}
@@ -0,0 +1,222 @@
+#include <array>
+#include <cstring>
+
+#include "SipHash.hpp"
+#include "Test.hpp"
+
+// **** **** **** ****
+// NOTE: Checks SipHash24 against the 64 vectors of the reference implementation (vectors.h: key 00..0f,
+//       message 00..n-1 for n = 0..63), fed whole, split at every offset and incrementally through
+//       update(serializer), plus the tag append and verify round trip.
+// **** **** **** ****
+
+using namespace halvoe;
+
+namespace
+{
+  constexpr size_t c_vectorCount = 64;
+
+  // Little endian tags, as in vectors_sip64 of the reference implementation.
+  const uint8_t c_vectors[c_vectorCount][8] = {
+    { 0x31, 0x0e, 0x0e, 0xdd, 0x47, 0xdb, 0x6f, 0x72 },
+    { 0xfd, 0x67, 0xdc, 0x93, 0xc5, 0x39, 0xf8, 0x74 },
+    { 0x5a, 0x4f, 0xa9, 0xd9, 0x09, 0x80, 0x6c, 0x0d },
+    { 0x2d, 0x7e, 0xfb, 0xd7, 0x96, 0x66, 0x67, 0x85 },
+    { 0xb7, 0x87, 0x71, 0x27, 0xe0, 0x94, 0x27, 0xcf },
+    { 0x8d, 0xa6, 0x99, 0xcd, 0x64, 0x55, 0x76, 0x18 },
+    { 0xce, 0xe3, 0xfe, 0x58, 0x6e, 0x46, 0xc9, 0xcb },
+    { 0x37, 0xd1, 0x01, 0x8b, 0xf5, 0x00, 0x02, 0xab },
+    { 0x62, 0x24, 0x93, 0x9a, 0x79, 0xf5, 0xf5, 0x93 },
+    { 0xb0, 0xe4, 0xa9, 0x0b, 0xdf, 0x82, 0x00, 0x9e },
+    { 0xf3, 0xb9, 0xdd, 0x94, 0xc5, 0xbb, 0x5d, 0x7a },
+    { 0xa7, 0xad, 0x6b, 0x22, 0x46, 0x2f, 0xb3, 0xf4 },
+    { 0xfb, 0xe5, 0x0e, 0x86, 0xbc, 0x8f, 0x1e, 0x75 },
+    { 0x90, 0x3d, 0x84, 0xc0, 0x27, 0x56, 0xea, 0x14 },
+    { 0xee, 0xf2, 0x7a, 0x8e, 0x90, 0xca, 0x23, 0xf7 },
+    { 0xe5, 0x45, 0xbe, 0x49, 0x61, 0xca, 0x29, 0xa1 },
+    { 0xdb, 0x9b, 0xc2, 0x57, 0x7f, 0xcc, 0x2a, 0x3f },
+    { 0x94, 0x47, 0xbe, 0x2c, 0xf5, 0xe9, 0x9a, 0x69 },
+    { 0x9c, 0xd3, 0x8d, 0x96, 0xf0, 0xb3, 0xc1, 0x4b },
+    { 0xbd, 0x61, 0x79, 0xa7, 0x1d, 0xc9, 0x6d, 0xbb },
+    { 0x98, 0xee, 0xa2, 0x1a, 0xf2, 0x5c, 0xd6, 0xbe },
+    { 0xc7, 0x67, 0x3b, 0x2e, 0xb0, 0xcb, 0xf2, 0xd0 },
+    { 0x88, 0x3e, 0xa3, 0xe3, 0x95, 0x67, 0x53, 0x93 },
+    { 0xc8, 0xce, 0x5c, 0xcd, 0x8c, 0x03, 0x0c, 0xa8 },
+    { 0x94, 0xaf, 0x49, 0xf6, 0xc6, 0x50, 0xad, 0xb8 },
+    { 0xea, 0xb8, 0x85, 0x8a, 0xde, 0x92, 0xe1, 0xbc },
+    { 0xf3, 0x15, 0xbb, 0x5b, 0xb8, 0x35, 0xd8, 0x17 },
+    { 0xad, 0xcf, 0x6b, 0x07, 0x63, 0x61, 0x2e, 0x2f },
+    { 0xa5, 0xc9, 0x1d, 0xa7, 0xac, 0xaa, 0x4d, 0xde },
+    { 0x71, 0x65, 0x95, 0x87, 0x66, 0x50, 0xa2, 0xa6 },
+    { 0x28, 0xef, 0x49, 0x5c, 0x53, 0xa3, 0x87, 0xad },
+    { 0x42, 0xc3, 0x41, 0xd8, 0xfa, 0x92, 0xd8, 0x32 },
+    { 0xce, 0x7c, 0xf2, 0x72, 0x2f, 0x51, 0x27, 0x71 },
+    { 0xe3, 0x78, 0x59, 0xf9, 0x46, 0x23, 0xf3, 0xa7 },
+    { 0x38, 0x12, 0x05, 0xbb, 0x1a, 0xb0, 0xe0, 0x12 },
+    { 0xae, 0x97, 0xa1, 0x0f, 0xd4, 0x34, 0xe0, 0x15 },
+    { 0xb4, 0xa3, 0x15, 0x08, 0xbe, 0xff, 0x4d, 0x31 },
+    { 0x81, 0x39, 0x62, 0x29, 0xf0, 0x90, 0x79, 0x02 },
+    { 0x4d, 0x0c, 0xf4, 0x9e, 0xe5, 0xd4, 0xdc, 0xca },
+    { 0x5c, 0x73, 0x33, 0x6a, 0x76, 0xd8, 0xbf, 0x9a },
+    { 0xd0, 0xa7, 0x04, 0x53, 0x6b, 0xa9, 0x3e, 0x0e },
+    { 0x92, 0x59, 0x58, 0xfc, 0xd6, 0x42, 0x0c, 0xad },
+    { 0xa9, 0x15, 0xc2, 0x9b, 0xc8, 0x06, 0x73, 0x18 },
+    { 0x95, 0x2b, 0x79, 0xf3, 0xbc, 0x0a, 0xa6, 0xd4 },
+    { 0xf2, 0x1d, 0xf2, 0xe4, 0x1d, 0x45, 0x35, 0xf9 },
+    { 0x87, 0x57, 0x75, 0x19, 0x04, 0x8f, 0x53, 0xa9 },
+    { 0x10, 0xa5, 0x6c, 0xf5, 0xdf, 0xcd, 0x9a, 0xdb },
+    { 0xeb, 0x75, 0x09, 0x5c, 0xcd, 0x98, 0x6c, 0xd0 },
+    { 0x51, 0xa9, 0xcb, 0x9e, 0xcb, 0xa3, 0x12, 0xe6 },
+    { 0x96, 0xaf, 0xad, 0xfc, 0x2c, 0xe6, 0x66, 0xc7 },
+    { 0x72, 0xfe, 0x52, 0x97, 0x5a, 0x43, 0x64, 0xee },
+    { 0x5a, 0x16, 0x45, 0xb2, 0x76, 0xd5, 0x92, 0xa1 },
+    { 0xb2, 0x74, 0xcb, 0x8e, 0xbf, 0x87, 0x87, 0x0a },
+    { 0x6f, 0x9b, 0xb4, 0x20, 0x3d, 0xe7, 0xb3, 0x81 },
+    { 0xea, 0xec, 0xb2, 0xa3, 0x0b, 0x22, 0xa8, 0x7f },
+    { 0x99, 0x24, 0xa4, 0x3c, 0xc1, 0x31, 0x57, 0x24 },
+    { 0xbd, 0x83, 0x8d, 0x3a, 0xaf, 0xbf, 0x8d, 0xb7 },
+    { 0x0b, 0x1a, 0x2a, 0x32, 0x65, 0xd5, 0x1a, 0xea },
+    { 0x13, 0x50, 0x79, 0xa3, 0x23, 0x1c, 0xe6, 0x60 },
+    { 0x93, 0x2b, 0x28, 0x46, 0xe4, 0xd7, 0x06, 0x66 },
+    { 0xe1, 0x91, 0x5f, 0x5c, 0xb1, 0xec, 0xa4, 0x6c },
+    { 0xf3, 0x25, 0x96, 0x5c, 0xa1, 0x6d, 0x62, 0x9f },
+    { 0x57, 0x5f, 0xf2, 0x8e, 0x60, 0x38, 0x1b, 0xe5 },
+    { 0x72, 0x45, 0x06, 0xeb, 0x4c, 0x32, 0x8a, 0x95 }
+  };
+
+  SipHashKey getKey()
+  {
+    SipHashKey key;
+    for (size_t index = 0; index < key.size(); ++index) { key[index] = static_cast<uint8_t>(index); }
+    return key;
+  }
+
+  uint64_t getExpected(size_t in_size)
+  {
+    return loadLittleEndian<uint64_t>(c_vectors[in_size]);
+  }
+
+  std::array<uint8_t, c_vectorCount> getMessage()
+  {
+    std::array<uint8_t, c_vectorCount> message;
+    for (size_t index = 0; index < message.size(); ++index) { message[index] = static_cast<uint8_t>(index); }
+    return message;
+  }
+
+  void checkVectors()
+  {
+    const SipHashKey key = getKey();
+    const std::array<uint8_t, c_vectorCount> message = getMessage();
+
+    size_t matchCount = 0;
+    for (size_t size = 0; size < c_vectorCount; ++size)
+    {
+      if (getSipHash24(key, message.data(), size) == getExpected(size)) { ++matchCount; }
+    }
+    HALVOE_CHECK(matchCount == c_vectorCount);
+  }
+
+  // Two updates split at every offset, and three split at every pair of offsets, give the one shot result.
+  void checkSplitUpdates()
+  {
+    const SipHashKey key = getKey();
+    const std::array<uint8_t, c_vectorCount> message = getMessage();
+
+    size_t mismatchCount = 0;
+    for (size_t size = 0; size < c_vectorCount; ++size)
+    {
+      for (size_t first = 0; first <= size; ++first)
+      {
+        for (size_t second = first; second <= size; ++second)
+        {
+          SipHash24 hash(key);
+          hash.update(message.data(), first);
+          hash.update(message.data() + first, second - first);
+          hash.update(message.data() + second, size - second);
+          if (hash.getSize() != size || hash.finish() != getExpected(size)) { ++mismatchCount; }
+        }
+      }
+    }
+    HALVOE_CHECK(mismatchCount == 0);
+  }
+
+  // update(serializer) at every write boundary. Without type tags the written bytes are the reference
+  // message itself; with type tags they are compared against the one shot hash of the same bytes.
+  void checkSerializerUpdates()
+  {
+    const SipHashKey key = getKey();
+
+    size_t mismatchCount = 0;
+    for (size_t count = 0; count < c_vectorCount; ++count)
+    {
+      for (size_t split = 0; split <= count; ++split)
+      {
+        std::array<uint8_t, 2 * c_vectorCount> buffer{};
+        Serializer<2 * c_vectorCount> serializer(buffer);
+        SipHash24 hash(key);
+
+        for (size_t index = 0; index < count; ++index)
+        {
+          if (index == split && !hash.update(serializer)) { ++mismatchCount; }
+          serializer.write<uint8_t>(static_cast<uint8_t>(index));
+        }
+        if (!hash.update(serializer) || !hash.update(serializer)) { ++mismatchCount; }
+
+        const uint64_t tag = hash.finish();
+        if (tag != getSipHash24(key, buffer.data(), serializer.getBytesWritten())) { ++mismatchCount; }
+        if (c_typeTagSize == 0 && tag != getExpected(count)) { ++mismatchCount; }
+      }
+    }
+    HALVOE_CHECK(mismatchCount == 0);
+
+    // Feeding a hash from a Serializer that has written less than it has already seen fails.
+    std::array<uint8_t, 16> buffer{};
+    Serializer<16> serializer(buffer);
+    serializer.write<uint32_t>(1);
+    SipHash24 hash(key);
+    HALVOE_CHECK(hash.update(serializer));
+    Serializer<16> other(buffer);
+    HALVOE_CHECK(!hash.update(other));
+  }
+
+  void checkTags()
+  {
+    const SipHashKey key = getKey();
+    std::array<uint8_t, 32> buffer{};
+    Serializer<32> serializer(buffer);
+    serializer.write<uint32_t>(42);
+    serializer.write<uint16_t>(7);
+
+    SipHash24 hash(key);
+    const size_t frameSize = appendSipHashTag(serializer, hash);
+    HALVOE_CHECK(frameSize == serializer.getBytesWritten() + c_sipHashTagSize);
+    HALVOE_CHECK(appendSipHashTag(serializer, key) == frameSize);
+
+    size_t size = 0;
+    HALVOE_CHECK(verifySipHashTag(buffer.data(), frameSize, key, size) && size == serializer.getBytesWritten());
+
+    size_t rejectedCount = 0;
+    for (size_t index = 0; index < frameSize; ++index)
+    {
+      buffer[index] = buffer[index] ^ 0x10;
+      if (!verifySipHashTag(buffer.data(), frameSize, key, size)) { ++rejectedCount; }
+      buffer[index] = buffer[index] ^ 0x10;
+    }
+    HALVOE_CHECK(rejectedCount == frameSize);
+    HALVOE_CHECK(!verifySipHashTag(buffer.data(), c_sipHashTagSize - 1, key, size));
+
+    std::array<uint8_t, 8> full{};
+    Serializer<8> fullSerializer(full);
+    fullSerializer.write<uint8_t>(1);
+    HALVOE_CHECK(appendSipHashTag(fullSerializer, key) == 0);
+  }
+}
+
+int main()
+{
+  checkVectors();
+  checkSplitUpdates();
+  checkSerializerUpdates();
+  checkTags();
+  return test::finishTest("test_siphash");
+}
@@ -0,0 +1,107 @@
+#include <array>
+
+#include "BasicSerializer.hpp"
+#include "Test.hpp"
+
+// **** **** **** ****
+// NOTE: Checks that SizingSerializer counts exactly the bytes Serializer::getBytesWritten() reports for the
+//       same write sequence (with and without type tags), and that skip() references of two instances do
+//       not share their scratch element.
+// **** **** **** ****
+
+using namespace halvoe;
+
+namespace
+{
+  enum class Mode : uint16_t
+  {
+    idle = 0,
+    running = 3
+  };
+
+  constexpr size_t c_stepCount = 13;
+
+  // Writes the first in_stepCount steps of one message, so the byte counts can be compared after every step.
+  template<typename SerializerType>
+  bool writeSteps(SerializerType& io_serializer, size_t in_stepCount)
+  {
+    const char text[] = "sizing";
+    const float values[3] = { 1.0f, 2.0f, 3.0f };
+    bool isWritten = true;
+
+    for (size_t step = 0; step < in_stepCount; ++step)
+    {
+      switch (step)
+      {
+        case 0: isWritten = io_serializer.write(true); break;
+        case 1: isWritten = io_serializer.template write<int8_t>(-3); break;
+        case 2: isWritten = io_serializer.template write<uint16_t>(513); break;
+        case 3: isWritten = io_serializer.template write<int32_t>(-70000); break;
+        case 4: isWritten = io_serializer.template write<uint64_t>(1ull << 40); break;
+        case 5: isWritten = io_serializer.write(2.5f); break;
+        case 6: isWritten = io_serializer.write(-0.125); break;
+        case 7: isWritten = io_serializer.writeEnum(Mode::running); break;
+        case 8: isWritten = io_serializer.write(text, static_cast<uint8_t>(sizeof(text) - 1)); break;
+        case 9: isWritten = io_serializer.write(text, static_cast<uint16_t>(0)); break;
+        case 10: isWritten = io_serializer.writeArray(values, 3); break;
+        case 11: isWritten = io_serializer.template skip<uint32_t>().write(42); break;
+        case 12: isWritten = io_serializer.writeArray(values, 0); break;
+      }
+
+      if (!isWritten) { return false; }
+    }
+
+    return true;
+  }
+
+  void checkByteCounts()
+  {
+    for (size_t stepCount = 0; stepCount <= c_stepCount; ++stepCount)
+    {
+      std::array<uint8_t, 256> buffer{};
+      Serializer<256> serializer(buffer);
+      SizingSerializer sizing;
+
+      HALVOE_CHECK(writeSteps(serializer, stepCount));
+      HALVOE_CHECK(writeSteps(sizing, stepCount));
+      HALVOE_CHECK(sizing.getBytesWritten() == serializer.getBytesWritten());
+    }
+
+    // The measured size is exactly enough: the same message fails one byte short.
+    SizingSerializer sizing;
+    writeSteps(sizing, c_stepCount);
+    std::array<uint8_t, 256> buffer{};
+    const std::array<uint8_t, 256> padding{};
+    Serializer<256> serializer(buffer);
+    serializer.writeArray(padding.data(), 256 - sizing.getBytesWritten() - c_typeTagSize);
+    HALVOE_CHECK(serializer.getBytesLeft() == sizing.getBytesWritten());
+    HALVOE_CHECK(writeSteps(serializer, c_stepCount) && serializer.getBytesLeft() == 0);
+
+    Serializer<256> shortSerializer(buffer);
+    shortSerializer.writeArray(padding.data(), 256 - sizing.getBytesWritten() - c_typeTagSize + 1);
+    HALVOE_CHECK(!writeSteps(shortSerializer, c_stepCount));
+  }
+
+  void checkSkipScratchPerInstance()
+  {
+    SizingSerializer first;
+    SizingSerializer second;
+
+    SerializerReference<uint32_t> firstReference = first.skip<uint32_t>();
+    SerializerReference<uint32_t> secondReference = second.skip<uint32_t>();
+    HALVOE_CHECK(!firstReference.isNull() && !secondReference.isNull());
+    HALVOE_CHECK(firstReference.write(0x11111111) && secondReference.write(0x22222222));
+    HALVOE_CHECK(firstReference.read() == 0x11111111 && secondReference.read() == 0x22222222);
+
+    SerializerReference<double> wide = first.skip<double>();
+    HALVOE_CHECK(wide.write(-1.5) && wide.read() == -1.5);
+    HALVOE_CHECK(first.getBytesWritten() == 2 * c_typeTagSize + sizeof(uint32_t) + sizeof(double));
+  }
+}
+
+int main()
+{
+  checkByteCounts();
+  checkSkipScratchPerInstance();
+  return test::finishTest("test_sizing_serializer");
+}
@@ -0,0 +1,238 @@
+#include <array>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include "TextEncoding.hpp"
+#include "Test.hpp"
+
+// **** **** **** ****
+// NOTE: Checks the SIMD Base64 and hex codecs (AVX2 or SSSE3, whichever the build targets; the Makefile
+//       also builds an SSSE3 only variant) against the Scalar variants for every length 0..256 with random
+//       data: identical text, decoding back to the data without writing past the capacity, and rejection
+//       of invalid characters anywhere in the text and of bad padding.
+// **** **** **** ****
+
+using namespace halvoe;
+
+namespace
+{
+  constexpr size_t c_maxSize = 256;
+  constexpr size_t c_guardSize = 64;
+  constexpr uint8_t c_guard = 0xa5;
+
+  const char c_invalidBase64[] = { '!', '-', '_', '.', ':', '@', '[', '`', '{', ' ', '\n', '\0', '\x7f', '\x80', '\xff' };
+  const char c_invalidHex[] = { 'g', 'G', 'z', '/', ':', '@', '`', '-', ' ', '\0', '\x80', '\xff' };
+
+  using Decoder = bool (*)(const char*, size_t, uint8_t*, size_t, size_t&);
+
+  // Decodes with a capacity of exactly the expected size and checks the guard bytes behind it.
+  bool decodesTo(Decoder in_decode, const std::vector<char>& in_text, const std::vector<uint8_t>& in_expected)
+  {
+    std::vector<uint8_t> data(in_expected.size() + c_guardSize, c_guard);
+    size_t size = 0;
+    if (!in_decode(in_text.data(), in_text.size(), data.data(), in_expected.size(), size) || size != in_expected.size()) { return false; }
+    if (size > 0 && std::memcmp(data.data(), in_expected.data(), size) != 0) { return false; }
+
+    for (size_t index = size; index < data.size(); ++index)
+    {
+      if (data[index] != c_guard) { return false; }
+    }
+    return true;
+  }
+
+  bool isRejected(Decoder in_decode, const std::vector<char>& in_text)
+  {
+    std::vector<uint8_t> data(in_text.size() + c_guardSize);
+    size_t size = 0;
+    return !in_decode(in_text.data(), in_text.size(), data.data(), data.size(), size);
+  }
+
+  std::vector<char> toText(const char* in_text)
+  {
+    return std::vector<char>(in_text, in_text + std::strlen(in_text));
+  }
+
+  void checkBase64(std::mt19937& io_generator)
+  {
+    size_t textMismatchCount = 0;
+    size_t decodeFailureCount = 0;
+    size_t acceptedInvalidCount = 0;
+
+    for (size_t size = 0; size <= c_maxSize; ++size)
+    {
+      for (size_t trial = 0; trial < 8; ++trial)
+      {
+        std::vector<uint8_t> data(size);
+        for (uint8_t& byte : data) { byte = static_cast<uint8_t>(io_generator()); }
+
+        std::vector<char> text(getBase64Size(size) + c_guardSize, '#');
+        std::vector<char> scalarText(getBase64Size(size) + c_guardSize, '#');
+        const size_t textSize = encodeBase64(data.data(), size, text.data());
+        const size_t scalarTextSize = encodeBase64Scalar(data.data(), size, scalarText.data());
+        if (textSize != getBase64Size(size) || scalarTextSize != textSize || text != scalarText) { textMismatchCount = textMismatchCount + 1; }
+        text.resize(textSize);
+
+        // With and without padding.
+        std::vector<char> unpadded = text;
+        while (!unpadded.empty() && unpadded.back() == '=') { unpadded.pop_back(); }
+        if (!decodesTo(decodeBase64, text, data) || !decodesTo(decodeBase64Scalar, text, data)) { decodeFailureCount = decodeFailureCount + 1; }
+        if (!decodesTo(decodeBase64, unpadded, data) || !decodesTo(decodeBase64Scalar, unpadded, data)) { decodeFailureCount = decodeFailureCount + 1; }
+
+        // An invalid character at a random position (also inside the SIMD blocks). '=' is only invalid before the padding.
+        if (unpadded.empty()) { continue; }
+        std::vector<char> invalid = text;
+        const size_t position = io_generator() % unpadded.size();
+        invalid[position] = trial == 0 && position + 2 < unpadded.size() ? '=' : c_invalidBase64[io_generator() % sizeof(c_invalidBase64)];
+        if (!isRejected(decodeBase64, invalid) || !isRejected(decodeBase64Scalar, invalid)) { acceptedInvalidCount = acceptedInvalidCount + 1; }
+
+        // A capacity one byte short.
+        std::vector<uint8_t> shortData(size + c_guardSize);
+        size_t shortSize = 0;
+        if (size > 0 && (decodeBase64(text.data(), text.size(), shortData.data(), size - 1, shortSize) ||
+                         decodeBase64Scalar(text.data(), text.size(), shortData.data(), size - 1, shortSize)))
+        {
+          acceptedInvalidCount = acceptedInvalidCount + 1;
+        }
+      }
+    }
+
+    HALVOE_CHECK(textMismatchCount == 0);
+    HALVOE_CHECK(decodeFailureCount == 0);
+    HALVOE_CHECK(acceptedInvalidCount == 0);
+  }
+
+  void checkBase64Padding()
+  {
+    // Padding has to complete the last quad; it is never valid elsewhere.
+    const char* const rejected[] = { "A", "A=", "A==", "A===", "=", "==", "====", "AA=", "AA===", "AAA==", "AAA==A", "AA=A", "=AAA", "AA==AAAA",
+                                     "AAAAA", "AAAAA===", "QUJD=", "QUJD==", "QUJDRA=", "QUJDRA===", "QUJDREU==",
+                                     "AAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAA=AAAAAAAAA",
+                                     "AAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAA====" };
+    for (const char* text : rejected)
+    {
+      HALVOE_CHECK(isRejected(decodeBase64, toText(text)) && isRejected(decodeBase64Scalar, toText(text)));
+    }
+
+    HALVOE_CHECK(decodesTo(decodeBase64, toText(""), {}) && decodesTo(decodeBase64Scalar, toText(""), {}));
+    HALVOE_CHECK(decodesTo(decodeBase64, toText("QUJDRA=="), { 'A', 'B', 'C', 'D' }) && decodesTo(decodeBase64Scalar, toText("QUJDRA=="), { 'A', 'B', 'C', 'D' }));
+    HALVOE_CHECK(decodesTo(decodeBase64, toText("QUJDREU="), { 'A', 'B', 'C', 'D', 'E' }) && decodesTo(decodeBase64Scalar, toText("QUJDREU"), { 'A', 'B', 'C', 'D', 'E' }));
+    HALVOE_CHECK(decodesTo(decodeBase64, toText("+/+/"), { 0xfb, 0xff, 0xbf }));
+  }
+
+  void checkHex(std::mt19937& io_generator)
+  {
+    size_t textMismatchCount = 0;
+    size_t decodeFailureCount = 0;
+    size_t acceptedInvalidCount = 0;
+
+    for (size_t size = 0; size <= c_maxSize; ++size)
+    {
+      for (size_t trial = 0; trial < 8; ++trial)
+      {
+        std::vector<uint8_t> data(size);
+        for (uint8_t& byte : data) { byte = static_cast<uint8_t>(io_generator()); }
+
+        std::vector<char> text(getHexSize(size) + c_guardSize, '#');
+        std::vector<char> scalarText(getHexSize(size) + c_guardSize, '#');
+        const size_t textSize = encodeHex(data.data(), size, text.data());
+        const size_t scalarTextSize = encodeHexScalar(data.data(), size, scalarText.data());
+        if (textSize != getHexSize(size) || scalarTextSize != textSize || text != scalarText) { textMismatchCount = textMismatchCount + 1; }
+        text.resize(textSize);
+
+        // Lower and mixed case.
+        std::vector<char> mixedCase = text;
+        for (char& character : mixedCase)
+        {
+          if (character >= 'a' && io_generator() % 2 == 0) { character = static_cast<char>(character - 'a' + 'A'); }
+        }
+        if (!decodesTo(decodeHex, text, data) || !decodesTo(decodeHexScalar, text, data)) { decodeFailureCount = decodeFailureCount + 1; }
+        if (!decodesTo(decodeHex, mixedCase, data) || !decodesTo(decodeHexScalar, mixedCase, data)) { decodeFailureCount = decodeFailureCount + 1; }
+
+        if (size == 0) { continue; }
+        std::vector<char> invalid = mixedCase;
+        invalid[io_generator() % invalid.size()] = c_invalidHex[io_generator() % sizeof(c_invalidHex)];
+        if (!isRejected(decodeHex, invalid) || !isRejected(decodeHexScalar, invalid)) { acceptedInvalidCount = acceptedInvalidCount + 1; }
+
+        // An odd length and a capacity one byte short.
+        std::vector<char> odd(text.begin(), text.end() - 1);
+        if (!isRejected(decodeHex, odd) || !isRejected(decodeHexScalar, odd)) { acceptedInvalidCount = acceptedInvalidCount + 1; }
+        std::vector<uint8_t> shortData(size + c_guardSize);
+        size_t shortSize = 0;
+        if (decodeHex(text.data(), text.size(), shortData.data(), size - 1, shortSize) || decodeHexScalar(text.data(), text.size(), shortData.data(), size - 1, shortSize))
+        {
+          acceptedInvalidCount = acceptedInvalidCount + 1;
+        }
+      }
+    }
+
+    HALVOE_CHECK(textMismatchCount == 0);
+    HALVOE_CHECK(decodeFailureCount == 0);
+    HALVOE_CHECK(acceptedInvalidCount == 0);
+  }
+
+  // Every byte value as a character, at every position of a 32 char (one SIMD block) hex text.
+  void checkHexAlphabet()
+  {
+    size_t mismatchCount = 0;
+    for (size_t position = 0; position < 32; ++position)
+    {
+      for (size_t character = 0; character < 256; ++character)
+      {
+        std::vector<char> text(32, '0');
+        text[position] = static_cast<char>(character);
+        uint8_t data[16];
+        uint8_t scalarData[16];
+        size_t size = 0;
+        size_t scalarSize = 0;
+        const bool isDecoded = decodeHex(text.data(), text.size(), data, sizeof(data), size);
+        const bool isScalarDecoded = decodeHexScalar(text.data(), text.size(), scalarData, sizeof(scalarData), scalarSize);
+        const bool isValid = hex::c_decodeTable[character] != hex::c_invalid;
+        if (isDecoded != isValid || isScalarDecoded != isValid || (isValid && std::memcmp(data, scalarData, sizeof(data)) != 0)) { mismatchCount = mismatchCount + 1; }
+      }
+    }
+    HALVOE_CHECK(mismatchCount == 0);
+  }
+
+  // Every byte value as a character, at every position of a 64 char (AVX2 and SSSE3 block) Base64 text.
+  void checkBase64Alphabet()
+  {
+    size_t mismatchCount = 0;
+    for (size_t position = 0; position < 64; ++position)
+    {
+      for (size_t character = 0; character < 256; ++character)
+      {
+        if (character == '=' && position >= 62) { continue; } // valid padding
+        std::vector<char> text(64, 'A');
+        text[position] = static_cast<char>(character);
+        uint8_t data[48];
+        uint8_t scalarData[48];
+        size_t size = 0;
+        size_t scalarSize = 0;
+        const bool isDecoded = decodeBase64(text.data(), text.size(), data, sizeof(data), size);
+        const bool isScalarDecoded = decodeBase64Scalar(text.data(), text.size(), scalarData, sizeof(scalarData), scalarSize);
+        const bool isValid = base64::c_decodeTable[character] != base64::c_invalid;
+        if (isDecoded != isValid || isScalarDecoded != isValid || (isValid && std::memcmp(data, scalarData, sizeof(data)) != 0)) { mismatchCount = mismatchCount + 1; }
+      }
+    }
+    HALVOE_CHECK(mismatchCount == 0);
+  }
+}
+
+int main()
+{
+#if defined(__AVX2__)
+  std::printf("test_text_encoding: AVX2 path enabled\n");
+#elif defined(__SSSE3__)
+  std::printf("test_text_encoding: SSSE3 path enabled\n");
+#endif
+
+  std::mt19937 generator(109);
+  checkBase64(generator);
+  checkBase64Padding();
+  checkBase64Alphabet();
+  checkHex(generator);
+  checkHexAlphabet();
+  return test::finishTest("test_text_encoding");
+}